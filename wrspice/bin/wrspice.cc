@@ -1608,12 +1608,6 @@ namespace {
 }
 
 
-#ifdef WIN32
-#define CLOSESOCKET(x) shutdown(x, SD_SEND), closesocket(x)
-#else
-#define CLOSESOCKET(x) close(x)
-#endif
-
 namespace {
     void process_args(int *acp, char **av)
     {
@@ -1893,8 +1887,7 @@ fatal(int error)
     if (!Sp.GetFlag(FT_BATCHMODE)) {
         GP.HaltFullScreenGraphics();
         CP.SetupTty(fileno(stdin), true);
-        if (CP.MesgSocket() >= 0)
-            CLOSESOCKET(CP.MesgSocket());
+        CP.MesgClose();
         if (!error) {
             if (CP.GetFlag(CP_INTERACTIVE)) {
                 char *cmd = getenv("SPICE_FUN_CMD");
@@ -2547,8 +2540,7 @@ IFsimulator::SigHdlr(int sig)
         if (!Sp.GetFlag(FT_BATCHMODE)) {
             GP.HaltFullScreenGraphics();
             CP.SetupTty(fileno(stdin), true);
-            if (CP.MesgSocket() >= 0)
-                CLOSESOCKET(CP.MesgSocket());
+            CP.MesgClose();
             ToolBar()->CloseGraphicsConnection();
         }
         if (Global.FifoName())
@@ -2560,6 +2552,12 @@ IFsimulator::SigHdlr(int sig)
     else if (sig == SIGWINCH) {
         TTY.init_more();
     }
+#endif
+#if defined(SIGUSR2) && defined(HAVE_LOCAL_ALLOCATOR)
+    else if (sig == SIGUSR2 && Memory()->mon_prof_active()) {
+        // Dump a heap profile from the sampling profiler.
+        Memory()->mon_prof_request();
+    }
 #endif
     else {
         // Under FreeBSD, sending HUP generates a SIGCONT after the
@@ -74,6 +74,11 @@ struct jjstuff
 };
 
 
+// Instances are loaded one at a time.  Most of the cost is the sin
+// and cos of the phase, and exp for the quasiparticle current, which
+// the math library evaluates per call, so collecting instances into
+// batches would not reduce it.
+//
 int
 JJdev::load(sGENinstance *in_inst, sCKT *ckt)
 {
@@ -1260,7 +1260,28 @@ private:
     unsigned int        ix;
 };
 
-// Breakpoint control.
+// Lazy breakpoint source.  A source with many corners can register
+// one of these rather than adding each corner to the table, the table
+// holds only the next pending corner of each generator.  The sequence
+// must be increasing.
+//
+struct sCKTbreakGen
+{
+    virtual ~sCKTbreakGen() { }
+
+    // Set the return to the first breakpoint greater than t and
+    // return true, or return false if there is none.  This should be
+    // fast when t is near the current position.
+    virtual bool next_after(double, double*) const = 0;
+
+    // Move the current position past the argument.
+    virtual void advance(double) = 0;
+};
+
+// Breakpoint control.  The breakpoints are kept in a binary min-heap,
+// insertion and removal are O(log n).  Points closer than the minimum
+// break are not merged on insertion, rather the later point is
+// skipped when looking for the next break.
 //
 struct sCKTlattice
 {
@@ -1270,42 +1291,60 @@ struct sCKTlattice
         double per;
     };
 
+    // Heap element, gen is nonzero for a generator head.
+    struct brkelt
+    {
+        double time;
+        sCKTbreakGen *gen;
+    };
+
     sCKTlattice()
         {
             lattices = 0;
             breaks = 0;
+            gens = 0;
             numLattices = 0;
             numBreaks = 0;
+            szBreaks = 0;
+            numGens = 0;
+            szGens = 0;
         }
 
     ~sCKTlattice()
         {
-            delete [] lattices;
-            delete [] breaks;
+            clear();
         }
 
     void init()
         {
-            delete [] lattices;
-            delete [] breaks;
-            lattices = 0;
-            breaks = 0;
-            numLattices = 0;
-            numBreaks = 0;
+            clear();
         }
 
     int numbreaks() { return (numBreaks); }
 
     void clear_break(double, double, double*);
     bool set_break(double, double, double, double*);
+    void set_break_gen(sCKTbreakGen*, double, double, double*);
     void set_lattice(double, double);
     double nextbreak(double, double);
 
 private:
+    void clear();
+    void push(double, sCKTbreakGen*);
+    void pop();
+    void update(double, double, double, double*);
+    void find_next(int, double, double, double*);
+    bool on_lattice(double, double);
+    bool gen_next(sCKTbreakGen*, double, double, double*);
+
     lattice *lattices;
-    double *breaks;
+    brkelt *breaks;
+    sCKTbreakGen **gens;
     int numLattices;
     int numBreaks;
+    int szBreaks;
+    int numGens;
+    int szGens;
 };
 
 
@@ -1678,6 +1717,7 @@ struct sCKT : sCKTPOD
     int breakClr();
     int breakInit();
     int breakSet(double);
+    int breakSetGen(sCKTbreakGen*);
     int breakSetLattice(double, double);
     void clrTable();
     int convTest();
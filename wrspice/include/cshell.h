@@ -272,6 +272,9 @@ struct CshPar
     bool InitIPC();                         // Initialize IPC, call listen()
     bool InitIPCmessage();                  // Call accept()
     bool MessageHandler(int);               // Handle IPC messages
+    int MesgRead(char*);                    // Buffered message socket read
+    bool MesgPending();                     // Buffered message bytes exist
+    void MesgClose();                       // Close message socket
 
     // lexical.cc
     wordlist *PromptUser(const char*);      // Get string from user
@@ -55,6 +55,7 @@ Authors: 1985 Wayne A. Christopher
 
 // references
 struct sDataVec;
+struct sVecMap;
 struct sPlot;
 struct sJOB;
 struct sOPTIONS;
@@ -361,6 +362,9 @@ public:
     virtual bool file_points(int = -1) = 0;
     virtual bool file_update_pcnt(int) = 0;
     virtual bool file_close() = 0;
+
+    // Complete any pending output, called when a run pauses.
+    virtual void file_flush()   { }
 };
 
 
@@ -652,6 +656,7 @@ struct sDataVec
     sDataVec(int t = UU_NOTYPE)
         {
             v_data.real = 0;
+            v_map = 0;
 
             v_name = 0;
             v_units.set(t);
@@ -679,6 +684,7 @@ struct sDataVec
     sDataVec(const sUnits &u)
         {
             v_data.real = 0;
+            v_map = 0;
 
             v_name = 0;
             v_units = u;
@@ -707,6 +713,7 @@ struct sDataVec
         void *data = 0)
         {
             v_data.real = 0;
+            v_map = 0;
             if (data)
                 v_data.real = (double*)data;
             else if (len) {
@@ -755,6 +762,8 @@ struct sDataVec
     sDataVec *copy() const;
     void copyto(sDataVec*, int, int, int) const;
     void alloc(bool, int);
+    bool alloc_spill(bool, int);
+    void free_data();
     void resize(int, int = 0);
     char *basename() const;
     void sort();
@@ -896,9 +905,9 @@ struct sDataVec
 
     void set_realvec(double *v, bool clean = false)
         {
-            v_flags &= ~VF_COMPLEX;
             if (clean && v != v_data.real)
-                delete [] v_data.real;
+                free_data();
+            v_flags &= ~VF_COMPLEX;
             v_data.real = v;
         }
 
@@ -935,9 +944,9 @@ struct sDataVec
 
     void set_compvec(complex *c, bool clean = false)
         {
-            v_flags |= VF_COMPLEX;
             if (clean && c != v_data.comp)
-                delete [] v_data.comp;
+                free_data();
+            v_flags |= VF_COMPLEX;
             v_data.comp = c;
         }
 
@@ -1012,14 +1021,11 @@ struct sDataVec
 
     void realloc(int len)
         {
-            if (isreal()) {
-                delete [] v_data.real;
+            free_data();
+            if (isreal())
                 v_data.real = new double[len];
-            }
-            else {
-                delete [] v_data.comp;
+            else
                 v_data.comp = new complex[len];
-            }
             v_rlength = len;
         }
 
@@ -1110,11 +1116,17 @@ struct sDataVec
 
     static void set_temporary(bool b) { v_temporary = b; }
 
+    // True if the data are in mapped storage.
+    bool spilled()          const { return (v_map != 0); }
+
 private:
+    bool unmap(const void*);
+
     union {
         double *real;
         complex *comp;
     } v_data;               // Vector's data.
+    sVecMap *v_map;         // Mapped storage, if spilled.
 
     char *v_name;           // Vector's name.
     sUnits v_units;         // Vector's units struct.
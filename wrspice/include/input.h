@@ -108,6 +108,7 @@ public:
 
     // inpdeck.cc
     void parseDeck(sCKT*, sLine*, sTASK*, bool);
+    int findDev(const char*);
 
     // inpdev.cc
     void devParse(sLine*, const char**, sCKT*, sGENinstance*, const char*);
@@ -167,7 +168,6 @@ private:
     // inpdeck.cc
     void pass1(sCKT*, sLine*);
     void pass2(sCKT*, sLine*, sTASK*);
-    int findDev(const char*);
 
     // inpdotcd.cc
     IFanalysis *getAnalysis(const char*, int*);
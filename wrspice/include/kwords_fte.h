@@ -229,6 +229,7 @@ extern const char *kw_helpinitypos;
 extern const char *kw_helppath;
 extern const char *kw_installcmdfmt;
 extern const char *kw_level;
+extern const char *kw_meastime;
 extern const char *kw_modpath;
 extern const char *kw_mplot_cur;
 extern const char *kw_nfreqs;
@@ -237,6 +238,8 @@ extern const char *kw_nomodload;
 extern const char *kw_nopadding;
 extern const char *kw_nopage;
 extern const char *kw_numdgt;
+extern const char *kw_parsethreads;
+extern const char *kw_postthreads;
 extern const char *kw_printautowidth;
 extern const char *kw_printnoheader;
 extern const char *kw_printnoindex;
@@ -251,6 +254,7 @@ extern const char *kw_spectrace;
 extern const char *kw_specwindow;
 extern const char *kw_specwindoworder;
 extern const char *kw_spicepath;
+extern const char *kw_spilldata;
 extern const char *kw_units;
 extern const char *kw_xicpath;
 
@@ -287,6 +291,8 @@ extern const char *kw_wmfocusfix;
 extern const char *kw_modelcard;
 extern const char *kw_pexnodes;
 extern const char *kw_nobjthack;
+extern const char *kw_nosubtemplate;
+extern const char *kw_netcachedir;
 extern const char *kw_subend;
 extern const char *kw_subinvoke;
 extern const char *kw_substart;
@@ -48,6 +48,8 @@
 // Read and write the ascii and binary rawfile formats.
 //
 
+struct sRawPipe;
+
 class cRawOut : public cFileOut
 {
 public:
@@ -68,9 +70,13 @@ public:
     bool file_points(int = -1);
     bool file_update_pcnt(int);
     bool file_close();
+    void file_flush();
 
 private:
+    void stream_point(int);
+
     sPlot *ro_plot;
+    sRawPipe *ro_pipe;      // point writer thread, when streaming
     FILE *ro_fp;
     long ro_pointPosn;
     int ro_prec;
@@ -56,6 +56,7 @@ Authors: 1985 Wayne A. Christopher
 
 struct sRunDesc;
 struct pnode;
+struct sMbatch;
 
 enum ROtype
 {
@@ -444,6 +445,7 @@ struct sMfunc
     bool mrms(sDataVec*, int, int, sXpt*, sXpt*);
     bool mpw(sDataVec*,  int, int, sXpt*, sXpt*);
     bool mrft(sDataVec*, int, int, sXpt*, sXpt*, double =0.1, double =0.9);
+    bool measure(sDataVec*, int, int, sXpt*, sXpt*);
 
 private:
     Mfunc f_type;       // type of job
@@ -480,6 +482,7 @@ struct sRunopMeas : public sRunop
         ro_stop_flag            = false;
         ro_end_flag             = false;
         ro_print_flag           = 0;
+        ro_time                 = 0.0;
 
         parse(str, errstr);
     }
@@ -533,6 +536,8 @@ struct sRunopMeas : public sRunop
     bool stop_flag()            { return (ro_stop_flag); }
     bool end_flag()             { return (ro_end_flag); }
     void nostop()               { ro_stop_flag = false; ro_end_flag = false; }
+    double meas_time()          { return (ro_time); }
+    void add_time(double t)     { ro_time += t; }
 
     static sRunopMeas *find(sRunopMeas *thism, const char *res)
         {
@@ -552,13 +557,16 @@ struct sRunopMeas : public sRunop
     bool parse(const char*, char**);
     bool check_measure(sRunDesc*);
     bool do_measure();
-    bool measure(sDataVec**, int*);
+    static bool do_measures(sRunopMeas**, int);
+    bool measure(sDataVec**, int*, sMbatch* = 0);
     bool update_plot(sDataVec*, int);
     char *print_meas();
 
 private:
+    bool finish_measure(sDataVec*, int);
+    bool uses_result(sRunopMeas**, int);
     void addMeas(Mfunc, const char*, double = 0.0, double = 0.0);
-    sDataVec *evaluate(const char*);
+    sDataVec *evaluate(const char*, sMbatch* = 0);
     double startval(sDataVec*);
     double endval(sDataVec*);
     sXpt startpoint(sDataVec*);
@@ -585,6 +593,7 @@ private:
     bool ro_stop_flag;          // pause analysis when done
     bool ro_end_flag;           // terminate analysis when done
     char ro_print_flag;         // print result on screen, 1 terse  2 verbose
+    double ro_time;             // time used by last measurement, seconds
 };
 
 struct sRunopStop : public sRunop
@@ -764,6 +764,10 @@ struct IFsimulator
     int GetTranTrace()              { return (ft_trantrace); }
     void SetTranTrace(int i)        { ft_trantrace = i; }
 
+    // Evaluations that depend on more than the expression text.
+    unsigned int VolatileEvals()    { return (ft_volatile_evals); }
+    void CountVolatileEval()        { ft_volatile_evals++; }
+
     bool GetFlag(FT_FLAG which)     { return (ft_flags[which]); }
     void SetFlag(FT_FLAG which, bool val) { ft_flags[which] = val; }
 
@@ -805,6 +809,8 @@ private:
 
     int ft_trantrace;           // Transient analysis tracing level.
 
+    unsigned int ft_volatile_evals; // Vector and random function evals.
+
     bool ft_flags[FT_NUMFLAGS]; // Misc. flag vector.
 
     // Character used to separate generated name fields in subcircuit
@@ -911,6 +917,14 @@ namespace ResPrint
 #define DEF_numdgt_MIN          0
 #define DEF_numdgt_MAX          15
 
+#define DEF_parsethreads        0
+#define DEF_parsethreads_MIN    0
+#define DEF_parsethreads_MAX    31
+
+#define DEF_postthreads         0
+#define DEF_postthreads_MIN     0
+#define DEF_postthreads_MAX     31
+
 #define DEF_rawfileprec         15
 #define DEF_rawfileprec_MIN     0
 #define DEF_rawfileprec_MAX     15
@@ -61,6 +61,7 @@ struct sModTab;
 struct sSubcTab;
 struct sCblk;
 struct sCblkTab;
+struct sFtCirc;
 
 struct sSPcache
 {
@@ -93,6 +94,7 @@ sSPcx
         {
             cx_pexnodes = false;
             cx_nobjthack = false;
+            cx_nosubtemplate = false;
             cx_parhier = ParHierGlobal;
             cx_catchar = DEF_SUBC_CATCHAR;
             cx_catmode = SUBC_CATMODE_WR;
@@ -111,6 +113,7 @@ sSPcx
 
     bool pexnodes()         const { return (cx_pexnodes); }
     bool nobjthack()        const { return (cx_nobjthack); }
+    bool nosubtemplate()    const { return (cx_nosubtemplate); }
     int catchar()           const { return (cx_catchar); }
     int catmode()           const { return (cx_catmode); }
     ParHierMode parhier()   const { return ((ParHierMode)cx_parhier); }
@@ -125,6 +128,7 @@ private:
 
     bool cx_pexnodes;
     bool cx_nobjthack;
+    bool cx_nosubtemplate;
     char cx_parhier;
     char cx_catchar;
     char cx_catmode;
@@ -135,6 +139,15 @@ private:
     const char *cx_model;
 };
 
+// Disk cache of expanded decks (netcache.cc).
+//
+struct sNetCache
+{
+    static char *path(sLine*, sFtCirc*);
+    static sLine *read(const char*);
+    static bool write(const char*, sLine*);
+};
+
 extern sSPcache SPcache;
 extern sSPcx SPcx;
 
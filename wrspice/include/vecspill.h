@@ -0,0 +1,121 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * WRspice Circuit Simulation and Analysis Tool                           *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#ifndef VECSPILL_H
+#define VECSPILL_H
+
+#include <stddef.h>
+
+
+//
+// Out-of-core storage for plot vectors.
+//
+// When the "spilldata" variable is set, the vectors created for
+// analysis output are stored in memory-mapped temporary files rather
+// than on the heap.  The data are still accessed through ordinary
+// pointers, so the sDataVec accessors work as before, but the
+// operating system can page the data to and from the file.  During a
+// run, pages that have been written are periodically released from
+// the resident set, so that the memory in use for plot data stays
+// within a budget.
+//
+
+// Default resident budget, KB.
+#define DEF_spillData           (256*1024)
+#define DEF_spillData_MIN       1024
+#define DEF_spillData_MAX       1e9
+
+// Mapped storage for one vector.  The file is unlinked and its
+// descriptor closed when created, so nothing is left behind on exit.
+//
+struct sVecMap
+{
+    void *vm_base;          // mapped address
+    size_t vm_size;         // mapped size, bytes
+    sVecMap *vm_next;       // list link
+    sVecMap *vm_prev;       // list link
+};
+
+class cVecSpill
+{
+public:
+    cVecSpill()
+        {
+            vs_maps = 0;
+            vs_budget = 0;
+            vs_mapped = 0;
+            vs_written = 0;
+        }
+
+    // Return true if new output vectors should use mapped storage.
+    bool enabled()              const { return (vs_budget > 0); }
+
+    // Set the resident budget in KB, zero disables.
+    void set_budget(double kb)
+        {
+            vs_budget = kb > 0.0 ? (size_t)(kb*1000.0) : 0;
+        }
+
+    size_t mapped()             const { return (vs_mapped); }
+
+    // Account for bytes written to mapped storage, trim when the
+    // budget is exceeded.  Called for each output point.
+    void written(size_t bytes)
+        {
+            vs_written += bytes;
+            if (vs_written > vs_budget)
+                trim();
+        }
+
+    sVecMap *map_new(size_t);
+    bool map_resize(sVecMap*, size_t, size_t);
+    void map_free(sVecMap*);
+    void trim();
+
+private:
+    sVecMap *vs_maps;       // list of mappings
+    size_t vs_budget;       // resident budget, bytes
+    size_t vs_mapped;       // total mapped bytes
+    size_t vs_written;      // bytes written since last trim
+};
+
+extern cVecSpill VecSpill;
+
+#endif
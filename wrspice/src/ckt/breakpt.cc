@@ -52,21 +52,39 @@ Authors: 1985 Thomas L. Quarles
 // Breakpoint/lattice point functions (sCKTlattice).
 //
 
-// Delete the first time from the breakpoint table for the given circuit.
+// Delete the times that have been passed from the breakpoint table
+// for the given circuit.  Points that follow a passed point by no
+// more than minbrk are deleted too, this is where close points are
+// merged, keeping the earlier.  Generator heads are replaced with the
+// next point from the generator.
 //
 void
 sCKTlattice::clear_break(double ckt_time, double minbrk, double *ckt_breaks)
 {
     *ckt_breaks = nextbreak(*ckt_breaks, minbrk);
     *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-    int i;
-    for (i = 0; i < numBreaks; i++)
-        if (breaks[i] > ckt_time)
+    double last = 0.0;
+    bool have_last = false;
+    while (numBreaks) {
+        double x = breaks[0].time;
+        bool merge = (have_last && x - last <= minbrk);
+        if (x > ckt_time && !merge)
             break;
-    if (i) {
-        numBreaks -= i;
-        for (int j = 0; j < numBreaks; j++)
-            breaks[j] = breaks[j+i];
+        sCKTbreakGen *gen = breaks[0].gen;
+        pop();
+        if (!merge) {
+            last = x;
+            have_last = true;
+        }
+        if (gen) {
+            double tx = ckt_time;
+            if (last + minbrk > tx)
+                tx = last + minbrk;
+            gen->advance(tx);
+            double t;
+            if (gen_next(gen, tx, minbrk, &t))
+                push(t, gen);
+        }
     }
 }
 
@@ -78,87 +96,45 @@ bool
 sCKTlattice::set_break(double time, double ckt_time, double minbrk,
     double *ckt_breaks)
 {
-    if (lattices) {
-        for (int i = 0; i < numLattices; i++) {
-            double dt0, dt1;
-            if (time < lattices[i].offs) {
-                dt0 = lattices[i].offs + lattices[i].per;
-                dt1 = lattices[i].offs;;
-            }
-            else{
-                dt0 = lattices[i].per *
-                    ceil((time - lattices[i].offs)/lattices[i].per) +
-                    lattices[i].offs;
-                dt1 = lattices[i].per *
-                    floor((time - lattices[i].offs)/lattices[i].per) +
-                    lattices[i].offs;
-            }
-            if (fabs(time - dt0) < minbrk ||
-                    fabs(time - dt1) < minbrk) {
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (false);
-            }
-        }
+    if (on_lattice(time, minbrk)) {
+        update(time, ckt_time, minbrk, ckt_breaks);
+        return (false);
     }
     if (!breaks) {
-        breaks = new double[1];
-        breaks[0] = time;
-        numBreaks = 1;
+        push(time, 0);
         return (false);
     }
-    for (int i = 0; i < numBreaks; i++) {
-        if (breaks[i] > time) { // passed
-            if ((breaks[i] - time) <= minbrk) {
-                // Very close together - take earlier point.
-                breaks[i] = time;
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (true);
-            }
-            if (time - breaks[i-1] <= minbrk) {
-                // very close together, but after, so skip
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (true);
-            }
-            // Fits in middle - new array & insert.
-            double *tmp = new double[numBreaks + 1];
-            int j;
-            for (j = 0; j < i; j++)
-                *(tmp + j) = breaks[j];
-            *(tmp + i) = time;
-            for (j = i; j < numBreaks; j++) {
-                *(tmp + j+1) = breaks[j];
-            }
-            delete [] breaks;;
-            numBreaks++;
-            breaks = tmp;
-            if (time < *ckt_breaks)
-                *ckt_breaks = nextbreak(ckt_time, minbrk);
-            *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-            return (true);
-        }
+    // Points within minbrk of an existing point are kept, nextbreak
+    // will skip the later of the two.
+    push(time, 0);
+    update(time, ckt_time, minbrk, ckt_breaks);
+    return (true);
+}
+
+
+// Add a breakpoint generator, which will be freed by the table.  Only
+// the next point following ckt_time is entered.
+//
+void
+sCKTlattice::set_break_gen(sCKTbreakGen *gen, double ckt_time, double minbrk,
+    double *ckt_breaks)
+{
+    if (!gen)
+        return;
+    if (numGens == szGens) {
+        int nsz = szGens ? 2*szGens : 16;
+        Realloc(&gens, nsz, szGens);
+        szGens = nsz;
     }
-    // never found it - beyond end of time - extend
-    if (time - breaks[numBreaks-1] <= minbrk) {
-        // very close together - keep earlier, throw out new point
-        if (time < *ckt_breaks)
-            *ckt_breaks = nextbreak(ckt_time, minbrk);
-        *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-        return (true);
+    gens[numGens] = gen;
+    numGens++;
+
+    gen->advance(ckt_time);
+    double t;
+    if (gen_next(gen, ckt_time, minbrk, &t)) {
+        push(t, gen);
+        update(t, ckt_time, minbrk, ckt_breaks);
     }
-    // Fits at end - grow array & add.
-    Realloc(&breaks, numBreaks+1, numBreaks);
-    breaks[numBreaks] = time;
-    numBreaks++;
-    if (time < *ckt_breaks)
-        *ckt_breaks = nextbreak(ckt_time, minbrk);
-    *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-    return (true);
 }
 
 
@@ -192,9 +168,8 @@ double
 sCKTlattice::nextbreak(double t, double minbrk)
 {
     double dt0 = 0.0;
-    int i;
     if (lattices) {
-        for (i = 0; i < numLattices; i++) {
+        for (int i = 0; i < numLattices; i++) {
             double dt1 = lattices[i].offs;
             if (t > lattices[i].offs) {
                 dt1 += lattices[i].per *
@@ -206,16 +181,178 @@ sCKTlattice::nextbreak(double t, double minbrk)
                 dt0 = dt1;
         }
     }
-    for (i = 0; i < numBreaks; i++) {
-        if (breaks[i] > t)
-            break;
-    }
-    while (i < numBreaks && fabs(t - breaks[i]) < minbrk)
-        i++;
-    if (i == numBreaks)
+    double bt = -1.0;
+    find_next(0, t, minbrk, &bt);
+    if (bt < 0.0)
         return (dt0);
-    if (dt0 > 0.0 && dt0 < breaks[i])
+    if (dt0 > 0.0 && dt0 < bt)
         return (dt0);
-    return (breaks[i]);
+    return (bt);
 }
 
+
+// Private function to free the tables.
+//
+void
+sCKTlattice::clear()
+{
+    delete [] lattices;
+    delete [] breaks;
+    for (int i = 0; i < numGens; i++)
+        delete gens[i];
+    delete [] gens;
+    lattices = 0;
+    breaks = 0;
+    gens = 0;
+    numLattices = 0;
+    numBreaks = 0;
+    szBreaks = 0;
+    numGens = 0;
+    szGens = 0;
+}
+
+
+// Private function to add an element to the heap.
+//
+void
+sCKTlattice::push(double time, sCKTbreakGen *gen)
+{
+    if (numBreaks == szBreaks) {
+        int nsz = szBreaks ? 2*szBreaks : 16;
+        Realloc(&breaks, nsz, szBreaks);
+        szBreaks = nsz;
+    }
+    int i = numBreaks++;
+    while (i > 0) {
+        int p = (i - 1)/2;
+        if (breaks[p].time <= time)
+            break;
+        breaks[i] = breaks[p];
+        i = p;
+    }
+    breaks[i].time = time;
+    breaks[i].gen = gen;
+}
+
+
+// Private function to remove the earliest element from the heap.
+//
+void
+sCKTlattice::pop()
+{
+    if (!numBreaks)
+        return;
+    numBreaks--;
+    if (!numBreaks)
+        return;
+    brkelt e = breaks[numBreaks];
+    int i = 0;
+    for (;;) {
+        int c = 2*i + 1;
+        if (c >= numBreaks)
+            break;
+        if (c + 1 < numBreaks && breaks[c+1].time < breaks[c].time)
+            c++;
+        if (e.time <= breaks[c].time)
+            break;
+        breaks[i] = breaks[c];
+        i = c;
+    }
+    breaks[i] = e;
+}
+
+
+// Private function to update the circuit's next two breakpoints after
+// adding time.
+//
+void
+sCKTlattice::update(double time, double ckt_time, double minbrk,
+    double *ckt_breaks)
+{
+    if (time < *ckt_breaks)
+        *ckt_breaks = nextbreak(ckt_time, minbrk);
+    *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
+}
+
+
+// Private recursive function to find the earliest breakpoint in the
+// subheap rooted at i that is at least minbrk later than t.  The
+// result is returned in bt, which is negative if not found.  A
+// subheap whose root is not earlier than bt is skipped, and only
+// the elements earlier than t + minbrk are expanded, so this visits
+// only a few elements near the heap top.
+//
+void
+sCKTlattice::find_next(int i, double t, double minbrk, double *bt)
+{
+    if (i >= numBreaks)
+        return;
+    const brkelt &e = breaks[i];
+    if (*bt >= 0.0 && e.time >= *bt)
+        return;
+    double x = e.time;
+    if (x > t && x - t >= minbrk) {
+        // Children are later.
+        *bt = x;
+        return;
+    }
+    if (e.gen) {
+        // Pending points from the generator follow the head.
+        double tt = t;
+        while (gen_next(e.gen, tt, minbrk, &x)) {
+            if (x - t >= minbrk) {
+                if (*bt < 0.0 || x < *bt)
+                    *bt = x;
+                break;
+            }
+            tt = x;
+        }
+    }
+    find_next(2*i + 1, t, minbrk, bt);
+    find_next(2*i + 2, t, minbrk, bt);
+}
+
+
+// Private function, return true if time is within minbrk of a
+// lattice point.  These times are not added, the lattice provides
+// them.
+//
+bool
+sCKTlattice::on_lattice(double time, double minbrk)
+{
+    for (int i = 0; i < numLattices; i++) {
+        double dt0, dt1;
+        if (time < lattices[i].offs) {
+            dt0 = lattices[i].offs + lattices[i].per;
+            dt1 = lattices[i].offs;
+        }
+        else {
+            dt0 = lattices[i].per *
+                ceil((time - lattices[i].offs)/lattices[i].per) +
+                lattices[i].offs;
+            dt1 = lattices[i].per *
+                floor((time - lattices[i].offs)/lattices[i].per) +
+                lattices[i].offs;
+        }
+        if (fabs(time - dt0) < minbrk || fabs(time - dt1) < minbrk)
+            return (true);
+    }
+    return (false);
+}
+
+
+// Private function to set t to the first point from gen later than
+// tx, skipping points that coincide with the lattice as set_break
+// does.  Return false if there is no such point.
+//
+bool
+sCKTlattice::gen_next(sCKTbreakGen *gen, double tx, double minbrk,
+    double *t)
+{
+    while (gen->next_after(tx, t)) {
+        if (!on_lattice(*t, minbrk))
+            return (true);
+        tx = *t;
+    }
+    return (false);
+}
@@ -433,6 +433,22 @@ sCKT::breakSet(double time)
 }
 
 
+// Add a lazy breakpoint generator, the breakpoint table takes
+// ownership.
+//
+int
+sCKT::breakSetGen(sCKTbreakGen *gen)
+{
+    CKTlattice.set_break_gen(gen, CKTtime, CKTcurTask->TSKminBreak,
+        CKTbreaks);
+    if (Sp.GetFlag(FT_SIMDB)) {
+        TTY.err_printf("adding breakpoint generator: num = %d\n",
+            CKTlattice.numbreaks());
+    }
+    return (OK);
+}
+
+
 // Set up a periodic breakpoint.
 //
 int
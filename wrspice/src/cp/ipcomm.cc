@@ -50,6 +50,7 @@
 #include <sys/file.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #endif
 #include <errno.h>
 #include <signal.h>
@@ -141,6 +142,84 @@ CshPar::InitIPCmessage()
 }
 
 
+namespace {
+    // Input buffer for the message socket.  Messages and deck text
+    // from Xic used to be read a byte per recv call, which is slow
+    // when a large deck is sent.  All reads from the message socket
+    // must go through this buffer.  The buffer is keyed to the
+    // socket, and is discarded if the socket changes.  Since a new
+    // socket may be given the same descriptor, the buffer is also
+    // discarded when the socket is closed, see MesgClose.
+    //
+    struct sMesgBuf
+    {
+        sMesgBuf()
+            {
+                reset(-1);
+            }
+
+        void reset(int sock)
+            {
+                mb_sock = sock;
+                mb_cnt = 0;
+                mb_ptr = 0;
+            }
+
+        int mb_sock;
+        int mb_cnt;
+        int mb_ptr;
+        char mb_buf[4096];
+    };
+
+    sMesgBuf mesg_buf;
+}
+
+
+// Read a byte from the message socket into c.  The return value is
+// as for recv:  1 on success, 0 on EOF, -1 on error with errno set.
+//
+int
+CshPar::MesgRead(char *c)
+{
+    if (mesg_buf.mb_sock != cp_mesg_sock)
+        mesg_buf.reset(cp_mesg_sock);
+    if (mesg_buf.mb_ptr >= mesg_buf.mb_cnt) {
+        int i = recv(cp_mesg_sock, mesg_buf.mb_buf, sizeof(mesg_buf.mb_buf),
+            0);
+        if (i <= 0)
+            return (i);
+        mesg_buf.mb_cnt = i;
+        mesg_buf.mb_ptr = 0;
+    }
+    *c = mesg_buf.mb_buf[mesg_buf.mb_ptr++];
+    return (1);
+}
+
+
+// Return true if message socket bytes have been read and buffered
+// but not consumed.  The socket itself may not select as readable
+// in this case, so the input loop must check this first.
+//
+bool
+CshPar::MesgPending()
+{
+    return (cp_mesg_sock >= 0 && mesg_buf.mb_sock == cp_mesg_sock &&
+        mesg_buf.mb_ptr < mesg_buf.mb_cnt);
+}
+
+
+// Close the message socket, and discard any buffered input.
+//
+void
+CshPar::MesgClose()
+{
+    if (cp_mesg_sock >= 0)
+        CLOSESOCKET(cp_mesg_sock);
+    cp_mesg_sock = -1;
+    mesg_buf.reset(-1);
+}
+
+
 namespace {
     bool write_msg(const char *str)
     {
@@ -198,6 +277,69 @@ namespace {
     }
 
 
+    // Send a "data <nbytes>" message followed by the data block in a
+    // single write, so that the small header does not sit in the
+    // socket waiting for an ack.
+    //
+    bool write_data_msg(const char *buf, unsigned int nbytes)
+    {
+        char hdr[32];
+        snprintf(hdr, sizeof(hdr), "data %u", nbytes);
+        if (netdbg())
+            TTY.err_printf("wrspice: sending \"%s\"\n", hdr);
+        unsigned int hlen = strlen(hdr) + 1;
+        char *mbuf = new char[hlen + nbytes];
+        memcpy(mbuf, hdr, hlen);
+        memcpy(mbuf + hlen, buf, nbytes);
+        bool ret = write_data(mbuf, hlen + nbytes);
+        delete [] mbuf;
+        return (ret);
+    }
+
+
+#ifndef WIN32
+    // Name of the last shared memory segment created for "evalshm". 
+    // Xic unlinks the segment after reading it, this is a backup in
+    // case that didn't happen.
+    char shm_last_name[64];
+    unsigned int shm_count;
+
+    // Create and map a POSIX shared memory segment of nbytes.  The
+    // name is returned in name, which must be at least 64 bytes. 
+    // Return the mapped address, or null on error.
+    //
+    void *shm_map(unsigned int nbytes, char *name)
+    {
+        if (shm_last_name[0]) {
+            shm_unlink(shm_last_name);
+            shm_last_name[0] = 0;
+        }
+        snprintf(name, 64, "/wrspice.%d.%u", (int)getpid(), shm_count++);
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            GRpkg::self()->Perror("shm_open");
+            return (0);
+        }
+        if (ftruncate(fd, nbytes) < 0) {
+            GRpkg::self()->Perror("ftruncate");
+            close(fd);
+            shm_unlink(name);
+            return (0);
+        }
+        void *addr = mmap(0, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            GRpkg::self()->Perror("mmap");
+            shm_unlink(name);
+            return (0);
+        }
+        strcpy(shm_last_name, name);
+        return (addr);
+    }
+#endif
+
+
     // Reverse the byte order if the MSB's are at the top address, i.e.,
     // switch to/from "network byte order".  This will reverse bytes on
     // Intel x86, but is a no-op on Sun SPARC (for example).
@@ -250,7 +392,7 @@ CshPar::MessageHandler(int fc)
         *s++ = fc;
     for (;;) {
         char c;
-        int i = recv(cp_mesg_sock, &c, 1, 0);
+        int i = MesgRead(&c);
         if (i <= 0) {
             // EOF or error
             if (i < 0) {
@@ -360,8 +502,7 @@ CshPar::MessageHandler(int fc)
         pid_t pid = isdigit(*s) ? atoi(s) : 0;
         if (pid > 0) {
             // Spice is parent of graphical editor.
-            CLOSESOCKET(cp_mesg_sock);
-            cp_mesg_sock = -1;
+            MesgClose();
         }
         else if (pid == 0) {
             // Spice is child of graphical editor, exit
@@ -397,8 +538,16 @@ CshPar::MessageHandler(int fc)
         if (!wrote)
             write_msg(buf);
     }
-    else if (lstring::match("eval", buf)) {
-        // Evaluate an expression, return result as binary data.
+    else if (lstring::match("eval", buf) ||
+            lstring::match("evalshm", buf)) {
+        // Evaluate an expression, return result as binary data.  For
+        // "evalshm", the data are written to a shared memory segment
+        // in native byte order and the reply is "shm <name> <nbytes>". 
+        // Xic sends this only to a local WRspice that advertised
+        // support in the ping reply.  If the segment can't be
+        // created, the data are returned through the socket as for
+        // "eval".
+        bool useshm = (buf[4] == 's');
         lstring::advtok(&s);
         bool wrote = false;
         while (*s) {
@@ -414,33 +563,63 @@ CshPar::MessageHandler(int fc)
             sDataVec *dv = dl0->dl_dvec;
             if (dv) {
                 int len = dv->length();
-                int datalen = len*sizeof(double);
+                unsigned int datalen = len*sizeof(double);
                 if (dv->iscomplex())
                     datalen *= 2;
-                // Header: "okdr" or "okdc", 4B len in network byte order.
+                // Header: "okdr" or "okdc", 4B len in network byte order,
+                // or "oknr" or "oknc", 4B len in native byte order.
                 datalen += 8;
 
-                snprintf(buf, sizeof(buf), "data %d", datalen);
-                write_msg(buf);
-
-                char *dbuf = new char[datalen];
+                char *dbuf = 0;
+#ifndef WIN32
+                char shmname[64];
+                if (useshm)
+                    dbuf = (char*)shm_map(datalen, shmname);
+#endif
+                bool native = (dbuf != 0);
+                if (!dbuf)
+                    dbuf = new char[datalen];
                 unsigned int *uip = (unsigned int*)dbuf;
                 double *dp = (double*)(dbuf + 8);
                 dbuf[0] = 'o';
                 dbuf[1] = 'k';
-                dbuf[2] = 'd';  // double data, extend to other types
+                dbuf[2] = native ? 'n' : 'd';  // double data
                 dbuf[3] = dv->iscomplex() ? 'c' : 'r';
-                uip[1] = htonl(len);
-                for (int i = 0; i < len; i++) {
-                    if (dv->iscomplex()) {
-                        *dp++ = net_byte_reorder(dv->realval(i));
-                        *dp++ = net_byte_reorder(dv->imagval(i));
+                if (native) {
+                    uip[1] = len;
+                    for (int i = 0; i < len; i++) {
+                        if (dv->iscomplex()) {
+                            *dp++ = dv->realval(i);
+                            *dp++ = dv->imagval(i);
+                        }
+                        else
+                            *dp++ = dv->realval(i);
+                    }
+                }
+                else {
+                    uip[1] = htonl(len);
+                    for (int i = 0; i < len; i++) {
+                        if (dv->iscomplex()) {
+                            *dp++ = net_byte_reorder(dv->realval(i));
+                            *dp++ = net_byte_reorder(dv->imagval(i));
+                        }
+                        else
+                            *dp++ = net_byte_reorder(dv->realval(i));
                     }
-                    else
-                        *dp++ = net_byte_reorder(dv->realval(i));
                 }
-                write_data(dbuf, datalen);
-                delete [] dbuf;
+#ifndef WIN32
+                if (native) {
+                    munmap(dbuf, datalen);
+                    snprintf(buf, sizeof(buf), "shm %s %u", shmname,
+                        datalen);
+                    write_msg(buf);
+                }
+                else
+#endif
+                {
+                    write_data_msg(dbuf, datalen);
+                    delete [] dbuf;
+                }
                 wrote = true;
             }
             sDvList::destroy(dl0);
@@ -480,11 +659,16 @@ CshPar::MessageHandler(int fc)
         // catchar is set to ":" and mode to SPICE3.
 
         // The argument(s) to ping have the following syntax:
-        //   [-sc<catchar>][ ][-sm<mode>]
+        //   [-sc<catchar>][ ][-sm<mode>][ ][-sh]
         // where <mode> is a digit character ('0' plus the enum value).
+        // The -sh option, which must follow -sm, is a query for
+        // shared memory support, used by the evalshm command.  If
+        // supported, an 's' is appended to the return.  Earlier
+        // releases stop parsing at -sh and don't append anything.
 
         lstring::advtok(&s);
         bool modeset = false;
+        bool shmquery = false;
         for (;;) {
             if (isspace(*s)) {
                 s++;
@@ -510,10 +694,18 @@ CshPar::MessageHandler(int fc)
                 modeset = true;
                 continue;
             }
+            if (s[0] == 's' && s[1] == 'h') {
+                s += 2;
+                shmquery = true;
+                continue;
+            }
         }
         if (modeset) {
-            snprintf(buf, sizeof(buf), "ok%c%c", Sp.SubcCatchar(),
-                '0' + Sp.SubcCatmode());
+#ifdef WIN32
+            shmquery = false;
+#endif
+            snprintf(buf, sizeof(buf), "ok%c%c%s", Sp.SubcCatchar(),
+                '0' + Sp.SubcCatmode(), shmquery ? "s" : "");
         }
         else
             snprintf(buf, sizeof(buf), "ok%c", Sp.SubcCatchar());
@@ -620,10 +812,7 @@ CommandTab::com_sced(wordlist *wl)
         TTY.printf("Graphical editor is already active.\n");
         return;
     }
-    if (CP.MesgSocket() >= 0) {
-        CLOSESOCKET(CP.MesgSocket());
-        CP.SetMesgSocket(-1);
-    }
+    CP.MesgClose();
 
     // Find the path to Xic.  In Windows, this is .../xictools/bin,
     // otherwise it is .../xictools/xic/bin, for current releases.
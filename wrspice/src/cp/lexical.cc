@@ -1076,28 +1076,31 @@ CshPar::Getchar(int fd, bool literal, bool drain)
                 nfds = cp_acct_sock;
             }
 
+            // Buffered message text may be waiting, the socket won't
+            // select as readable in this case.
+            bool pending = MesgPending();
+
             timeval timeout;
             timeout.tv_sec = 0;
-            timeout.tv_usec = 50000;
+            timeout.tv_usec = pending ? 0 : 50000;
 
             int i = select(nfds + 1, &readfds, 0, 0, &timeout);
 
-            if (i > 0) {
-                if (cp_mesg_sock >= 0 && FD_ISSET(cp_mesg_sock, &readfds)) {
+            if (i > 0 || pending) {
+                if (cp_mesg_sock >= 0 &&
+                        (pending || FD_ISSET(cp_mesg_sock, &readfds))) {
                     // got a message
                     char xx;
-                    i = recv(cp_mesg_sock, &xx, 1, 0);
+                    i = MesgRead(&xx);
                     if (i == 1) {
                         if (!MessageHandler(xx)) {
                             fprintf(stderr, eofmsg, cp_program);
-                            closesocket(cp_mesg_sock);
-                            cp_mesg_sock = -1;
+                            MesgClose();
                         }
                     }
                     else if (i == 0) {
                         fprintf(stderr, eofmsg, cp_program);
-                        closesocket(cp_mesg_sock);
-                        cp_mesg_sock = -1;
+                        MesgClose();
                     }
                 }
                 else if (cp_acct_sock >= 0 &&
@@ -1207,9 +1210,13 @@ CshPar::Getchar(int fd, bool literal, bool drain)
                 if (cp_acct_sock > nfds)
                     nfds = cp_acct_sock;
             }
+            // Buffered message text may be waiting, the socket won't
+            // select as readable in this case.
+            bool pending = MesgPending();
+
             timeval timeout;
             timeout.tv_sec = 0;
-            timeout.tv_usec = 500;
+            timeout.tv_usec = pending ? 0 : 500;
 #ifdef SELECT_TAKES_INTP
             // this stupidity from HPUX
             int i = select(nfds + 1, (int*)&readfds, 0, 0, &timeout);
@@ -1219,7 +1226,7 @@ CshPar::Getchar(int fd, bool literal, bool drain)
             if (i == -1)
                 // interrupts do this
                 continue;
-            if (i == 0) {
+            if (i == 0 && !pending) {
                 // timeout
                 GP.Checkup();
                 if (ofs) {
@@ -1250,21 +1257,20 @@ CshPar::Getchar(int fd, bool literal, bool drain)
                 }
                 continue;
             }
-            if (cp_mesg_sock >= 0 && FD_ISSET(cp_mesg_sock, &readfds)) {
+            if (cp_mesg_sock >= 0 &&
+                    (pending || FD_ISSET(cp_mesg_sock, &readfds))) {
                 // got a message
                 char xx;
-                i = read(cp_mesg_sock, &xx, 1);
+                i = MesgRead(&xx);
                 if (i == 1) {
                     if (!MessageHandler(xx)) {
                         fprintf(stderr, eofmsg, cp_program);
-                        close(cp_mesg_sock);
-                        cp_mesg_sock = -1;
+                        MesgClose();
                     }
                 }
                 else if (i == 0) {
                     fprintf(stderr, eofmsg, cp_program);
-                    close(cp_mesg_sock);
-                    cp_mesg_sock = -1;
+                    MesgClose();
                 }
                 continue;
             }
@@ -49,6 +49,7 @@ Authors: 1985 Wayne A. Christopher
 #include "datavec.h"
 #include "output.h"
 #include "cshell.h"
+#include "vecspill.h"
 #include "ginterf/graphics.h"
 
 
@@ -67,10 +68,7 @@ sDataVec::~sDataVec()
         unsegmentize();
     delete [] v_name;
     sDvList::destroy(v_link2);
-    if (isreal())
-        delete [] v_data.real;
-    else
-        delete [] v_data.comp;
+    free_data();
 }
 
 
@@ -79,12 +77,8 @@ sDataVec::~sDataVec()
 void
 sDataVec::reset(int type, int len, sUnits *u, void *data)
 {
-    if (isreal())
-        delete [] v_data.real;
-    else
-        delete [] v_data.comp;
+    free_data();
 
-    v_data.real = 0;
     if (data)
         v_data.real = (double*)data;
     else if (len) {
@@ -353,6 +347,55 @@ sDataVec::alloc(bool real, int size)
 }
 
 
+// Allocate zeroed data in memory-mapped storage, if enabled.  On
+// success, the allocated length may be larger than size.  If false
+// is returned, nothing was done and the caller should use alloc.
+//
+bool
+sDataVec::alloc_spill(bool real, int size)
+{
+    if (size <= 0 || !VecSpill.enabled())
+        return (false);
+    size_t esz = real ? sizeof(double) : sizeof(complex);
+    sVecMap *m = VecSpill.map_new(size*esz);
+    if (!m)
+        return (false);
+    v_map = m;
+    v_data.real = (double*)m->vm_base;
+    v_rlength = m->vm_size/esz;
+    return (true);
+}
+
+
+// Free the data storage, whether from the heap or mapped.
+//
+void
+sDataVec::free_data()
+{
+    if (!unmap(v_data.real)) {
+        if (isreal())
+            delete [] v_data.real;
+        else
+            delete [] v_data.comp;
+    }
+    v_data.real = 0;
+}
+
+
+// If p is the base of the mapped storage, release the mapping and
+// return true.
+//
+bool
+sDataVec::unmap(const void *p)
+{
+    if (!v_map || p != v_map->vm_base)
+        return (false);
+    VecSpill.map_free(v_map);
+    v_map = 0;
+    return (true);
+}
+
+
 void
 sDataVec::resize(int newsize, int extra)
 {
@@ -370,13 +413,29 @@ sDataVec::resize(int newsize, int extra)
         newsize += extra;
     }
 
+    if (v_map && v_data.real == v_map->vm_base) {
+        // Grow or shrink the mapping in place.  If this fails, fall
+        // through and copy to the heap.
+        size_t esz = isreal() ? sizeof(double) : sizeof(complex);
+        if (VecSpill.map_resize(v_map, newsize*esz, cpsz*esz)) {
+            char *p = (char*)v_map->vm_base;
+            if (cpsz < newsize)
+                memset(p + cpsz*esz, 0, (newsize - cpsz)*esz);
+            v_data.real = (double*)p;
+            v_length = cpsz;
+            v_rlength = v_map->vm_size/esz;
+            return;
+        }
+    }
+
     if (isreal()) {
         double *oldv = v_data.real;
         v_data.real = new double[newsize];
         memcpy(v_data.real, oldv, cpsz*sizeof(double));
         if (cpsz < newsize)
             memset(v_data.real + cpsz, 0, (newsize - cpsz)*sizeof(double));
-        delete [] oldv;
+        if (!unmap(oldv))
+            delete [] oldv;
     }
     else {
         complex *oldv = v_data.comp;
@@ -386,7 +445,8 @@ sDataVec::resize(int newsize, int extra)
             memset((void*)(v_data.comp + cpsz), 0,
                 (newsize - cpsz)*sizeof(complex));
         }
-        delete [] oldv;
+        if (!unmap(oldv))
+            delete [] oldv;
     }
     v_length = cpsz;
     v_rlength = newsize;
@@ -576,6 +636,28 @@ sDataVec::extend(int len)
         v_length = len;
         return;
     }
+    if (v_map && v_data.real == v_map->vm_base && v_rlength < len) {
+        size_t esz = isreal() ? sizeof(double) : sizeof(complex);
+        if (VecSpill.map_resize(v_map, len*esz, v_length*esz)) {
+            v_data.real = (double*)v_map->vm_base;
+            v_rlength = v_map->vm_size/esz;
+        }
+    }
+    if (v_map && v_data.real == v_map->vm_base && v_rlength >= len) {
+        int i = v_length;
+        if (isreal()) {
+            double d = i > 0 ? v_data.real[i-1] : 0.0;
+            while (i < len)
+                v_data.real[i++] = d;
+        }
+        else {
+            complex c = i > 0 ? v_data.comp[i-1] : complex(0, 0);
+            while (i < len)
+                v_data.comp[i++] = c;
+        }
+        v_length = len;
+        return;
+    }
     if (isreal()) {
         double *oldv = v_data.real;
         v_data.real = new double[len];
@@ -585,7 +667,8 @@ sDataVec::extend(int len)
         double d = i > 0 ? oldv[i-1] : 0.0;
         while (i < len)
             v_data.real[i++] = d;
-        delete [] oldv;
+        if (!unmap(oldv))
+            delete [] oldv;
     }
     else {
         complex *oldv = v_data.comp;
@@ -596,9 +679,11 @@ sDataVec::extend(int len)
         complex c = i > 0 ? oldv[i-1] : complex(0, 0);
         while (i < len)
             v_data.comp[i++] = c;
-        delete [] oldv;
+        if (!unmap(oldv))
+            delete [] oldv;
     }
     v_length = len;
+    v_rlength = len;
 }
 
 
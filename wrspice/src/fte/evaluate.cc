@@ -63,6 +63,7 @@ namespace {
     sDataVec *op_range(pnode*, pnode*);
     sDataVec *op_ind(pnode*, pnode*);
     sDataVec *evfunc(sDataVec**, sFunc*);
+    bool is_random(sFunc*);
     sDataVec *do_fft(sDataVec*, sFunc*);
     void fft_scale(sDataVec*, sDataVec*, bool);
 }
@@ -122,6 +123,10 @@ IFsimulator::Evaluate(pnode *node, bool nocopy)
         if (d == 0) {
             d = OP.vecGet(node->token_string(),
                 ft_curckt ? ft_curckt->runckt() : 0);
+
+            // The constants never change, other vectors may.
+            if (!d || d->plot() != OP.constants())
+                ft_volatile_evals++;
             // note that "vs" can be a real vector, x-y plots only if
             // undefined.
             //
@@ -280,6 +285,7 @@ pnode::apply_func() const
         }
         else
             t = OP.curPlot()->find_vec(buf);
+        Sp.CountVolatileEval();
         if (!t) {
             Sp.Error(E_NOVEC, 0, buf);
             return (0);
@@ -774,6 +780,9 @@ namespace {
 
     sDataVec *evfunc(sDataVec **v, sFunc *func)
     {
+        if (is_random(func))
+            Sp.CountVolatileEval();
+
         sDataVec *res;
         if (func->func() == &sDataVec::v_fft ||
                 func->func() == &sDataVec::v_ifft)
@@ -821,6 +830,25 @@ namespace {
     }
 
 
+    // Return true if the function returns random values.
+    //
+    bool is_random(sFunc *func)
+    {
+        if (func->argc() == 1) {
+            fuFuncType f = func->func();
+            return (f == &sDataVec::v_rnd || f == &sDataVec::v_ogauss ||
+                f == &sDataVec::v_exponential || f == &sDataVec::v_chisq ||
+                f == &sDataVec::v_erlang || f == &sDataVec::v_tdist ||
+                f == &sDataVec::v_beta || f == &sDataVec::v_binomial ||
+                f == &sDataVec::v_poisson);
+        }
+        fuFuncType1 f = func->func1();
+        return (f == &sDataVec::v_hs_unif || f == &sDataVec::v_hs_aunif ||
+            f == &sDataVec::v_hs_gauss || f == &sDataVec::v_hs_agauss ||
+            f == &sDataVec::v_hs_limit);
+    }
+
+
     // Perform the fft functions, taking care of dimensions.
     //
     sDataVec *do_fft(sDataVec *v, sFunc *func)
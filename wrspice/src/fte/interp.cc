@@ -58,6 +58,46 @@ Authors: 1985 Wayne A. Christopher
 // Polynomial interpolation code.
 //
 
+namespace {
+    // Evaluate the polynomial with degr+1 coefficients at n points
+    // x, results to y.  The points are swept once per coefficient,
+    // so that the inner loop is a multiply-add over contiguous
+    // arrays, which the compiler can vectorize.
+    //
+    void
+    peval_n(const double *x, double *y, int n, const double *coeffs,
+        int degr)
+    {
+        double c = coeffs[degr];
+        for (int j = 0; j < n; j++)
+            y[j] = c;
+        for (int i = degr - 1; i >= 0; i--) {
+            c = coeffs[i];
+            for (int j = 0; j < n; j++)
+                y[j] = y[j]*x[j] + c;
+        }
+    }
+
+
+    // Fill in ndata from start through end.  Points that precede
+    // the first old scale point take the first data value, as the
+    // scales are monotonic these form a prefix.  The rest are
+    // evaluated from the coefficients.
+    //
+    void
+    interp_span(const double *nscale, double *ndata, int start, int end,
+        double ostart, double dstart, int sign, const double *coeffs,
+        int degr)
+    {
+        int j = start;
+        for ( ; j <= end && nscale[j]*sign < ostart*sign; j++)
+            ndata[j] = dstart;
+        if (j <= end)
+            peval_n(nscale + j, ndata + j, end - j + 1, coeffs, degr);
+    }
+}
+
+
 // Interpolate data from oscale to nscale.  data is assumed to be olen
 // long, ndata will be nlen long.  Returns false if the scales are too
 // strange to deal with.  Note that we are guaranteed that either both
@@ -112,12 +152,8 @@ sPoly::interp(double *data, double *ndata, double *oscale, int olen,
                 break;
         end--;
 
-        for (int j = lastone + 1; j <= end; j++) {
-            if (nscale[j]*sign < oscale[0]*sign)
-                ndata[j] = data[0];
-            else
-                ndata[j] = peval(nscale[j], result);
-        }
+        interp_span(nscale, ndata, lastone + 1, end, oscale[0], data[0],
+            sign, result, pc_degree);
         lastone = end;
     }
 
@@ -149,12 +185,8 @@ sPoly::interp(double *data, double *ndata, double *oscale, int olen,
                 break;
         end--;
 
-        for (int j = lastone + 1; j <= end; j++) {
-            if (nscale[j]*sign < oscale[0]*sign)
-                ndata[j] = data[0];
-            else
-                ndata[j] = peval(nscale[j], result);
-        }
+        interp_span(nscale, ndata, lastone + 1, end, oscale[0], data[0],
+            sign, result, pc_degree);
         lastone = end;
     }
 
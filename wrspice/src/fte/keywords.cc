@@ -49,6 +49,7 @@
 #include "kwords_analysis.h"
 #include "toolbar.h"
 #include "circuit.h"
+#include "vecspill.h"
 #include "spnumber/spnumber.h"
 #include "miscutil/filestat.h"
 #include "ginterf/graphics.h"
@@ -2296,6 +2297,7 @@ const char *kw_helpinitypos     = "helpinitypos";
 const char *kw_helppath         = "helppath";
 const char *kw_installcmdfmt    = "installcmdfmt";
 const char *kw_level            = "level";
+const char *kw_meastime         = "meastime";
 const char *kw_modpath          = "modpath";
 const char *kw_mplot_cur        = "mplot_cur";
 const char *kw_nfreqs           = "nfreqs";
@@ -2305,6 +2307,8 @@ const char *kw_nopadding        = "nopadding";
 const char *kw_nopage           = "nopage";
 const char *kw_noprtitle        = "noprtitle";
 const char *kw_numdgt           = "numdgt";
+const char *kw_parsethreads     = "parsethreads";
+const char *kw_postthreads      = "postthreads";
 const char *kw_printautowidth   = "printautowidth";
 const char *kw_printnoheader    = "printnoheader";
 const char *kw_printnoindex     = "printnoindex";
@@ -2319,6 +2323,7 @@ const char *kw_spectrace        = "spectrace";
 const char *kw_specwindow       = "specwindow";
 const char *kw_specwindoworder  = "specwindoworder";
 const char *kw_spicepath        = "spicepath";
+const char *kw_spilldata        = "spilldata";
 const char *kw_units            = "units";
 const char *kw_xicpath          = "xicpath";
 
@@ -2736,6 +2741,22 @@ struct KWent_level : public KWent
     }
 };
 
+struct KWent_meastime : public KWent
+{
+    KWent_meastime() { set(
+        kw_meastime,
+        VTYP_BOOL, 0.0, 0.0,
+        "Print time used by each measurement."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset)
+            v->set_boolean(true);
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_modpath : public KWent
 {
     KWent_modpath() { set(
@@ -2909,6 +2930,60 @@ struct KWent_numdgt : public KWent
     }
 };
 
+struct KWent_parsethreads : public KWent
+{
+    KWent_parsethreads() { set(
+        kw_parsethreads,
+        VTYP_NUM, DEF_parsethreads_MIN, DEF_parsethreads_MAX,
+        "Number of helper threads for circuit parsing, default "
+            STRINGIFY(DEF_parsethreads) "."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max) {
+                int val = (int)v->real();
+                v->set_integer(val);
+            }
+            else if (!(v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max)) {
+                error_pr(word, 0, pr_integer((int)min, (int)max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
+struct KWent_postthreads : public KWent
+{
+    KWent_postthreads() { set(
+        kw_postthreads,
+        VTYP_NUM, DEF_postthreads_MIN, DEF_postthreads_MAX,
+        "Number of helper threads for measure, fourier, spec, default "
+            STRINGIFY(DEF_postthreads) "."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max) {
+                int val = (int)v->real();
+                v->set_integer(val);
+            }
+            else if (!(v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max)) {
+                error_pr(word, 0, pr_integer((int)min, (int)max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_printautowidth : public KWent
 {
     KWent_printautowidth() { set(
@@ -3203,6 +3278,34 @@ struct KWent_spicepath : public KWent
     }
 };
 
+struct KWent_spilldata : public KWent
+{
+    KWent_spilldata() { set(
+        kw_spilldata,
+        VTYP_REAL, DEF_spillData_MIN, DEF_spillData_MAX,
+        "Store plot data in mapped files, resident KB, default "
+            STRINGIFY(DEF_spillData) "."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max) {
+                double dval = v->integer();
+                v->set_real(dval);
+            }
+            else if (!(v->type() == VTYP_BOOL ||
+                    (v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max))) {
+                error_pr(word, 0, pr_real(min, max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_units : public KWent
 {
     KWent_units() { set(
@@ -3288,6 +3391,7 @@ Kword *cKeyWords::KWcmds[] = {
     new KWent_helppath(),
     new KWent_installcmdfmt(),
     new KWent_level(),
+    new KWent_meastime(),
     new KWent_modpath(),
     new KWent_mplot_cur(),
     new KWent_nfreqs(),
@@ -3297,6 +3401,8 @@ Kword *cKeyWords::KWcmds[] = {
     new KWent_nopage(),
     new KWent_noprtitle(),
     new KWent_numdgt(),
+    new KWent_parsethreads(),
+    new KWent_postthreads(),
     new KWent_printautowidth(),
     new KWent_printnoheader(),
     new KWent_printnoindex(),
@@ -3311,6 +3417,7 @@ Kword *cKeyWords::KWcmds[] = {
     new KWent_specwindow(),
     new KWent_specwindoworder(),
     new KWent_spicepath(),
+    new KWent_spilldata(),
     new KWent_units(),
     new KWent_xicpath(),
     new Kword(0, 0)
@@ -3806,6 +3913,8 @@ Kword *cKeyWords::KWstep[] = {
 const char *kw_modelcard        = "modelcard";
 const char *kw_pexnodes         = "pexnodes";
 const char *kw_nobjthack        = "nobjthack";
+const char *kw_nosubtemplate    = "nosubtemplate";
+const char *kw_netcachedir      = "netcachedir";
 const char *kw_subend           = "subend";
 const char *kw_subinvoke        = "subinvoke";
 const char *kw_substart         = "substart";
@@ -5477,6 +5586,42 @@ struct KWent_nobjthack : public KWent
     }
 };
 
+struct KWent_nosubtemplate : public KWent
+{
+    KWent_nosubtemplate() { set(
+        kw_nosubtemplate,
+        VTYP_BOOL, 0.0, 0.0,
+        "Don't reuse expanded subcircuit bodies."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset)
+            v->set_boolean(true);
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
+struct KWent_netcachedir : public KWent
+{
+    KWent_netcachedir() { set(
+        kw_netcachedir,
+        VTYP_STRING, 0.0, 0.0,
+        "Directory for saved subcircuit expansions."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() != VTYP_STRING) {
+                error_pr(word, 0, "a string");
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_subend : public KWent
 {
     KWent_subend() { set(
@@ -5610,6 +5755,8 @@ Kword *cKeyWords::KWsim[] = {
     new KWent_modelcard(),
     new KWent_pexnodes(),
     new KWent_nobjthack(),
+    new KWent_nosubtemplate(),
+    new KWent_netcachedir(),
     new KWent_nocacheelts(),
     new KWent_noiter(),
     new KWent_nojjtp(),
@@ -51,6 +51,8 @@
 #include "spnumber/hash.h"
 #include "spnumber/spnumber.h"
 #include "miscutil/lstring.h"
+#include "miscutil/threadpool.h"
+#include <algorithm>
 
 //
 // Functions for the measurement run operation.
@@ -505,9 +507,383 @@ sMfunc::mrft(sDataVec *dv, int ixmin, int ixmax, sXpt *spt, sXpt *ept,
         f_val = 0.0;
     return (true);
 }
+
+
+// Perform the measurement according to the type.
+//
+bool
+sMfunc::measure(sDataVec *dv, int ixmin, int ixmax, sXpt *spt, sXpt *ept)
+{
+    if (f_type == Mmin)
+        return (mmin(dv, ixmin, ixmax, spt, ept));
+    if (f_type == Mmax)
+        return (mmax(dv, ixmin, ixmax, spt, ept));
+    if (f_type == Mpp)
+        return (mpp(dv,  ixmin, ixmax, spt, ept));
+    if (f_type == Mavg)
+        return (mavg(dv, ixmin, ixmax, spt, ept));
+    if (f_type == Mrms)
+        return (mrms(dv, ixmin, ixmax, spt, ept));
+    if (f_type == Mpw)
+        return (mpw(dv,  ixmin, ixmax, spt, ept));
+    if (f_type == Mrft)
+        return (mrft(dv, ixmin, ixmax, spt, ept));
+    return (false);
+}
 // End of sMfunc functions.
 
 
+//
+// Batched measurement evaluation.  When several measurements are
+// ready at the same time, the expressions are evaluated first (this
+// uses the parser and is done in the main thread), saving the
+// interval functions as tasks.  Tasks that share a vector and
+// interval are grouped, and min/max/pp/avg/rms in a group are
+// computed from a single pass over the data.  The groups are
+// independent and can be computed in parallel, using the number of
+// helper threads given by the postthreads variable.
+//
+
+namespace {
+    // Don't bother with threads unless there are at least this many
+    // points to process.
+    //
+#define MB_MT_MIN 50000
+
+    // A saved interval measurement.
+    //
+    struct sMtask
+    {
+        sRunopMeas  *owner;
+        sMfunc      *func;
+        sDataVec    *dv;
+        int         ixmin;
+        int         ixmax;
+        sXpt        spt;
+        sXpt        ept;
+    };
+
+    // Tasks with the same vector and interval.
+    //
+    struct sMgroup
+    {
+        sMtask      *tasks;
+        int         ntasks;
+        double      time;
+    };
+
+    inline bool mtask_lt(const sMtask &a, const sMtask &b)
+    {
+        if (a.dv != b.dv)
+            return ((uintptr_t)a.dv < (uintptr_t)b.dv);
+        if (a.ixmin != b.ixmin)
+            return (a.ixmin < b.ixmin);
+        if (a.ixmax != b.ixmax)
+            return (a.ixmax < b.ixmax);
+        if (a.spt.scval != b.spt.scval)
+            return (a.spt.scval < b.spt.scval);
+        if (a.spt.val != b.spt.val)
+            return (a.spt.val < b.spt.val);
+        if (a.ept.scval != b.ept.scval)
+            return (a.ept.scval < b.ept.scval);
+        return (a.ept.val < b.ept.val);
+    }
+
+    inline bool mtask_same(const sMtask &a, const sMtask &b)
+    {
+        return (a.dv == b.dv && a.ixmin == b.ixmin && a.ixmax == b.ixmax &&
+            a.spt.scval == b.spt.scval && a.spt.val == b.spt.val &&
+            a.ept.scval == b.ept.scval && a.ept.val == b.ept.val);
+    }
+
+    // Find the minimum and maximum of y[i0] through y[i1].  Four
+    // independent lanes are used so that the compiler can vectorize
+    // and pipeline the comparisons.
+    //
+    void mb_minmax(const double *y, int i0, int i1, double *pmn, double *pmx)
+    {
+        double mn0 = y[i0], mn1 = mn0, mn2 = mn0, mn3 = mn0;
+        double mx0 = mn0, mx1 = mn0, mx2 = mn0, mx3 = mn0;
+        int i = i0 + 1;
+        for ( ; i + 3 <= i1; i += 4) {
+            double a = y[i], b = y[i+1], c = y[i+2], d = y[i+3];
+            mn0 = a < mn0 ? a : mn0;
+            mn1 = b < mn1 ? b : mn1;
+            mn2 = c < mn2 ? c : mn2;
+            mn3 = d < mn3 ? d : mn3;
+            mx0 = a > mx0 ? a : mx0;
+            mx1 = b > mx1 ? b : mx1;
+            mx2 = c > mx2 ? c : mx2;
+            mx3 = d > mx3 ? d : mx3;
+        }
+        for ( ; i <= i1; i++) {
+            mn0 = y[i] < mn0 ? y[i] : mn0;
+            mx0 = y[i] > mx0 ? y[i] : mx0;
+        }
+        mn0 = SPMIN(SPMIN(mn0, mn1), SPMIN(mn2, mn3));
+        mx0 = SPMAX(SPMAX(mx0, mx1), SPMAX(mx2, mx3));
+        *pmn = mn0;
+        *pmx = mx0;
+    }
+
+    // Trapezoid integrals of y and y*y over x[i0] through x[i1],
+    // times two.
+    //
+    void mb_integ(const double *x, const double *y, int i0, int i1,
+        double *ps1, double *ps2)
+    {
+        double s10 = 0.0, s11 = 0.0, s20 = 0.0, s21 = 0.0;
+        int i = i0 + 1;
+        for ( ; i + 1 <= i1; i += 2) {
+            double d0 = x[i] - x[i-1];
+            double d1 = x[i+1] - x[i];
+            double y0 = y[i-1], y1 = y[i], y2 = y[i+1];
+            s10 += d0*(y0 + y1);
+            s11 += d1*(y1 + y2);
+            s20 += d0*(y0*y0 + y1*y1);
+            s21 += d1*(y1*y1 + y2*y2);
+        }
+        for ( ; i <= i1; i++) {
+            double d = x[i] - x[i-1];
+            s10 += d*(y[i-1] + y[i]);
+            s20 += d*(y[i-1]*y[i-1] + y[i]*y[i]);
+        }
+        *ps1 = s10 + s11;
+        *ps2 = s20 + s21;
+    }
+
+    // Compute the results for a group of tasks.
+    //
+    void mb_eval(sMgroup *g)
+    {
+        sMtask *t0 = g->tasks;
+        sDataVec *dv = t0->dv;
+        sDataVec *xs = dv->scale();
+        int ixmin = t0->ixmin;
+        int ixmax = t0->ixmax;
+
+        // The fused pass is used for real data only, complex data and
+        // the single-point case use the sMfunc methods.
+        bool fast = dv->isreal() && dv->length() > 1 && (!xs || xs->isreal());
+        bool need_mm = false, need_int = false;
+        if (fast) {
+            for (int i = 0; i < g->ntasks; i++) {
+                Mfunc ft = g->tasks[i].func->type();
+                if (ft == Mmin || ft == Mmax || ft == Mpp)
+                    need_mm = true;
+                else if (ft == Mavg || ft == Mrms)
+                    need_int = true;
+            }
+        }
+
+        const double *y = fast ? dv->realvec() : 0;
+        double mn = 0.0, mx = 0.0;
+        if (need_mm) {
+            mb_minmax(y, ixmin, ixmax, &mn, &mx);
+            double v = t0->spt.val;
+            if (v < mn)
+                mn = v;
+            if (v > mx)
+                mx = v;
+            v = t0->ept.val;
+            if (v < mn)
+                mn = v;
+            if (v > mx)
+                mx = v;
+        }
+        double avg = 0.0, rms = 0.0;
+        if (need_int && xs) {
+            const double *x = xs->realvec();
+            double s1, s2;
+            mb_integ(x, y, ixmin, ixmax, &s1, &s2);
+            s1 *= 0.5;
+            s2 *= 0.5;
+
+            double tstart = x[ixmin];
+            const sXpt &spt = t0->spt;
+            if (spt.val != y[ixmin]) {
+                double delt = x[ixmin] - spt.scval;
+                s1 += 0.5*delt*(spt.val + y[ixmin]);
+                s2 += 0.5*delt*(spt.val*spt.val + y[ixmin]*y[ixmin]);
+                tstart -= delt;
+            }
+            double tend = x[ixmax];
+            const sXpt &ept = t0->ept;
+            if (ept.val != y[ixmax]) {
+                double delt = ept.scval - x[ixmax];
+                s1 += 0.5*delt*(y[ixmax] + ept.val);
+                s2 += 0.5*delt*(y[ixmax]*y[ixmax] + ept.val*ept.val);
+                tend += delt;
+            }
+            double dt = tend - tstart;
+            if (dt != 0.0) {
+                s1 /= dt;
+                s2 /= dt;
+            }
+            avg = s1;
+            rms = sqrt(fabs(s2));
+        }
+
+        for (int i = 0; i < g->ntasks; i++) {
+            sMtask *t = g->tasks + i;
+            sMfunc *ff = t->func;
+            Mfunc ft = ff->type();
+            if (need_mm && ft == Mmin)
+                ff->set_val(mn);
+            else if (need_mm && ft == Mmax)
+                ff->set_val(mx);
+            else if (need_mm && ft == Mpp)
+                ff->set_val(mx - mn);
+            else if (need_int && ft == Mavg)
+                ff->set_val(avg);
+            else if (need_int && ft == Mrms)
+                ff->set_val(rms);
+            else
+                ff->measure(dv, ixmin, ixmax, &t->spt, &t->ept);
+        }
+    }
+
+    int mb_thread_proc(sTPthreadData*, void *arg)
+    {
+        sMgroup *g = (sMgroup*)arg;
+        double t = OP.seconds();
+        mb_eval(g);
+        g->time = OP.seconds() - t;
+        return (0);
+    }
+}
+
+
+// Container for the measurement tasks and evaluated vectors of a
+// batch.
+//
+struct sMbatch
+{
+    sMbatch()
+        {
+            mb_vecs = 0;
+            mb_tasks = 0;
+            mb_ntasks = 0;
+            mb_size = 0;
+        }
+
+    ~sMbatch()
+        {
+            delete mb_vecs;
+            delete [] mb_tasks;
+        }
+
+    sDataVec *find_vec(const char *expr)
+        {
+            return ((sDataVec*)sHtab::get(mb_vecs, expr));
+        }
+
+    void save_vec(const char *expr, sDataVec *dv)
+        {
+            if (!expr || !dv)
+                return;
+            if (!mb_vecs)
+                mb_vecs = new sHtab(false);
+            if (!sHtab::get(mb_vecs, expr))
+                mb_vecs->add(expr, dv);
+        }
+
+    void add(sRunopMeas*, sMfunc*, sDataVec*, int, int, const sXpt&,
+        const sXpt&);
+    void run();
+
+private:
+    sHtab *mb_vecs;             // evaluated expressions
+    sMtask *mb_tasks;           // queued interval measurements
+    int mb_ntasks;
+    int mb_size;
+};
+
+
+void
+sMbatch::add(sRunopMeas *m, sMfunc *ff, sDataVec *dv, int ixmin, int ixmax,
+    const sXpt &spt, const sXpt &ept)
+{
+    if (mb_ntasks >= mb_size) {
+        mb_size = mb_size ? 2*mb_size : 16;
+        sMtask *tmp = new sMtask[mb_size];
+        if (mb_ntasks)
+            memcpy(tmp, mb_tasks, mb_ntasks*sizeof(sMtask));
+        delete [] mb_tasks;
+        mb_tasks = tmp;
+    }
+    sMtask *t = mb_tasks + mb_ntasks++;
+    t->owner = m;
+    t->func = ff;
+    t->dv = dv;
+    t->ixmin = ixmin;
+    t->ixmax = ixmax;
+    t->spt = spt;
+    t->ept = ept;
+}
+
+
+// Compute the queued measurements.  The time used is credited to the
+// owning measurements.
+//
+void
+sMbatch::run()
+{
+    if (!mb_ntasks)
+        return;
+    std::sort(mb_tasks, mb_tasks + mb_ntasks, mtask_lt);
+
+    int ngrp = 0;
+    for (int i = 0; i < mb_ntasks; i++) {
+        if (!i || !mtask_same(mb_tasks[i-1], mb_tasks[i]))
+            ngrp++;
+    }
+    sMgroup *grps = new sMgroup[ngrp];
+    ngrp = 0;
+    unsigned long npts = 0;
+    for (int i = 0; i < mb_ntasks; i++) {
+        if (!i || !mtask_same(mb_tasks[i-1], mb_tasks[i])) {
+            sMgroup *g = grps + ngrp++;
+            g->tasks = mb_tasks + i;
+            g->ntasks = 0;
+            g->time = 0.0;
+            npts += mb_tasks[i].ixmax - mb_tasks[i].ixmin + 1;
+        }
+        grps[ngrp-1].ntasks++;
+    }
+
+    int nthreads = DEF_postthreads;
+    VTvalue vv;
+    if (Sp.GetVar(kw_postthreads, VTYP_NUM, &vv) &&
+            vv.get_int() >= DEF_postthreads_MIN &&
+            vv.get_int() <= DEF_postthreads_MAX)
+        nthreads = vv.get_int();
+    if (nthreads > ngrp - 1)
+        nthreads = ngrp - 1;
+
+    if (nthreads > 0 && npts >= MB_MT_MIN) {
+        cThreadPool pool(nthreads);
+        for (int i = 0; i < ngrp; i++)
+            pool.submit(mb_thread_proc, grps + i);
+        pool.run(0);
+    }
+    else {
+        for (int i = 0; i < ngrp; i++)
+            mb_thread_proc(0, grps + i);
+    }
+
+    for (int i = 0; i < ngrp; i++) {
+        sMgroup *g = grps + i;
+        double t = g->time/g->ntasks;
+        for (int j = 0; j < g->ntasks; j++)
+            g->tasks[j].owner->add_time(t);
+    }
+    delete [] grps;
+    mb_ntasks = 0;
+}
+// End of sMbatch functions.
+
+
 namespace {
     // Grab text enclosed in parentheses, return token with outer
     // parentheses stripped if notok is false.  If notok is true, don't
@@ -1905,19 +2281,107 @@ sRunopMeas::check_measure(sRunDesc *run)
 bool
 sRunopMeas::do_measure()
 {
-    if (!ro_queue_measure)
-        return (false);
-    ro_queue_measure = false;
+    sRunopMeas *m = this;
+    return (do_measures(&m, 1));
+}
 
-    sDataVec *dv;
-    int cnt;
-    if (!measure(&dv, &cnt))
-        return (false);
+
+// Perform the queued measurements in the list.  The expressions are
+// evaluated in order, then the interval measurements are computed
+// together, possibly in parallel.  Finally, the results are saved
+// and reported, in order.  A measurement whose expressions may
+// reference the result of an earlier measurement in the list starts
+// a new batch, so that the result is available.  Called with vectors
+// segmentized.  The return is false if any measurement was not
+// performed.
+//
+bool
+sRunopMeas::do_measures(sRunopMeas **list, int num)
+{
+    if (num <= 0)
+        return (true);
+    sDataVec **dvs = new sDataVec*[num];
+    int *cnts = new int[num];
+    bool *good = new bool[num];
+    bool timing = Sp.GetVar(kw_meastime, VTYP_BOOL, 0);
+    bool ret = true;
+
+    int i0 = 0;
+    while (i0 < num) {
+        int i1 = i0 + 1;
+        while (i1 < num && !list[i1]->uses_result(list + i0, i1 - i0))
+            i1++;
+
+        sMbatch batch;
+        for (int i = i0; i < i1; i++) {
+            sRunopMeas *m = list[i];
+            dvs[i] = 0;
+            cnts[i] = 0;
+            good[i] = false;
+            if (!m->ro_queue_measure)
+                continue;
+            m->ro_queue_measure = false;
+
+            double t = OP.seconds();
+            good[i] = m->measure(dvs + i, cnts + i, &batch);
+            m->ro_time = OP.seconds() - t;
+        }
+        batch.run();
+
+        for (int i = i0; i < i1; i++) {
+            if (!good[i] || !list[i]->finish_measure(dvs[i], cnts[i])) {
+                ret = false;
+                continue;
+            }
+            if (timing && !Sp.GetFlag(FT_SERVERMODE)) {
+                TTY.printf_force("%s time: %.6f sec\n",
+                    list[i]->ro_result, list[i]->ro_time);
+            }
+        }
+        i0 = i1;
+    }
+    delete [] dvs;
+    delete [] cnts;
+    delete [] good;
+    return (ret);
+}
+
+
+// Return true if an expression of this measurement contains the
+// result name of one of the measurements in the list.  This is
+// conservative, a match does not mean that the result is actually
+// referenced.
+//
+bool
+sRunopMeas::uses_result(sRunopMeas **list, int num)
+{
+    for (int i = 0; i < num; i++) {
+        const char *res = list[i]->ro_result;
+        if (!res || !*res)
+            continue;
+        for (sMfunc *ff = ro_funcs; ff; ff = ff->next()) {
+            if (ff->expr() && lstring::cisubstring(res, ff->expr()))
+                return (true);
+        }
+        for (sMfunc *ff = ro_finds; ff; ff = ff->next()) {
+            if (ff->expr() && lstring::cisubstring(res, ff->expr()))
+                return (true);
+        }
+    }
+    return (false);
+}
+
+
+// Save and report the results, call after the computation is
+// complete.
+//
+bool
+sRunopMeas::finish_measure(sDataVec *dv, int cnt)
+{
     if (!update_plot(dv, cnt))
         return (false);
     ro_measure_done = true;
 
-
     if (ro_print_flag && !Sp.GetFlag(FT_SERVERMODE)) {
         char *s = print_meas();
         TTY.printf_force("%s", s);
@@ -1938,10 +2402,12 @@ sRunopMeas::do_measure()
 
 
 // Do the measurement, call after successfully identifying the
-// measure interval.
+// measure interval.  If a batch is given, the interval measurements
+// are queued there rather than computed, and evaluated expressions
+// are shared among the measurements in the batch.
 //
 bool
-sRunopMeas::measure(sDataVec **dvp, int *cntp)
+sRunopMeas::measure(sDataVec **dvp, int *cntp, sMbatch *batch)
 {
     if (dvp)
         *dvp = 0;
@@ -1953,7 +2419,7 @@ sRunopMeas::measure(sDataVec **dvp, int *cntp)
     int count = 0;
     if (ro_start.ready() && ro_end.ready()) {
         for (sMfunc *ff = ro_funcs; ff; ff = ff->next(), count++) {
-            sDataVec *dv = evaluate(ff->expr());
+            sDataVec *dv = evaluate(ff->expr(), batch);
 
             if (dv && ((dv->length() > ro_start.indx() &&
                     dv->length() > ro_end.indx()) || dv->length() == 1)) {
@@ -1961,20 +2427,12 @@ sRunopMeas::measure(sDataVec **dvp, int *cntp)
                     dv0 = dv;
                 sXpt spt = startpoint(dv);
                 sXpt ept = endpoint(dv);
-                if (ff->type() == Mmin)
-                    ff->mmin(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mmax)
-                    ff->mmax(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mpp)
-                    ff->mpp(dv,  ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mavg)
-                    ff->mavg(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mrms)
-                    ff->mrms(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mpw)
-                    ff->mpw(dv,  ro_start.indx(), ro_end.indx(), &spt, &ept);
-                else if (ff->type() == Mrft)
-                    ff->mrft(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
+                if (batch) {
+                    batch->add(this, ff, dv, ro_start.indx(), ro_end.indx(),
+                        spt, ept);
+                }
+                else
+                    ff->measure(dv, ro_start.indx(), ro_end.indx(), &spt, &ept);
             }
             else {
                 ff->set_error(true);
@@ -1982,7 +2440,7 @@ sRunopMeas::measure(sDataVec **dvp, int *cntp)
             }
         }
         for (sMfunc *ff = ro_finds; ff; ff = ff->next(), count++) {
-            sDataVec *dv = evaluate(ff->expr());
+            sDataVec *dv = evaluate(ff->expr(), batch);
             if (dv) {
                 ff->set_val(endval(dv) - startval(dv));
                 if (!dv0)
@@ -1996,7 +2454,7 @@ sRunopMeas::measure(sDataVec **dvp, int *cntp)
     }
     else if (ro_start.ready()) {
         for (sMfunc *ff = ro_finds; ff; ff = ff->next(), count++) {
-            sDataVec *dv = evaluate(ff->expr());
+            sDataVec *dv = evaluate(ff->expr(), batch);
             if (dv) {
                 ff->set_val(startval(dv));
                 if (!dv0)
@@ -2303,10 +2761,15 @@ sRunopMeas::addMeas(Mfunc mtype, const char *expr, double v1, double v2)
 // evaluation.
 //
 sDataVec *
-sRunopMeas::evaluate(const char *str)
+sRunopMeas::evaluate(const char *str, sMbatch *batch)
 {
     if (!str)
         return (0);
+    if (batch) {
+        sDataVec *dv = batch->find_vec(str);
+        if (dv)
+            return (dv);
+    }
     const char *s = str;
     pnode *pn = Sp.GetPnode(&s, true);
     if (!pn)
@@ -2315,6 +2778,8 @@ sRunopMeas::evaluate(const char *str)
     delete pn;
     if (dv && !dv->scale())
         dv->set_scale(ro_cktptr->runplot()->scale());
+    if (batch)
+        batch->save_vec(str, dv);
     return (dv);
 }
 
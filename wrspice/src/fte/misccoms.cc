@@ -468,8 +468,16 @@ CommandTab::com_cache(wordlist *wl)
 //
 // mmom start [depth]
 // mmon stop [filename]
+// mmon sample [interval]
+// mmon profile [filename] [pprof]
+// mmon threads [filename]
 // mmon [status | check]
 //
+// The "sample" directive starts the sampling heap profiler, which has
+// low overhead and aggregates live memory by call site.  The profile
+// is dumped by "profile" (or "stop"), or when the process receives
+// SIGUSR2.
+//
 void
 CommandTab::com_mmon(wordlist *wl)
 {
@@ -493,8 +501,55 @@ CommandTab::com_mmon(wordlist *wl)
                 "Memory monitor started.\n");
             return;
         }
+        if (lstring::cieq(wl->wl_word, "sample")) {
+            size_t intvl = 0;
+            if (wl->wl_next)
+                intvl = strtoul(wl->wl_next->wl_word, 0, 10);
+            if (!Memory()->mon_prof_start(intvl)) {
+                TTY.printf(
+                    "Error: profiler failed to start, monitor active?\n");
+                return;
+            }
+            TTY.printf(
+                "Sampling heap profiler started.\n");
+            return;
+        }
+        if (lstring::cieq(wl->wl_word, "profile")) {
+            OP.vecGc();
+            const char *fname = "mon_prof.out";
+            bool pprof = false;
+            if (wl->wl_next) {
+                fname = wl->wl_next->wl_word;
+                if (wl->wl_next->wl_next)
+                    pprof = lstring::cieq(wl->wl_next->wl_next->wl_word,
+                        "pprof");
+            }
+            if (!Memory()->mon_prof_dump(fname, pprof)) {
+                TTY.printf(
+                    "Error: profile dump failed, profiler never started?\n");
+                return;
+            }
+            TTY.printf(
+                "Heap profile in file \"%s\".\n", fname);
+            return;
+        }
         if (lstring::cieq(wl->wl_word, "stop")) {
             OP.vecGc();
+            if (Memory()->mon_prof_active()) {
+                const char *fname = "mon_prof.out";
+                if (wl->wl_next)
+                    fname = wl->wl_next->wl_word;
+                Memory()->mon_prof_stop();
+                if (!Memory()->mon_prof_dump(fname, false)) {
+                    TTY.printf(
+                        "Error: profile dump to file failed.\n");
+                    return;
+                }
+                TTY.printf(
+                    "Sampling profiler stopped, data in file \"%s\".\n",
+                    fname);
+                return;
+            }
             const char *fname = "mon.out";
             if (wl->wl_next)
                 fname = wl->wl_next->wl_word;
@@ -512,11 +567,36 @@ CommandTab::com_mmon(wordlist *wl)
                 "Memory monitor stopped, data in file \"%s\".\n", fname);
             return;
         }
+        if (lstring::cieq(wl->wl_word, "threads")) {
+            const char *fname = "mon_threads.out";
+            if (wl->wl_next)
+                fname = wl->wl_next->wl_word;
+            if (!Memory()->tcache_active()) {
+                TTY.printf(
+                    "Thread cache is not in use.\n");
+                return;
+            }
+            if (!Memory()->mon_thread_dump(fname)) {
+                TTY.printf(
+                    "Error: thread statistics dump to file failed.\n");
+                return;
+            }
+            TTY.printf(
+                "Thread statistics for %d records in file \"%s\".\n",
+                Memory()->mon_thread_count(), fname);
+            return;
+        }
         if (!lstring::cieq(wl->wl_word, "status") &&
                 !lstring::cieq(wl->wl_word, "check")) {
             return;
         }
     }
+    if (Memory()->mon_prof_active()) {
+        TTY.printf(
+            "Sampling profiler estimates %lu live bytes.\n",
+            (unsigned long)Memory()->mon_prof_live());
+        return;
+    }
     TTY.printf(
         "Allocation table contains %d entries.\n", Memory()->mon_count());
 #else
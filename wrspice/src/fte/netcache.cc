@@ -0,0 +1,340 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * WRspice Circuit Simulation and Analysis Tool                           *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "config.h"
+#include "simulator.h"
+#include "kwords_fte.h"
+#include "kwords_analysis.h"
+#include "inpline.h"
+#include "subexpand.h"
+#include "miscutil/lstring.h"
+#include "miscutil/pathlist.h"
+#include "miscutil/filestat.h"
+#include "miscutil/encode.h"
+#include <stdint.h>
+#include <unistd.h>
+
+
+//
+// Disk cache of expanded circuit decks.
+//
+// Subcircuit expansion and parameter substitution of a large deck
+// can take much longer than reading it.  When the netcachedir
+// variable names a directory, the flattened deck produced by
+// subcircuit expansion is saved there in a binary file, and a later
+// source of an identical deck reads it back instead of expanding.
+//
+// The file name is an MD5 digest of the deck text, which at this
+// point has all .include/.lib files read in, and of the variables
+// that control expansion.  A change to any input file or to these
+// variables gives a different name, so stale files are never used.
+//
+// The expansion can also depend on things that are not in the text. 
+// Decks with a .exec block, which can set vectors and functions used
+// in parameters, are not cached.  An expansion that evaluated a
+// random function or a vector other than a constant is not saved.
+//
+
+namespace {
+    // File format version, bump when the format changes.
+    const uint32_t NC_VERSION = 1;
+
+    // Byte order mark, files written on a different architecture
+    // are ignored.
+    const uint32_t NC_BOM = 0x01020304;
+
+    const char NC_MAGIC[8] = { 'W', 'R', 'N', 'C', 'A', 'C', 'H', 'E' };
+
+    void nc_update(MD5cx &cx, const char *str)
+    {
+        if (str)
+            cx.update((const unsigned char*)str, strlen(str) + 1);
+        else
+            cx.update((const unsigned char*)"", 1);
+    }
+
+    void nc_update(MD5cx &cx, int i)
+    {
+        char tbf[32];
+        snprintf(tbf, sizeof(tbf), "%d", i);
+        nc_update(cx, tbf);
+    }
+
+    void nc_update(MD5cx &cx, sLine *l)
+    {
+        for ( ; l; l = l->next()) {
+            nc_update(cx, l->line_num());
+            nc_update(cx, l->line());
+            if (l->actual()) {
+                nc_update(cx, "{");
+                nc_update(cx, l->actual());
+                nc_update(cx, "}");
+            }
+        }
+    }
+
+
+    bool nc_write_u32(FILE *fp, uint32_t u)
+    {
+        return (fwrite(&u, sizeof(uint32_t), 1, fp) == 1);
+    }
+
+    bool nc_write_lines(FILE *fp, sLine *l0)
+    {
+        uint32_t cnt = 0;
+        for (sLine *l = l0; l; l = l->next())
+            cnt++;
+        if (!nc_write_u32(fp, cnt))
+            return (false);
+        for (sLine *l = l0; l; l = l->next()) {
+            const char *s = l->line() ? l->line() : "";
+            uint32_t len = strlen(s);
+            if (!nc_write_u32(fp, (uint32_t)l->line_num()))
+                return (false);
+            if (!nc_write_u32(fp, len))
+                return (false);
+            if (len && fwrite(s, 1, len, fp) != len)
+                return (false);
+            if (!nc_write_lines(fp, l->actual()))
+                return (false);
+        }
+        return (true);
+    }
+
+
+    // Reader for the file image, all access is bounds-checked.
+    //
+    struct nc_rdr
+    {
+        nc_rdr(const char *b, size_t sz) : buf(b), end(b + sz) { }
+
+        bool read_u32(uint32_t *u)
+            {
+                if (end - buf < (long)sizeof(uint32_t))
+                    return (false);
+                memcpy(u, buf, sizeof(uint32_t));
+                buf += sizeof(uint32_t);
+                return (true);
+            }
+
+        bool read_lines(sLine **lp);
+
+    private:
+        const char *buf;
+        const char *end;
+    };
+
+
+    bool
+    nc_rdr::read_lines(sLine **lp)
+    {
+        *lp = 0;
+        uint32_t cnt;
+        if (!read_u32(&cnt))
+            return (false);
+        sLine *l0 = 0, *le = 0;
+        for (uint32_t i = 0; i < cnt; i++) {
+            uint32_t lnum, len;
+            if (!read_u32(&lnum) || !read_u32(&len) ||
+                    (uint32_t)(end - buf) < len) {
+                sLine::destroy(l0);
+                return (false);
+            }
+            sLine *l = new sLine;
+            char *s = new char[len + 1];
+            memcpy(s, buf, len);
+            s[len] = 0;
+            buf += len;
+            l->set_line(s);
+            delete [] s;
+            l->set_line_num((int)lnum);
+            if (!l0)
+                l0 = le = l;
+            else {
+                le->set_next(l);
+                le = l;
+            }
+            sLine *a;
+            if (!read_lines(&a)) {
+                sLine::destroy(l0);
+                return (false);
+            }
+            l->set_actual(a);
+        }
+        *lp = l0;
+        return (true);
+    }
+}
+
+
+// Return the full path to the cache file for the deck of circ, which
+// should not include the title line, or null if the cache is not
+// enabled or the deck can't be cached.  Must be called after SPcx is
+// initialized.
+//
+char *
+sNetCache::path(sLine *deck, sFtCirc *circ)
+{
+    VTvalue vv;
+    if (!Sp.GetVar(kw_netcachedir, VTYP_STRING, &vv))
+        return (0);
+    const char *dir = vv.get_string();
+    if (!dir || !*dir)
+        return (0);
+
+    // A deck containing a .cache block updates the subcircuit cache
+    // of the session, which is state not reflected in the file.
+    // Lines with errors are reported during expansion.
+    if (circ && circ->execBlk().text())
+        return (0);
+    for (sLine *l = deck; l; l = l->next()) {
+        if (lstring::cimatch(CACHE_KW, l->line()) || l->error())
+            return (0);
+    }
+
+    char *xdir = pathlist::expand_path(dir, false, true);
+    if (!filestat::is_directory(xdir)) {
+        delete [] xdir;
+        return (0);
+    }
+
+    MD5cx context;
+    nc_update(context, Sp.Version());
+    nc_update(context, (int)NC_VERSION);
+    nc_update(context, SPcx.pexnodes());
+    nc_update(context, SPcx.nobjthack());
+    nc_update(context, SPcx.catchar());
+    nc_update(context, SPcx.catmode());
+    nc_update(context, SPcx.parhier());
+    nc_update(context, SPcx.start());
+    nc_update(context, SPcx.sbend());
+    nc_update(context, SPcx.invoke());
+    nc_update(context, SPcx.model());
+    if (Sp.GetVar(spkw_submaps, VTYP_STRING, &vv, circ))
+        nc_update(context, vv.get_string());
+    else
+        nc_update(context, (const char*)0);
+    nc_update(context, deck);
+
+    unsigned char digest[16];
+    context.final(digest);
+    char tbf[40];
+    for (int i = 0; i < 16; i++)
+        snprintf(tbf + 2*i, 3, "%02x", digest[i]);
+    strcpy(tbf + 32, ".wnc");
+
+    char *path = pathlist::mk_path(xdir, tbf);
+    delete [] xdir;
+    return (path);
+}
+
+
+// Read and return the expanded deck saved in the file, or null if
+// the file does not exist or is not valid.
+//
+sLine *
+sNetCache::read(const char *path)
+{
+    if (!path)
+        return (0);
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return (0);
+    if (fseek(fp, 0, SEEK_END) < 0) {
+        fclose(fp);
+        return (0);
+    }
+    long sz = ftell(fp);
+    rewind(fp);
+    if (sz < (long)(sizeof(NC_MAGIC) + 2*sizeof(uint32_t))) {
+        fclose(fp);
+        return (0);
+    }
+    char *buf = new char[sz];
+    bool ok = (fread(buf, 1, sz, fp) == (size_t)sz);
+    fclose(fp);
+
+    sLine *deck = 0;
+    if (ok && !memcmp(buf, NC_MAGIC, sizeof(NC_MAGIC))) {
+        nc_rdr rdr(buf + sizeof(NC_MAGIC), sz - sizeof(NC_MAGIC));
+        uint32_t vers, bom;
+        if (rdr.read_u32(&vers) && vers == NC_VERSION &&
+                rdr.read_u32(&bom) && bom == NC_BOM)
+            rdr.read_lines(&deck);
+    }
+    delete [] buf;
+    return (deck);
+}
+
+
+// Save the expanded deck in the file.  The file is written under a
+// temporary name and renamed, so that a partial file is never read. 
+// Return true if the file was written.
+//
+bool
+sNetCache::write(const char *path, sLine *deck)
+{
+    if (!path || !deck)
+        return (false);
+    char *tpath = new char[strlen(path) + 16];
+    snprintf(tpath, strlen(path) + 16, "%s.%d", path, (int)getpid());
+    FILE *fp = fopen(tpath, "wb");
+    if (!fp) {
+        delete [] tpath;
+        return (false);
+    }
+    bool ok = (fwrite(NC_MAGIC, 1, sizeof(NC_MAGIC), fp) == sizeof(NC_MAGIC));
+    ok = ok && nc_write_u32(fp, NC_VERSION);
+    ok = ok && nc_write_u32(fp, NC_BOM);
+    ok = ok && nc_write_lines(fp, deck);
+    if (fclose(fp) != 0)
+        ok = false;
+    if (ok) {
+#ifdef WIN32
+        unlink(path);
+#endif
+        ok = (rename(tpath, path) == 0);
+    }
+    if (!ok)
+        unlink(tpath);
+    delete [] tpath;
+    return (ok);
+}
+
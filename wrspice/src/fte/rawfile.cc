@@ -54,6 +54,10 @@ Authors: 1986 Wayne A. Christopher
 #include "errors.h"
 #include "spnumber/hash.h"
 #include "ginterf/graphics.h"
+#include "circuit.h"
+#ifdef WITH_THREADS
+#include <pthread.h>
+#endif
 
 
 //
@@ -62,9 +66,318 @@ Authors: 1986 Wayne A. Christopher
 
 #define DEFPREC 15
 
+namespace {
+    // Per-vector codes in a point snapshot.
+    enum { RP_SKIP, RP_PAD, RP_REAL, RP_CPLX };
+
+    // Write one point from a snapshot, the format is the same as
+    // cRawOut::file_points.
+    //
+    void
+    write_point(FILE *fp, bool binary, bool realflag, bool pad, int prec,
+        int indx, int nv, const double *vals, const char *codes)
+    {
+        if (binary) {
+            double zz[2] = { 0.0, 0.0 };
+            for (int i = 0; i < nv; i++) {
+                const double *d = vals + 2*i;
+                switch (codes[i]) {
+                case RP_PAD:
+                    if (pad)
+                        fwrite((char*)zz, sizeof(double), realflag ? 1 : 2,
+                            fp);
+                    break;
+                case RP_REAL:
+                    fwrite((char*)d, sizeof(double), 1, fp);
+                    if (!realflag)
+                        fwrite((char*)zz, sizeof(double), 1, fp);
+                    break;
+                case RP_CPLX:
+                    fwrite((char*)d, sizeof(double), realflag ? 1 : 2, fp);
+                    break;
+                }
+            }
+            return;
+        }
+        fprintf(fp, " %d", indx);
+        for (int i = 0; i < nv; i++) {
+            const double *d = vals + 2*i;
+            switch (codes[i]) {
+            case RP_PAD:
+                if (!pad)
+                    break;
+                if (realflag)
+                    fprintf(fp, "\t%.*e\n", prec, 0.0);
+                else
+                    fprintf(fp, "\t%.*e,%.*e\n", prec, 0.0, prec, 0.0);
+                break;
+            case RP_REAL:
+                if (realflag)
+                    fprintf(fp, "\t%.*e\n", prec, d[0]);
+                else
+                    fprintf(fp, "\t%.*e,0.0\n", prec, d[0]);
+                break;
+            case RP_CPLX:
+                if (realflag)
+                    fprintf(fp, "\t%.*e\n", prec, d[0]);
+                else
+                    fprintf(fp, "\t%.*e,%.*e\n", prec, d[0], prec, d[1]);
+                break;
+            }
+        }
+    }
+}
+
+
+// When a rawfile is written while the analysis runs, the formatting
+// and writing of each point is passed to a writer thread through a
+// bounded ring of value snapshots.  The analysis thread only copies
+// the values and goes on to the next time point.  The ring indices
+// are lock-free, each side blocks on the condition variable only when
+// the ring is full or empty.  Points are written in order, and
+// everything queued is written before the point count is updated or
+// the file is closed.  All other output processing (vector updates,
+// measurements and stop conditions) remains on the analysis thread.
+//
+struct sRawPipe
+{
+    sRawPipe(int nv, int ns)
+        {
+            rp_thread = 0;
+            rp_vals = new double[2*nv*ns];
+            rp_codes = new char[nv*ns];
+            rp_indx = new int[ns];
+            rp_nvecs = nv;
+            rp_nslots = ns;
+            rp_head = 0;
+            rp_tail = 0;
+            rp_pwait = false;
+            rp_cwait = false;
+            rp_done = false;
+            rp_fp = 0;
+            rp_prec = 0;
+            rp_binary = false;
+            rp_realflag = false;
+            rp_pad = false;
+#ifdef WITH_THREADS
+            pthread_mutex_init(&rp_mtx, 0);
+            pthread_cond_init(&rp_cnd, 0);
+#endif
+        }
+
+    ~sRawPipe()
+        {
+            stop();
+#ifdef WITH_THREADS
+            pthread_mutex_destroy(&rp_mtx);
+            pthread_cond_destroy(&rp_cnd);
+#endif
+            delete [] rp_vals;
+            delete [] rp_codes;
+            delete [] rp_indx;
+        }
+
+    bool start();
+    void stop();
+    void push(int);
+    void drain();
+
+    double *slot_vals(unsigned int n)
+        {
+            return (rp_vals + 2*rp_nvecs*(n % rp_nslots));
+        }
+
+    char *slot_codes(unsigned int n)
+        {
+            return (rp_codes + rp_nvecs*(n % rp_nslots));
+        }
+
+    // Next slot to fill, valid until push is called.
+    double *cur_vals()      { return (slot_vals(rp_head)); }
+    char *cur_codes()       { return (slot_codes(rp_head)); }
+
+    int nvecs()             { return (rp_nvecs); }
+
+    void set_format(FILE *fp, int prec, bool bin, bool rflg, bool pad)
+        {
+            rp_fp = fp;
+            rp_prec = prec;
+            rp_binary = bin;
+            rp_realflag = rflg;
+            rp_pad = pad;
+        }
+
+private:
+    void wait_for(bool*);
+    void wake(bool*);
+    static void *thread_proc(void*);
+
+#ifdef WITH_THREADS
+    pthread_t rp_thr;
+    pthread_mutex_t rp_mtx;
+    pthread_cond_t rp_cnd;
+#endif
+    void *rp_thread;        // nonzero when writer thread is running
+    double *rp_vals;        // nslots*nvecs real/imag pairs
+    char *rp_codes;         // nslots*nvecs vector codes
+    int *rp_indx;           // point index of each slot
+    int rp_nvecs;
+    unsigned int rp_nslots;
+    unsigned int rp_head;   // advanced by analysis thread only
+    unsigned int rp_tail;   // advanced by writer thread only
+    bool rp_pwait;          // analysis thread is waiting
+    bool rp_cwait;          // writer thread is waiting
+    bool rp_done;           // writer thread should exit when empty
+
+    FILE *rp_fp;
+    int rp_prec;
+    bool rp_binary;
+    bool rp_realflag;
+    bool rp_pad;
+};
+
+
+bool
+sRawPipe::start()
+{
+#ifdef WITH_THREADS
+    if (rp_thread)
+        return (true);
+    rp_done = false;
+    if (pthread_create(&rp_thr, 0, thread_proc, this) != 0)
+        return (false);
+    rp_thread = this;
+    return (true);
+#else
+    return (false);
+#endif
+}
+
+
+// Write out everything queued and terminate the writer thread.
+//
+void
+sRawPipe::stop()
+{
+#ifdef WITH_THREADS
+    if (!rp_thread)
+        return;
+    __atomic_store_n(&rp_done, true, __ATOMIC_SEQ_CST);
+    wake(&rp_cwait);
+    pthread_join(rp_thr, 0);
+    rp_thread = 0;
+#endif
+}
+
+
+// Queue the current slot, which has been filled by the caller.  If
+// there is no writer thread the point is written here.
+//
+void
+sRawPipe::push(int indx)
+{
+    rp_indx[rp_head % rp_nslots] = indx;
+    if (!rp_thread) {
+        write_point(rp_fp, rp_binary, rp_realflag, rp_pad, rp_prec, indx,
+            rp_nvecs, cur_vals(), cur_codes());
+        return;
+    }
+    __atomic_store_n(&rp_head, rp_head + 1, __ATOMIC_SEQ_CST);
+    wake(&rp_cwait);
+
+    // Block while the ring is full, so that the next slot is free
+    // for the caller.
+    while (rp_head - __atomic_load_n(&rp_tail, __ATOMIC_SEQ_CST) >=
+            rp_nslots)
+        wait_for(&rp_pwait);
+}
+
+
+// Return when all queued points have been written.
+//
+void
+sRawPipe::drain()
+{
+    if (!rp_thread)
+        return;
+    while (__atomic_load_n(&rp_tail, __ATOMIC_SEQ_CST) != rp_head)
+        wait_for(&rp_pwait);
+}
+
+
+// Block until woken by the other thread.  The flag is set under the
+// lock, the other side tests the flag after updating the index, so a
+// wakeup can't be lost.  Callers re-test their condition on return.
+//
+void
+sRawPipe::wait_for(bool *flag)
+{
+#ifdef WITH_THREADS
+    pthread_mutex_lock(&rp_mtx);
+    __atomic_store_n(flag, true, __ATOMIC_SEQ_CST);
+    bool sleep;
+    if (flag == &rp_cwait) {
+        sleep = __atomic_load_n(&rp_head, __ATOMIC_SEQ_CST) == rp_tail &&
+            !__atomic_load_n(&rp_done, __ATOMIC_SEQ_CST);
+    }
+    else
+        sleep = __atomic_load_n(&rp_tail, __ATOMIC_SEQ_CST) != rp_head;
+    if (sleep)
+        pthread_cond_wait(&rp_cnd, &rp_mtx);
+    __atomic_store_n(flag, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&rp_mtx);
+#else
+    (void)flag;
+#endif
+}
+
+
+void
+sRawPipe::wake(bool *flag)
+{
+#ifdef WITH_THREADS
+    if (__atomic_load_n(flag, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&rp_mtx);
+        pthread_cond_broadcast(&rp_cnd);
+        pthread_mutex_unlock(&rp_mtx);
+    }
+#else
+    (void)flag;
+#endif
+}
+
+
+void *
+sRawPipe::thread_proc(void *arg)
+{
+    sRawPipe *rp = (sRawPipe*)arg;
+    for (;;) {
+        unsigned int head = __atomic_load_n(&rp->rp_head, __ATOMIC_SEQ_CST);
+        if (rp->rp_tail == head) {
+            if (__atomic_load_n(&rp->rp_done, __ATOMIC_SEQ_CST) &&
+                    __atomic_load_n(&rp->rp_head, __ATOMIC_SEQ_CST) == head)
+                break;
+            rp->wait_for(&rp->rp_cwait);
+            continue;
+        }
+        while (rp->rp_tail != head) {
+            unsigned int n = rp->rp_tail;
+            write_point(rp->rp_fp, rp->rp_binary, rp->rp_realflag,
+                rp->rp_pad, rp->rp_prec, rp->rp_indx[n % rp->rp_nslots],
+                rp->rp_nvecs, rp->slot_vals(n), rp->slot_codes(n));
+            __atomic_store_n(&rp->rp_tail, n + 1, __ATOMIC_SEQ_CST);
+            rp->wake(&rp->rp_pwait);
+        }
+    }
+    return (0);
+}
+// End of sRawPipe functions.
+
+
 cRawOut::cRawOut(sPlot *pl)
 {
     ro_plot = pl;
+    ro_pipe = 0;
     ro_fp = 0;
     ro_pointPosn = 0;
     ro_prec = 0;
@@ -314,6 +627,10 @@ cRawOut::file_points(int indx)
     if (ro_length == 0)
         // true when called from output routine the first time
         ro_length = 1;
+    if (indx >= 0 && ro_length == 1) {
+        stream_point(indx);
+        return (true);
+    }
     if (ro_binary) {
         for (int i = 0; i < ro_length; i++) {
             for (sDvList *dl = ro_dlist; dl; dl = dl->dl_next) {
@@ -385,11 +702,80 @@ cRawOut::file_points(int indx)
 }
 
 
+// Output a point while the analysis is running.  The values are
+// copied, and the point is written by the writer thread if possible.
+//
+void
+cRawOut::stream_point(int indx)
+{
+    if (!ro_pipe) {
+        int nv = 0;
+        for (sDvList *dl = ro_dlist; dl; dl = dl->dl_next)
+            nv++;
+        if (!nv)
+            nv = 1;
+
+        // Keep the ring around 4Mb.
+        int ns = (4*1024*1024)/(nv*(2*sizeof(double) + 1));
+        if (ns > 256)
+            ns = 256;
+        else if (ns < 4)
+            ns = 4;
+        ro_pipe = new sRawPipe(nv, ns);
+        ro_pipe->set_format(ro_fp, ro_prec, ro_binary, ro_realflag,
+            ro_pad);
+
+        // Output to the standard output would be mixed with other
+        // messages, write directly in that case.
+        if (ro_fp && ro_fp != stdout && !isatty(fileno(ro_fp)) &&
+                !Sp.GetFlag(FT_SERVERMODE))
+            ro_pipe->start();
+    }
+    double *d = ro_pipe->cur_vals();
+    char *c = ro_pipe->cur_codes();
+    int i = 0;
+    for (sDvList *dl = ro_dlist; dl; dl = dl->dl_next, i++) {
+        sDataVec *v = dl->dl_dvec;
+        if (!v)
+            c[i] = RP_SKIP;
+        else if (v->length() < 1)
+            c[i] = RP_PAD;
+        else if (v->isreal()) {
+            c[i] = RP_REAL;
+            d[2*i] = v->realval(0);
+        }
+        else {
+            c[i] = RP_CPLX;
+            d[2*i] = v->realval(0);
+            d[2*i + 1] = v->imagval(0);
+        }
+    }
+    for ( ; i < ro_pipe->nvecs(); i++)
+        c[i] = RP_SKIP;
+    ro_pipe->push(indx);
+}
+
+
+// Wait until all queued points have been written, and flush the
+// file.
+//
+void
+cRawOut::file_flush()
+{
+    if (ro_pipe)
+        ro_pipe->drain();
+    if (ro_fp)
+        fflush(ro_fp);
+}
+
+
 // Fill in the point count field.
 //
 bool
 cRawOut::file_update_pcnt(int pointCount)
 {
+    if (ro_pipe)
+        ro_pipe->drain();
     if (!ro_fp || ro_fp == stdout)
         return (true);
     fflush(ro_fp);
@@ -407,6 +793,8 @@ cRawOut::file_update_pcnt(int pointCount)
 bool
 cRawOut::file_close()
 {
+    delete ro_pipe;
+    ro_pipe = 0;
     sDvList::destroy(ro_dlist);
     ro_dlist = 0;
     if (ro_fp && ro_fp != stdout && !ro_no_close)
@@ -55,7 +55,9 @@ Authors: 1988 Wayne A. Christopher
 #include "runop.h"
 #include "output.h"
 #include "device.h"
+#include "kwords_fte.h"
 #include "rundesc.h"
+#include "vecspill.h"
 #include "toolbar.h"
 #include "noisdefs.h"
 #include "tfdefs.h"
@@ -197,7 +199,8 @@ sRunDesc::plotInit(double tstart, double tstop, double tstep, sPlot *plot)
                 v->set_flags(VF_COMPLEX);
             else
                 v->set_flags(0);
-            v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
+            if (!v->alloc_spill(!rd_isComplex, rd_numPoints*rd_cycles))
+                v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
             v->newperm();
             dd->set_vec(v);
         }
@@ -231,7 +234,8 @@ sRunDesc::plotInit(double tstart, double tstop, double tstep, sPlot *plot)
                 v->set_flags(VF_COMPLEX);
             else
                 v->set_flags(0);
-            v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
+            if (!v->alloc_spill(!rd_isComplex, rd_numPoints*rd_cycles))
+                v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
             v->newperm();
             dd->set_vec(v);
         }
@@ -258,7 +262,8 @@ sRunDesc::plotInit(double tstart, double tstop, double tstep, sPlot *plot)
                 v->set_flags(VF_COMPLEX);
             else
                 v->set_flags(0);
-            v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
+            if (!v->alloc_spill(!rd_isComplex, rd_numPoints*rd_cycles))
+                v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
             v->newperm();
             dd->set_vec(v);
         }
@@ -297,7 +302,8 @@ sRunDesc::plotInit(double tstart, double tstop, double tstep, sPlot *plot)
                 v->set_flags(v->flags() | VF_POLE);
             else if (lstring::ciprefix("zero(", v->name()))
                 v->set_flags(v->flags() | VF_ZERO);
-            v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
+            if (!v->alloc_spill(!rd_isComplex, rd_numPoints*rd_cycles))
+                v->alloc(!rd_isComplex, rd_numPoints*rd_cycles);
             v->newperm();
             dd->set_vec(v);
         }
@@ -346,6 +352,10 @@ sRunDesc::addPointToPlot(IFvalue *refValue, IFvalue *valuePtr, bool inc)
     }
     if (rd_segfilebase && inc && refValue->rValue > rd_seglimit)
         dumpSegment();
+    if (VecSpill.enabled()) {
+        VecSpill.written(
+            rd_numData * sizeof(double) * (rd_isComplex ? 2 : 1));
+    }
 }
 
 
@@ -483,6 +493,21 @@ sRunDesc::datasize()
     if (Sp.GetVar("maxdata", VTYP_REAL, &vv, rd_circ))
         maxdata = vv.get_real();
 
+    // If spilldata is set and the data would exceed the given
+    // resident size, the vectors are allocated in mapped files and
+    // the maxdata limit does not apply.
+    double spill = 0.0;
+    if (Sp.GetVar(kw_spilldata, VTYP_REAL, &vv, rd_circ))
+        spill = vv.get_real();
+    else if (Sp.GetVar(kw_spilldata, VTYP_BOOL, 0, rd_circ))
+        spill = DEF_spillData;
+    if (spill > 0.0 && mysize > spill) {
+        VecSpill.set_budget(spill);
+        rd_maxPts = 0;
+        return (false);
+    }
+    VecSpill.set_budget(0.0);
+
     if (mysize > maxdata) {
         GRpkg::self()->ErrPrintf(ET_ERROR,
             "analysis would use %.1fKB which exceeds the maximum %gKB.\n"
@@ -718,8 +743,11 @@ dataDesc::addComplexValue(IFcomplex value, bool inc)
     if (!inc)
         dd_vec->set_length(0);
     else if (dd_vec->length() == 0 && !(dd_vec->flags() & VF_COMPLEX)) {
-        delete [] dd_vec->realvec();
-        dd_vec->alloc(false, dd_vec->allocated());
+        int sz = dd_vec->allocated();
+        dd_vec->free_data();
+        dd_vec->set_flags(dd_vec->flags() | VF_COMPLEX);
+        if (!dd_vec->alloc_spill(false, sz))
+            dd_vec->alloc(false, sz);
         dd_vec->set_flags(dd_vec->flags() | VF_COMPLEX);
     }
     pushComplexValue(value, dd_vec->length());
@@ -686,6 +686,34 @@ IFoutput::deleteRunop(int which, bool inactive, int num)
 }
 
 
+namespace {
+    // Perform the queued measurements for the run analysis.  The
+    // return is false if any were not performed.
+    //
+    bool do_measures(sRunDesc *run, sRunopMeas *m1, sRunopMeas *m2)
+    {
+        int cnt = 0;
+        ROgen<sRunopMeas> mgen(m1, m2);
+        for (sRunopMeas *d = mgen.next(); d; d = mgen.next()) {
+            if (run->anType() == d->analysis())
+                cnt++;
+        }
+        if (!cnt)
+            return (true);
+        sRunopMeas **list = new sRunopMeas*[cnt];
+        cnt = 0;
+        mgen = ROgen<sRunopMeas>(m1, m2);
+        for (sRunopMeas *d = mgen.next(); d; d = mgen.next()) {
+            if (run->anType() == d->analysis())
+                list[cnt++] = d;
+        }
+        bool ret = sRunopMeas::do_measures(list, cnt);
+        delete [] list;
+        return (ret);
+    }
+}
+
+
 // Run runops, measures, and margin analysis tests.
 //
 void
@@ -721,14 +749,9 @@ IFoutput::checkRunops(sRunDesc *run, double ref)
 
         if (measure_queued) {
             run->segmentizeVecs();
-            mgen = ROgen<sRunopMeas>(o_runops->measures(),
-                db ? db->measures() : 0);
-            for (sRunopMeas *d = mgen.next(); d; d = mgen.next()) {
-                if (run->anType() != d->analysis())
-                    continue;
-                if (!d->do_measure())
-                    measures_done = false;
-            }
+            if (!do_measures(run, o_runops->measures(),
+                    db ? db->measures() : 0))
+                measures_done = false;
             run->unsegmentizeVecs();
         }
         if (measures_done) {
@@ -850,14 +873,9 @@ IFoutput::checkRunops(sRunDesc *run, double ref)
 
             if (measure_queued) {
                 run->segmentizeVecs();
-                mgen = ROgen<sRunopMeas>(o_runops->measures(),
-                    db ? db->measures() : 0);
-                for (sRunopMeas *d = mgen.next(); d; d = mgen.next()) {
-                    if (run->anType() != d->analysis())
-                        continue;
-                    if (!d->do_measure())
-                        measures_done = false;
-                }
+                if (!do_measures(run, o_runops->measures(),
+                        db ? db->measures() : 0))
+                    measures_done = false;
                 run->unsegmentizeVecs();
             }
             if (measures_done) {
@@ -952,12 +970,16 @@ IFoutput::pauseTest(sRunDesc *run)
         Sp.SetFlag(FT_INTERRUPT, false);
         ToolBar()->UpdatePlots(0);
         endIplot(run);
+        if (run && run->rd())
+            run->rd()->file_flush();
         return (E_INTRPT);
     }
     else if (o_shouldstop) {
         o_shouldstop = false;
         ToolBar()->UpdatePlots(0);
         endIplot(run);
+        if (run && run->rd())
+            run->rd()->file_flush();
         return (E_PAUSE);
     }
     else
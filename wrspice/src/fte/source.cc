@@ -1126,7 +1126,7 @@ IFsimulator::ReadLine(FILE *fp, bool *err)
         if (CP.MesgSocket() >= 0) {
             for (;;) {
                 char c;
-                int i = recv(CP.MesgSocket(), &c, 1, 0);
+                int i = CP.MesgRead(&c);
                 if (i <= 0) {
                     // EOF or error
                     if (i < 0) {
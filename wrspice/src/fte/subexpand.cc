@@ -109,6 +109,7 @@ struct sSubc
             su_numargs = 0;
             su_params = 0;
             su_body = 0;
+            su_nested = false;
         }
 
     sSubc(sLine*);
@@ -123,6 +124,7 @@ struct sSubc
     int su_numargs;         // The argument count.
     sParamTab *su_params;   // Name = Value parameter list.
     sLine *su_body;         // The deck that is to be substituted.
+    bool su_nested;         // The body contains calls or definitions.
 };
 
 // Hash table for sSubc objects.
@@ -312,6 +314,19 @@ sFtCirc::expandSubckts()
 {
     sScGlobal sg;
     sg.init(this);
+
+    // If a saved expansion of this deck is found, use it.
+    char *ncpath = sNetCache::path(ci_deck->next(), this);
+    if (ncpath) {
+        sLine *ll = sNetCache::read(ncpath);
+        if (ll) {
+            delete [] ncpath;
+            sLine::destroy(ci_deck->next());
+            ci_deck->set_next(ll);
+            return (true);
+        }
+    }
+
     sLine *edeck = ci_deck->next();
     ci_deck->set_next(0);
 
@@ -319,6 +334,7 @@ sFtCirc::expandSubckts()
     char *cache_name;
     if (!sg.extract_cache_block(&edeck, &cache_name, &cache_blk)) {
         sLine::destroy(edeck);
+        delete [] ncpath;
         return (false);
     }
     if (cache_name) {
@@ -326,16 +342,19 @@ sFtCirc::expandSubckts()
         sLine::destroy(cache_blk);
         if (!ret) {
             sLine::destroy(edeck);
+            delete [] ncpath;
             return (false);
         }
     }
 
     if (!sg.cache_setup(cache_name, &ci_params, &ci_defines)) {
         delete [] cache_name;
+        delete [] ncpath;
         return (false);
     }
     delete [] cache_name;
 
+    unsigned int nvol = Sp.VolatileEvals();
     sLine *ll = sg.expand_and_replace(edeck, ci_params, 0, ci_params);
 
     // Now check to see if there are still subckt instances undefined...
@@ -344,9 +363,17 @@ sFtCirc::expandSubckts()
             GRpkg::self()->ErrPrintf(ET_ERROR,
                 "%s\nSubcircuit expansion, unknown subcircuit.\n", c->line());
             sLine::destroy(ll);
+            delete [] ncpath;
             return (false);
         }
     }
+    if (ncpath) {
+        // If random functions or vectors were evaluated, the next
+        // expansion may differ.
+        if (Sp.VolatileEvals() == nvol)
+            sNetCache::write(ncpath, ll);
+        delete [] ncpath;
+    }
     ci_deck->set_next(ll);
     return (true);
 }
@@ -468,6 +495,7 @@ sScGlobal::expand_and_replace(sLine *deck, const sParamTab *s_ptab,
 #endif
     sLine *lc = 0;
     wordlist *badcalls = 0;
+    sHtab *tmpl_tab = 0;
 
     if (!extract_subckts(&deck)) {
         sLine::destroy(deck);
@@ -570,7 +598,11 @@ sScGlobal::expand_and_replace(sLine *deck, const sParamTab *s_ptab,
 
         // Now we have to replace this card with the macro definition.
         //
-        sLine *lcc = sLine::copy(sss->su_body);
+        sLine *lcc = 0;
+
+        // Count evaluations of random functions and vectors from
+        // here, for the template below.
+        unsigned int nvol = Sp.VolatileEvals();
 
         sParamTab *ptab, *sptab, *iptab;
         if (SPcx.parhier() == ParHierGlobal) {
@@ -618,10 +650,47 @@ sScGlobal::expand_and_replace(sLine *deck, const sParamTab *s_ptab,
             sParamTab::errString = 0;
         }
 
-        // Location of these lines changed in 3.2.18 to fix nesting.
-        sg_stack_ptr++;
-        lcc = expand_and_replace(lcc, sptab, iptab, ptab);
-        sg_stack_ptr--;
+        // If the body contains subcircuit calls, the expansion is
+        // the same for every call from this context with the same
+        // subcircuit and parameters, only the translation differs. 
+        // The expanded body is saved as a template on first use and
+        // copied for later calls, so that the cost of nested
+        // expansion scales with the number of unique calls rather
+        // than the number of instances.  The template holds evaluated
+        // parameters, so it is not saved if random functions or
+        // vectors were evaluated for the call, as these may differ
+        // in the next call.
+        {
+            char *tkey = 0;
+            sLine *tmpl = 0;
+            if (sss->su_nested && !SPcx.nosubtemplate()) {
+                sLstr klstr;
+                klstr.add(sss->su_name);
+                klstr.add_c(' ');
+                if (params)
+                    klstr.add(params);
+                tkey = lstring::copy(klstr.string());
+                if (!tmpl_tab)
+                    tmpl_tab = new sHtab(false);
+                else
+                    tmpl = (sLine*)sHtab::get(tmpl_tab, tkey);
+            }
+            if (tmpl)
+                lcc = sLine::copy(tmpl);
+            else {
+                lcc = sLine::copy(sss->su_body);
+
+                // Location of these lines changed in 3.2.18 to fix
+                // nesting.
+                sg_stack_ptr++;
+                lcc = expand_and_replace(lcc, sptab, iptab, ptab);
+                sg_stack_ptr--;
+
+                if (tkey && lcc && Sp.VolatileEvals() == nvol)
+                    tmpl_tab->add(tkey, sLine::copy(lcc));
+            }
+            delete [] tkey;
+        }
 
 #ifdef TIME_DBG
         double ts_tr == OP.seconds();
@@ -700,6 +769,15 @@ sScGlobal::expand_and_replace(sLine *deck, const sParamTab *s_ptab,
 #endif
 
 cleanup:
+    if (tmpl_tab) {
+        sHgen gen(tmpl_tab, true);
+        sHent *h;
+        while ((h = gen.next()) != 0) {
+            sLine::destroy((sLine*)h->data());
+            delete h;
+        }
+        delete tmpl_tab;
+    }
     sMods::destroy(sg_stack[sg_stack_ptr].mods);
     delete sg_stack[sg_stack_ptr].subs;
     sg_stack[sg_stack_ptr].clear();
@@ -2318,6 +2396,15 @@ sSubc::sSubc(sLine *def)
         }
     }
     check_args(args, nargs);
+
+    su_nested = false;
+    for (sLine *li = su_body; li; li = li->next()) {
+        if (SPcx.kwMatchSubinvoke(li->line()) ||
+                SPcx.kwMatchSubstart(li->line())) {
+            su_nested = true;
+            break;
+        }
+    }
 }
 
 
@@ -2342,6 +2429,7 @@ sSubc::copy(const sSubc *su)
     ns->su_numargs = su->su_numargs;
     ns->su_params = sParamTab::copy(su->su_params);
     ns->su_body = sLine::copy(su->su_body);
+    ns->su_nested = su->su_nested;
     return (ns);
 }
 
@@ -2591,6 +2679,7 @@ sSPcx::kwMatchInit()
 
     cx_pexnodes = Sp.GetVar(kw_pexnodes, VTYP_BOOL, 0);
     cx_nobjthack = Sp.GetVar(kw_nobjthack, VTYP_BOOL, 0);
+    cx_nosubtemplate = Sp.GetVar(kw_nosubtemplate, VTYP_BOOL, 0);
 
     VTvalue vv;
     const char *s = SUBCKT_KW;
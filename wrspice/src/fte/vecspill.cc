@@ -0,0 +1,215 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * WRspice Circuit Simulation and Analysis Tool                           *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "config.h"
+#include "vecspill.h"
+#include "miscutil/filestat.h"
+#include <string.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+
+//
+// Memory-mapped storage for plot vectors.
+//
+
+// The global instance.
+cVecSpill VecSpill;
+
+// Mappings are sized in multiples of this, which must be a multiple
+// of the page size.
+#define VS_CHUNK (1 << 16)
+
+namespace {
+    inline size_t round_chunk(size_t sz)
+    {
+        if (sz < VS_CHUNK)
+            return (VS_CHUNK);
+        return ((sz + VS_CHUNK - 1) & ~((size_t)VS_CHUNK - 1));
+    }
+
+
+#ifndef WIN32
+    // Create a zero-filled temporary file of size bytes and map it,
+    // return null on error.  The file is unlinked and the descriptor
+    // closed, the mapping keeps the file until unmapped, so that
+    // spilled vectors don't use up file descriptors.
+    //
+    void *map_file(size_t size)
+    {
+        char *fname = filestat::make_temp("vs");
+        int fd = open(fname, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            delete [] fname;
+            return (0);
+        }
+        unlink(fname);
+        delete [] fname;
+
+        void *p = MAP_FAILED;
+        if (ftruncate(fd, size) == 0)
+            p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return (p == MAP_FAILED ? 0 : p);
+    }
+#endif
+}
+
+
+// Create a new zero-filled mapping of at least size bytes.  The
+// return is null on error, the caller should then use heap storage.
+//
+sVecMap *
+cVecSpill::map_new(size_t size)
+{
+#ifdef WIN32
+    (void)size;
+    return (0);
+#else
+    size = round_chunk(size);
+    void *p = map_file(size);
+    if (!p)
+        return (0);
+
+    sVecMap *m = new sVecMap;
+    m->vm_base = p;
+    m->vm_size = size;
+    m->vm_prev = 0;
+    m->vm_next = vs_maps;
+    if (vs_maps)
+        vs_maps->vm_prev = m;
+    vs_maps = m;
+    vs_mapped += size;
+    return (m);
+#endif
+}
+
+
+// Change the size of the mapping, preserving the first used bytes of
+// content.  Extended space is zero-filled.  The base address may
+// change.  On error, false is returned and the mapping is unchanged.
+//
+// The file can't be extended once its descriptor is closed, so a
+// larger mapping is a new file with the content copied.  The size is
+// at least doubled to amortize the copying.
+//
+bool
+cVecSpill::map_resize(sVecMap *m, size_t size, size_t used)
+{
+#ifdef WIN32
+    (void)m;
+    (void)size;
+    (void)used;
+    return (false);
+#else
+    if (!m)
+        return (false);
+    size = round_chunk(size);
+    if (size == m->vm_size)
+        return (true);
+    if (size < m->vm_size) {
+        // Release the tail.
+        munmap((char*)m->vm_base + size, m->vm_size - size);
+        vs_mapped -= m->vm_size - size;
+        m->vm_size = size;
+        return (true);
+    }
+    if (size < 2*m->vm_size)
+        size = 2*m->vm_size;
+    void *p = map_file(size);
+    if (!p)
+        return (false);
+    if (used > m->vm_size)
+        used = m->vm_size;
+    memcpy(p, m->vm_base, used);
+    munmap(m->vm_base, m->vm_size);
+    vs_mapped += size;
+    vs_mapped -= m->vm_size;
+    m->vm_base = p;
+    m->vm_size = size;
+    return (true);
+#endif
+}
+
+
+// Unmap and destroy.
+//
+void
+cVecSpill::map_free(sVecMap *m)
+{
+    if (!m)
+        return;
+#ifndef WIN32
+    munmap(m->vm_base, m->vm_size);
+#endif
+    if (m->vm_prev)
+        m->vm_prev->vm_next = m->vm_next;
+    else
+        vs_maps = m->vm_next;
+    if (m->vm_next)
+        m->vm_next->vm_prev = m->vm_prev;
+    vs_mapped -= m->vm_size;
+    delete m;
+}
+
+
+// Release the pages of all mappings from the resident set.  Modified
+// pages are written to the files by the operating system, and pages
+// are read back as needed when accessed.
+//
+void
+cVecSpill::trim()
+{
+    vs_written = 0;
+#ifndef WIN32
+    for (sVecMap *m = vs_maps; m; m = m->vm_next) {
+#ifdef __linux
+        // Dirty pages of a shared mapping remain in the page cache.
+        msync(m->vm_base, m->vm_size, MS_ASYNC);
+#else
+        msync(m->vm_base, m->vm_size, MS_SYNC);
+#endif
+        madvise(m->vm_base, m->vm_size, MADV_DONTNEED);
+    }
+#endif
+}
@@ -50,6 +50,8 @@ Authors: 1987 Thomas L. Quarles
 #include "device.h"
 #include "misc.h"
 #include "subexpand.h"
+#include "kwords_fte.h"
+#include "miscutil/threadpool.h"
 
 
 void
@@ -141,6 +143,89 @@ SPinput::pass1(sCKT *ckt, sLine *deck)
 }
 
 
+namespace {
+    // Decks with fewer lines than this are not worth threading.
+    const int DEVRES_MT_MIN = 10000;
+
+    // Lines per helper thread job.
+    const int DEVRES_BLOCK = 4096;
+
+    // A block of deck lines, the device types of which are resolved
+    // in a helper thread.
+    //
+    struct sDevBlock
+    {
+        sLine *lines;
+        int *types;
+        int nlines;
+    };
+
+    int devres_thread_proc(sTPthreadData*, void *arg)
+    {
+        sDevBlock *b = (sDevBlock*)arg;
+        sLine *l = b->lines;
+        for (int i = 0; i < b->nlines; i++, l = l->next()) {
+            const char *s = l->line();
+            while (isspace(*s))
+                s++;
+            b->types[i] = isalpha(*s) ? IP.findDev(s) : -1;
+        }
+        return (0);
+    }
+
+
+    // Return an array containing the device index of each line, as
+    // returned from findDev, or -1 for lines that are not device
+    // lines.  Models have been read in pass1 and are not changed in
+    // pass2, so this depends only on the line text and can be done
+    // before the serial pass, in parallel using the helper threads
+    // given by the parsethreads variable.  Null is returned if the
+    // deck is small or no threads were requested.
+    //
+    int *resolve_devs(sLine *deck)
+    {
+        int nthreads = DEF_parsethreads;
+        VTvalue vv;
+        if (Sp.GetVar(kw_parsethreads, VTYP_NUM, &vv) &&
+                vv.get_int() >= DEF_parsethreads_MIN &&
+                vv.get_int() <= DEF_parsethreads_MAX)
+            nthreads = vv.get_int();
+        if (nthreads <= 0)
+            return (0);
+
+        int nlines = 0;
+        for (sLine *l = deck; l; l = l->next())
+            nlines++;
+        if (nlines < DEVRES_MT_MIN)
+            return (0);
+
+        int *types = new int[nlines];
+        int nblks = (nlines + DEVRES_BLOCK - 1)/DEVRES_BLOCK;
+        sDevBlock *blks = new sDevBlock[nblks];
+        sLine *l = deck;
+        for (int i = 0; i < nblks; i++) {
+            sDevBlock *b = blks + i;
+            b->lines = l;
+            b->types = types + i*DEVRES_BLOCK;
+            b->nlines = nlines - i*DEVRES_BLOCK;
+            if (b->nlines > DEVRES_BLOCK)
+                b->nlines = DEVRES_BLOCK;
+            for (int j = 0; j < b->nlines; j++)
+                l = l->next();
+        }
+        if (nthreads > nblks - 1)
+            nthreads = nblks - 1;
+
+        cThreadPool pool(nthreads);
+        for (int i = 0; i < nblks; i++)
+            pool.submit(devres_thread_proc, blks + i);
+        pool.run(0);
+        delete [] blks;
+        return (types);
+    }
+}
+
+
 // pass 2 - Scan through the lines.  ".model" cards have been processed
 // in pass1 and are ignored here.
 //
@@ -161,7 +246,12 @@ SPinput::pass2(sCKT *ckt, sLine *data, sTASK *task)
         }
     }
 
-    for (sLine *l = data; l; l = l->next()) {
+    // The device types may be resolved in parallel, the device
+    // creation and linking into the circuit is done serially below.
+    int *types = resolve_devs(data);
+
+    int lnum = 0;
+    for (sLine *l = data; l; l = l->next(), lnum++) {
         const char *thisline = l->line();
 
         // white space should already be stripped
@@ -174,7 +264,7 @@ SPinput::pass2(sCKT *ckt, sLine *data, sTASK *task)
         char c = *thisline;
 
         if (isalpha(c)) {
-            int ix = findDev(thisline);
+            int ix = types ? types[lnum] : findDev(thisline);
             if (ix >= 0)
                 DEV.device(ix)->parse(ix, ckt, l);
             else if (c != 'n' && c != 'N') {
@@ -182,6 +272,7 @@ SPinput::pass2(sCKT *ckt, sLine *data, sTASK *task)
                 logError(l, "Error: Unknown device type.");
                 ckt->CKTnogo = true;
                 ip_current_line = 0;
+                delete [] types;
                 return;
             }
         }
@@ -194,6 +285,7 @@ SPinput::pass2(sCKT *ckt, sLine *data, sTASK *task)
             // something unexpected
             logError(l, "Syntax error.");
     }
+    delete [] types;
     ip_current_line = 0;
 }
 
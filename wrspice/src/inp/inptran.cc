@@ -2309,6 +2309,93 @@ again:
 }
 
 
+namespace {
+    // Lazy breakpoint generator for PWL sources, yields the corners
+    // in order, including repetitions, up to the final time.
+    //
+    struct pwl_brkgen : public sCKTbreakGen
+    {
+        pwl_brkgen(const double *coeffs, int n, bool rgiven, int rstart,
+            double tfinal)
+            {
+                pg_times = new double[n];
+                for (int i = 0; i < n; i++)
+                    pg_times[i] = coeffs[2*i];
+                pg_num = n;
+                pg_rstart = -1;
+                pg_per = 0.0;
+                if (rgiven && rstart >= 0 && rstart < n-1) {
+                    pg_rstart = rstart;
+                    pg_per = pg_times[n-1] - pg_times[rstart];
+                }
+                pg_final = tfinal;
+                pg_ta = 0.0;
+                pg_ix = 0;
+                pg_done = false;
+            }
+
+        ~pwl_brkgen()
+            {
+                delete [] pg_times;
+            }
+
+        bool next_after(double t, double *pt) const
+            {
+                if (pg_done)
+                    return (false);
+                int ix = pg_ix;
+                double ta = pg_ta;
+                if (!find(t, &ix, &ta))
+                    return (false);
+                *pt = pg_times[ix] + ta;
+                return (true);
+            }
+
+        void advance(double t)
+            {
+                if (!pg_done && !find(t, &pg_ix, &pg_ta))
+                    pg_done = true;
+            }
+
+    private:
+        // Starting at the given position, find the first corner
+        // later than t, return false if none.
+        //
+        bool find(double t, int *pix, double *pta) const
+            {
+                int ix = *pix;
+                double ta = *pta;
+                for (;;) {
+                    if (ix >= pg_num) {
+                        if (pg_rstart < 0 || pg_per <= 0.0)
+                            return (false);
+                        ta += pg_per;
+                        ix = pg_rstart + 1;
+                    }
+                    double x = pg_times[ix] + ta;
+                    if (x > pg_final)
+                        return (false);
+                    if (x > t)
+                        break;
+                    ix++;
+                }
+                *pix = ix;
+                *pta = ta;
+                return (true);
+            }
+
+        double *pg_times;   // corner times
+        int pg_num;         // number of corners
+        int pg_rstart;      // repeat start index, or -1
+        double pg_per;      // repeat period
+        double pg_final;    // final time
+        double pg_ta;       // current period offset
+        int pg_ix;          // current corner index
+        bool pg_done;       // no more corners
+    };
+}
+
+
 void
 IFpwlData::setup(sCKT *ckt, double step, double finaltime, bool skipbr)
 {
@@ -2317,26 +2404,12 @@ IFpwlData::setup(sCKT *ckt, double step, double finaltime, bool skipbr)
     if (td_enable_tran && !skipbr && ckt) {
         // Only call this when time is independent variable.
 
+        // The corners are supplied on demand, so that long and
+        // repeating PWL sources don't fill the breakpoint table.
         int n = td_numcoeffs/2;
-        double ta = 0.0;
-        int istart = 0;
-        for (;;) {
-            for (int i = istart; i < n; i++) {
-                double t = td_coeffs[2*i] + ta;
-                if (t > finaltime)
-                    return;
-                ckt->breakSet(t);
-#ifdef DEBUG
-                printf("B %g\n", t);
-#endif
-            }
-            if (!td_pwlRgiven)
-                break;
-            double dd = td_coeffs[2*(n-1)] - td_coeffs[2*td_pwlRstart];
-            if (dd == 0.0)
-                return;
-            ta += dd;
-            istart = td_pwlRstart + 1;
+        if (n > 0) {
+            ckt->breakSetGen(new pwl_brkgen(td_coeffs, n, td_pwlRgiven,
+                td_pwlRstart, finaltime));
         }
     }
 }
@@ -77,33 +77,42 @@ OPTIMIZER::opt_begin()
         param.accuracy());
     out_screen_file(
         "        Margins:                                 Percent:\n");
+
+    // The margin searches are independent, find them all at once.
+    int nsrch = 2*o_dim;
+    double **pcs = matrix(0, nsrch-1, 1, o_dim);
+    double **pos = matrix(0, nsrch-1, 1, o_dim);
+    int *pix = ivector(0, nsrch-1);
     for (int x = 1; x <= o_dim; x++) {
+        double *pcl = pcs[2*(x-1)];
+        double *pol = pos[2*(x-1)];
+        double *pcu = pcs[2*(x-1)+1];
+        double *pou = pos[2*(x-1)+1];
         for (int y = 1; y <= o_dim; y++)
-            o_pc[y] = o_po[y] = o_centerpnt[y];
-        o_pc[x] = o_centerpnt[x]-STEP/o_scale[x];
-        o_po[x] = o_lower[x]-OUT/o_scale[x];
-        if (!addpoint())
-            nrerror("parameter values failed");
-        else {
-            out_screen_file("%s\t%9.5f%s...%9.5f ...",
-                o_names[x-1], o_hullpnts[o_pntcount][x]*o_scale[x],
-                (o_hullpnts[o_pntcount][x] > o_lower[x]) ? "*" : " ",
-                o_centerpnt[x]*o_scale[x]);
-        }
-        o_pc[x] = o_centerpnt[x] + STEP/o_scale[x];
-        o_po[x] = o_upper[x] + OUT/o_scale[x];
-        if (!addpoint())
-            nrerror("parameter values failed");
-        else {
-            out_screen_file("%9.5f%s     -%5.1f  +%5.1f\n",
-                o_hullpnts[o_pntcount][x]*o_scale[x],
-                (o_hullpnts[o_pntcount][x] > o_upper[x]) ? "*" : " ",
-                100.0*(o_centerpnt[x] - o_hullpnts[o_pntcount-1][x])/
-                    o_centerpnt[x],
-                100.0*(o_hullpnts[o_pntcount][x] - o_centerpnt[x])/
-                    o_centerpnt[x]);
-        }
+            pcl[y] = pol[y] = pcu[y] = pou[y] = o_centerpnt[y];
+        pcl[x] = o_centerpnt[x] - STEP/o_scale[x];
+        pol[x] = o_lower[x] - OUT/o_scale[x];
+        pcu[x] = o_centerpnt[x] + STEP/o_scale[x];
+        pou[x] = o_upper[x] + OUT/o_scale[x];
+    }
+    if (addpoints(nsrch, pcs, pos, pix) != nsrch)
+        nrerror("parameter values failed");
+    for (int x = 1; x <= o_dim; x++) {
+        double *hl = o_hullpnts[pix[2*(x-1)]];
+        double *hu = o_hullpnts[pix[2*(x-1)+1]];
+        out_screen_file("%s\t%9.5f%s...%9.5f ...",
+            o_names[x-1], hl[x]*o_scale[x],
+            (hl[x] > o_lower[x]) ? "*" : " ",
+            o_centerpnt[x]*o_scale[x]);
+        out_screen_file("%9.5f%s     -%5.1f  +%5.1f\n",
+            hu[x]*o_scale[x],
+            (hu[x] > o_upper[x]) ? "*" : " ",
+            100.0*(o_centerpnt[x] - hl[x])/o_centerpnt[x],
+            100.0*(hu[x] - o_centerpnt[x])/o_centerpnt[x]);
     }
+    free_matrix(pcs, 0, nsrch-1, 1, o_dim);
+    free_matrix(pos, 0, nsrch-1, 1, o_dim);
+    free_ivector(pix, 0, nsrch-1);
 
     // Pick combinations of dim points and make the hull.
     intpickpnts(1, o_pntstack);
@@ -322,7 +331,11 @@ OPTIMIZER::opt_result()
     // Convexity check along critical vectors.
     out_screen_file(
         "\n\ndistance to boundary (normalized) ... critical direction\n");
-    for (int y = 1; y <= o_dim+1-o_pin; y++) {
+    int nsrch = o_dim+1-o_pin;
+    double **pcs = matrix(0, nsrch-1, 1, o_dim);
+    double **pos = matrix(0, nsrch-1, 1, o_dim);
+    int *pix = ivector(0, nsrch-1);
+    for (int y = 1; y <= nsrch; y++) {
         for (int x = 1; x <= o_dim; x++) {
             // Find the closest boundary and calculate the search points.
             double cbig = 0.0;
@@ -334,26 +347,30 @@ OPTIMIZER::opt_result()
                     cbig = c;
             }
             // pc at center, po on boundary
-            o_pc[x] = o_centerpnt[x];
-            o_po[x] = o_centerpnt[x] - o_ab[tang[y]][x]/cbig -
+            pcs[y-1][x] = o_centerpnt[x];
+            pos[y-1][x] = o_centerpnt[x] - o_ab[tang[y]][x]/cbig -
                 OUT/o_scale[x]*o_ab[tang[y]][x];
         }
-        // Find boundary.
-        if (!addpoint())
-            nrerror("parameter values failed");
-        else {
-            double dist = 0.0;
-            for (int x = 1; x <= o_dim; x++)
-                dist += (o_hullpnts[o_pntcount][x] -
-                    o_centerpnt[x])*(o_hullpnts[o_pntcount][x] - o_centerpnt[x]);
-            dist = sqrt(dist);
-            out_screen_file("%6.4f  ... ", (dist/o_radius[0]));
-            for (int x = 1; x <= o_dim; x++)
-                out_screen_file("%7.3f   ",-o_ab[tang[y]][x]);
-        }
+    }
+
+    // Find boundaries, the searches are independent.
+    if (addpoints(nsrch, pcs, pos, pix) != nsrch)
+        nrerror("parameter values failed");
+    for (int y = 1; y <= nsrch; y++) {
+        double *h = o_hullpnts[pix[y-1]];
+        double dist = 0.0;
+        for (int x = 1; x <= o_dim; x++)
+            dist += (h[x] - o_centerpnt[x])*(h[x] - o_centerpnt[x]);
+        dist = sqrt(dist);
+        out_screen_file("%6.4f  ... ", (dist/o_radius[0]));
+        for (int x = 1; x <= o_dim; x++)
+            out_screen_file("%7.3f   ",-o_ab[tang[y]][x]);
         out_screen_file("\n");
     }
     out_screen_file("\n");
+    free_matrix(pcs, 0, nsrch-1, 1, o_dim);
+    free_matrix(pos, 0, nsrch-1, 1, o_dim);
+    free_ivector(pix, 0, nsrch-1);
 
     // Yield calculations assuming three and one sigma.
     long seed = -1;
@@ -79,6 +79,7 @@ struct OPTIMIZER
     bool set_statics(int, int);
     void finalize_setup();
     int addpoint();
+    int addpoints(int, double**, double**, int*);
 
 private:
 
@@ -93,6 +94,8 @@ private:
     void out_screen_file(const char*, ...);
 
     // points.cc
+    void write_limits(const char*, const double*, const double*);
+    bool read_point(const char*, double*, double*);
     void add_parameter_set(PARAMETER_SET*);
 
     double  *o_facecenter;
@@ -5,6 +5,11 @@
 //#include <ctype.h>
 
 #include "param.h"
+#ifdef WIN32
+#include "miscutil/msw.h"
+#else
+#include <unistd.h>
+#endif
 
 // OPTIONS
 
@@ -110,6 +115,7 @@ PARAMETERS::init_parameters()
     set_maxplane            ( 50000 );
     set_maxiter             ( 100 );
     set_miniter             ( 10 );
+    set_max_jobs            ( 1 );
     set_pulse_extr_method   ( COLLECT_BY_PHASE );
     set_nom_phase_thresh    ( PHASE_THRESHOLD );
     set_min_phase_thresh    ( MIN_PHASE_THRESHOLD );
@@ -229,6 +235,7 @@ namespace {
         "MAX_PLANE",
         "MAX_ITER",
         "MIN_ITER",
+        "MAX_JOBS",
 
         "TIMING_SEARCH_ACCURACY",
         "SIGNAL_EXTENSION",
@@ -294,6 +301,7 @@ namespace {
          MAXPLANE_CONFIG,
          MAXITER_CONFIG,
          MINITER_CONFIG,
+         MAXJOBS_CONFIG,
 
          TIME_ACCURACY_CONFIG,
          SIGNAL_CONFIG,
@@ -538,6 +546,15 @@ PARAMETERS::read_config(const char *filename)
                 p_miniter = ivalue;
             break;
 
+        case MAXJOBS_CONFIG:
+            if (sscanf(item, "%d", &ivalue) != 1 || ivalue < 1) {
+                unrecognized_value(in_buffer, filename);
+                no_error = 0;
+            }
+            else
+                p_max_jobs = ivalue;
+            break;
+
         case MIN_PH_DIFF_CONFIG:
             if (sscanf(item, "%lf", &fvalue) != 1) {
                 unrecognized_value(in_buffer, filename);  
@@ -987,17 +1004,54 @@ PARAMETERS::read_options(int argc, const char *argv[])
 }
 
 
+namespace {
+    // Return a copy of path, prefixed with cwd if relative.
+    //
+    char *abs_path(const char *cwd, const char *path)
+    {
+        if (!cwd || *path == '/')
+            return (lstring::copy(path));
+        char *t = new char[strlen(cwd) + strlen(path) + 2];
+        sprintf(t, "%s/%s", cwd, path);
+        return (t);
+    }
+}
+
+
+// Write the configuration file read by the simulator scripts.  If
+// dir is given, the file is written in that directory, which will be
+// the working directory of a concurrent job.  The directory paths are
+// then absolute, and the job directory is used as the temporary
+// directory, so that concurrent jobs don't share scratch files.
+//
 int
-PARAMETERS::generate_spice_config()
+PARAMETERS::generate_spice_config(const char *dir)
 {
     int is_ws = (strstr(p_spice_name, "wrspice") != 0);
 
-    FILE *fp = fopen(SPICE_CONFIG_FILE, "w");
+    char *cwd = 0;
+    char *fname;
+    if (dir) {
+        cwd = getcwd(0, 0);
+        if (!cwd) {
+            printf("Cannot get current directory.\n\n");
+            return 0;
+        }
+        fname = new char[strlen(dir) + strlen(SPICE_CONFIG_FILE) + 2];
+        sprintf(fname, "%s/%s", dir, SPICE_CONFIG_FILE);
+    }
+    else
+        fname = lstring::copy(SPICE_CONFIG_FILE);
+
+    FILE *fp = fopen(fname, "w");
     if (fp == 0) {
         printf("Cannot create %s configuration file %s.\n\n",
-            is_ws ? "wrspice" : "jspice", SPICE_CONFIG_FILE);
+            is_ws ? "wrspice" : "jspice", fname);
+        delete [] fname;
+        free(cwd);
         return 0;
     }
+    delete [] fname;
 
     if (is_ws) {
         fprintf(fp, "set subc_catchar=\":\"\n");
@@ -1026,9 +1080,23 @@ PARAMETERS::generate_spice_config()
 
     fprintf(fp, "set reportext   = '%s'\n\n", p_report_ext);
 
-    fprintf(fp, "set input_dir   = '%s'\n", p_input_dir);
-    fprintf(fp, "set tmp_dir     = '%s'\n", p_tmp_dir);
-    fprintf(fp, "set output_dir  = '%s'\n\n", p_output_dir);
+    if (dir) {
+        char *t = abs_path(cwd, p_input_dir);
+        fprintf(fp, "set input_dir   = '%s'\n", t);
+        delete [] t;
+        t = abs_path(cwd, dir);
+        fprintf(fp, "set tmp_dir     = '%s/'\n", t);
+        delete [] t;
+        t = abs_path(cwd, p_output_dir);
+        fprintf(fp, "set output_dir  = '%s'\n\n", t);
+        delete [] t;
+        free(cwd);
+    }
+    else {
+        fprintf(fp, "set input_dir   = '%s'\n", p_input_dir);
+        fprintf(fp, "set tmp_dir     = '%s'\n", p_tmp_dir);
+        fprintf(fp, "set output_dir  = '%s'\n\n", p_output_dir);
+    }
 
     fprintf(fp, "failthres    = %.2f\n", p_min_fail_thresh);
     fprintf(fp, "accuracy     = %.5f\n", p_accuracy/100.0);
@@ -108,10 +108,12 @@ typedef double VOLTAGE;
 struct PARAMETERS
 {
     bool opt_begin(int, const char*[]);
+    int generate_spice_config(const char* = 0);
 
     int maxplane()              { return (p_maxplane); }
     int maxiter()               { return (p_maxiter); }
     int miniter()               { return (p_miniter); }
+    int max_jobs()              { return (p_max_jobs); }
     int pulse_extr_method()     { return (p_pulse_extr_method); }
     PHASE nom_phase_thresh()    { return (p_nom_phase_thresh); }
     PHASE min_phase_thresh()    { return (p_min_phase_thresh); }
@@ -180,6 +182,7 @@ struct PARAMETERS
     void set_maxplane(int i)            { p_maxplane = i; }
     void set_maxiter(int i)             { p_maxiter = i; }
     void set_miniter(int i)             { p_miniter = i; }
+    void set_max_jobs(int i)            { p_max_jobs = i; }
     void set_pulse_extr_method(int i)   { p_pulse_extr_method = i; }
     void set_nom_phase_thresh(PHASE p)  { p_nom_phase_thresh = p; }
     void set_min_phase_thresh(PHASE p)  { p_min_phase_thresh = p; }
@@ -283,8 +286,6 @@ private:
     int read_config(const char*);
     int check_option(const char*);
     int read_options(int, const char**);
-    int generate_spice_config();
-
     int p_maxplane;
         // Maximum number of hull planes.
 
@@ -294,6 +295,9 @@ private:
     int p_miniter;
         // Maximum number of iterations.
 
+    int p_max_jobs;
+        // Maximum number of simulator processes run concurrently.
+
     int p_pulse_extr_method;
         // Pulse extraction method possible values:
         //   COLLECT_BY_PHASE    = phase threshold method
@@ -9,6 +9,14 @@
 #include "qnrutil.h"
 #include "optimizer.h"
 
+#ifndef WIN32
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
 #ifdef WIN32
 #define BOUNDARY_CALL       " boundary > NUL"
 #else
@@ -298,26 +306,187 @@ OPTIMIZER::finalize_setup()
 int
 OPTIMIZER::addpoint()
 {
-    char errmsg[LINE_LENGTH];
+    write_limits(LIMITS_FILE, o_pc, o_po);
+
     char system_call[LINE_LENGTH];
+    strcpy(system_call, param.spice_name());
+    strcat(system_call, BOUNDARY_CALL);
+    system(system_call);
+
+    // Read in and scale the new point.
+    if (!read_point(POINT_FILE, o_hullpnts[o_pntcount+1], o_delta))
+        return (0);
+    ++o_pntcount;
+    return (1);
+}
+
+
+// Find the boundary points for n independent searches, pcs[i] on
+// the plane and pos[i] on the boundary.  The points found are added
+// to the hull in order, and the hull index of each is returned in
+// pix, or 0 if concave.  The return value is the number of points
+// added.
+//
+// If MAX_JOBS is larger than one, up to that many simulator
+// processes are run concurrently.  Each runs in a private job
+// directory in the temporary directory, which holds the limits and
+// point files, the configuration, and the script scratch files.
+//
+int
+OPTIMIZER::addpoints(int n, double **pcs, double **pos, int *pix)
+{
+    int njobs = param.max_jobs();
+#ifdef WIN32
+    njobs = 1;
+#endif
+    if (njobs > n)
+        njobs = n;
+    if (njobs <= 1) {
+        int cnt = 0;
+        for (int i = 0; i < n; i++) {
+            for (int x = 1; x <= o_dim; x++) {
+                o_pc[x] = pcs[i][x];
+                o_po[x] = pos[i][x];
+            }
+            pix[i] = addpoint() ? o_pntcount : 0;
+            if (pix[i])
+                cnt++;
+        }
+        return (cnt);
+    }
+
+#ifdef WIN32
+    return (0);
+#else
+    char *cwd = getcwd(0, 0);
+    if (!cwd)
+        nrerror("Can't get the current directory.\n");
+
+    // Set up the job directories.
+    char **dirs = new char*[njobs];
+    for (int j = 0; j < njobs; j++) {
+        dirs[j] = new char[strlen(param.tmp_dir()) + 16];
+        sprintf(dirs[j], "%sjob%d", param.tmp_dir(), j);
+        if (mkdir(dirs[j], 0755) < 0 && errno != EEXIST) {
+            char errmsg[LONG_LINE_LENGTH];
+            snprintf(errmsg, LONG_LINE_LENGTH,
+                "Can't create the '%s' directory.\n", dirs[j]);
+            nrerror(errmsg);
+        }
+        if (!param.generate_spice_config(dirs[j]))
+            nrerror("Can't write the job configuration file.\n");
+    }
+
+    // The results are saved and added in order after all jobs
+    // complete, so that the hull does not depend on job timing.
+    double **pts = matrix(0, n-1, 1, o_dim);
+    double **dlts = matrix(0, n-1, 0, o_dim);
+    bool *good = new bool[n];
+
+    pid_t *pids = new pid_t[njobs];
+    int *which = new int[njobs];
+    for (int j = 0; j < njobs; j++)
+        pids[j] = 0;
+
+    char fname[LONG_LINE_LENGTH];
+    char cmd[3*LONG_LINE_LENGTH];
+    int next = 0;
+    int running = 0;
+    while (next < n || running) {
+        // Start jobs in the idle slots.
+        for (int j = 0; j < njobs && next < n; j++) {
+            if (pids[j] > 0)
+                continue;
+            snprintf(fname, LONG_LINE_LENGTH, "%s/%s", dirs[j], LIMITS_FILE);
+            write_limits(fname, pcs[next], pos[next]);
+            snprintf(fname, LONG_LINE_LENGTH, "%s/%s", dirs[j], POINT_FILE);
+            unlink(fname);
+
+            snprintf(cmd, 3*LONG_LINE_LENGTH, "cd %s && %s %s/%s", dirs[j],
+                param.spice_name(), cwd, BOUNDARY_CALL + 1);
+            pid_t pid = fork();
+            if (pid == 0) {
+                execl("/bin/sh", "sh", "-c", cmd, (char*)0);
+                _exit(127);
+            }
+            if (pid < 0)
+                nrerror("Can't fork a simulator process.\n");
+            pids[j] = pid;
+            which[j] = next++;
+            running++;
+        }
+
+        // Collect a finished job.
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            nrerror("Lost track of simulator processes.\n");
+        }
+        for (int j = 0; j < njobs; j++) {
+            if (pids[j] != pid)
+                continue;
+            int i = which[j];
+            snprintf(fname, LONG_LINE_LENGTH, "%s/%s", dirs[j], POINT_FILE);
+            good[i] = read_point(fname, pts[i], dlts[i]);
+            pids[j] = 0;
+            running--;
+            break;
+        }
+    }
+
+    int cnt = 0;
+    for (int i = 0; i < n; i++) {
+        pix[i] = 0;
+        if (!good[i])
+            continue;
+        ++o_pntcount;
+        for (int x = 1; x <= o_dim; x++)
+            o_hullpnts[o_pntcount][x] = pts[i][x];
+        for (int x = 0; x <= o_dim; x++)
+            o_delta[x] = dlts[i][x];
+        pix[i] = o_pntcount;
+        cnt++;
+    }
+
+    delete [] pids;
+    delete [] which;
+    delete [] good;
+    free_matrix(pts, 0, n-1, 1, o_dim);
+    free_matrix(dlts, 0, n-1, 0, o_dim);
+    for (int j = 0; j < njobs; j++)
+        delete [] dirs[j];
+    delete [] dirs;
+    free(cwd);
+    return (cnt);
+#endif
+}
+
 
-    FILE *fp = fopen(LIMITS_FILE,"w");
+// Write the limits file read by the boundary script, for a search
+// from pc on the plane to po on the boundary.
+//
+void
+OPTIMIZER::write_limits(const char *fname, const double *pc, const double *po)
+{
+    FILE *fp = fopen(fname, "w");
     if (!fp) {
-        strcpy(errmsg, "Can't write to the '");
-        strcat(errmsg, LIMITS_FILE);
-        strcat(errmsg, "' file.\n");
+        char errmsg[LONG_LINE_LENGTH];
+        snprintf(errmsg, LONG_LINE_LENGTH, "Can't write to the '%s' file.\n",
+            fname);
         nrerror(errmsg);
     }
 
     // Load zeroeth element with unscaled value for accuracy.
     double dist = 0.0;
     for (int x = 1; x <= o_dim; x++)
-        dist += (o_pc[x]-o_po[x])*(o_pc[x]-o_po[x])*o_scale[x]*o_scale[x];
+        dist += (pc[x]-po[x])*(pc[x]-po[x])*o_scale[x]*o_scale[x];
     dist = sqrt(dist);
 
-    double inveffcenter = fabs(o_pc[1]-o_po[1])/(dist*o_centerpnt[1]);
+    double inveffcenter = fabs(pc[1]-po[1])/(dist*o_centerpnt[1]);
     for (int x = 2; x <= o_dim; x++) {
-        double dum = fabs(o_pc[x]-o_po[x])/(dist*o_centerpnt[x]);
+        double dum = fabs(pc[x]-po[x])/(dist*o_centerpnt[x]);
         if (dum > inveffcenter)
              inveffcenter = dum;
     }
@@ -329,43 +498,45 @@ OPTIMIZER::addpoint()
     // pc on plane, po on the boundary
     // Unscale it.
     for (int x = 1; o_dim >= x; ++x) {
-        fprintf(fp, "pc[%i]=%f\n", x, o_pc[x]*o_scale[x]);
-        fprintf(fp, "po[%i]=%f\n", x, o_po[x]*o_scale[x]);
+        fprintf(fp, "pc[%i]=%f\n", x, pc[x]*o_scale[x]);
+        fprintf(fp, "po[%i]=%f\n", x, po[x]*o_scale[x]);
     }
 
     // Print the circuit and circnumber names.
     fprintf(fp, "set circuit = '%s'\n", param.circuit_name());
     fprintf(fp, "set opt_num = '%s'\n", param.opt_num());
     fclose(fp);
+}
 
-    strcpy(system_call, param.spice_name());
-    strcat(system_call, BOUNDARY_CALL);
-    system(system_call);
 
-    fp = fopen(POINT_FILE,"r");
+// Read the point file written by the boundary script.  If the point
+// is not concave, it is scaled and returned in pt (indices 1 - dim)
+// and the deltas in delta (indices 0 - dim), and true is returned.
+//
+bool
+OPTIMIZER::read_point(const char *fname, double *pt, double *delta)
+{
+    FILE *fp = fopen(fname, "r");
     if (!fp) {
-        strcpy(errmsg, "Can't read the '");
-        strcat(errmsg, POINT_FILE);
-        strcat(errmsg, "' file.\n");
+        char errmsg[LONG_LINE_LENGTH];
+        snprintf(errmsg, LONG_LINE_LENGTH, "Can't read the '%s' file.\n",
+            fname);
         nrerror(errmsg);
     }
     int concave;
     fscanf(fp, "%d", &concave);
 
-    // Read in and scale the new point.
     if (!concave) {
-        ++o_pntcount;
-
         // Throw away the zeroeth array element.
         double dum;
         fscanf(fp, "%lf", &dum);
         for (int x = 1; x <= o_dim; x++) {
-            fscanf(fp, "%lf", *(o_hullpnts+o_pntcount)+x);
-            o_hullpnts[o_pntcount][x] /= o_scale[x];
+            fscanf(fp, "%lf", pt+x);
+            pt[x] /= o_scale[x];
         }
 
         for (int x = 0; x <= o_dim; x++) 
-            fscanf(fp, "%lf", &o_delta[x]);
+            fscanf(fp, "%lf", &delta[x]);
     }
 
     fclose(fp);
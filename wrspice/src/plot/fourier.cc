@@ -53,6 +53,7 @@ Authors: 1985 Wayne A. Christopher
 #include "commands.h"
 #include "parser.h"
 #include "spnumber/spnumber.h"
+#include "miscutil/threadpool.h"
 
 #ifdef WIN32
 extern double erfc(double);
@@ -112,9 +113,20 @@ void fourier(
         Phase[i] = 0;
     }
     for (i = 0; i < ndata; i++) {
+        // The harmonics are obtained by rotation, rather than
+        // calling sin/cos for each one.
+        double th = 2.0*M_PI*i/((double)ndata);
+        double c1 = cos(th);
+        double s1 = sin(th);
+        double c = 1.0;
+        double s = 0.0;
+        double v = Value[i];
         for (int j = 0; j < numFreq; j++) {
-            Mag[j]   += (Value[i]*sin(j*2.0*M_PI*i/((double)ndata)));
-            Phase[j] += (Value[i]*cos(j*2.0*M_PI*i/((double)ndata)));
+            Mag[j]   += v*s;
+            Phase[j] += v*c;
+            double t = c*c1 - s*s1;
+            s = s*c1 + c*s1;
+            c = t;
         }
     }
 
@@ -394,6 +406,71 @@ namespace {
 }
 
 
+namespace {
+    // Frequency points per job in spec.  The sin/cos values for the
+    // first point in the job are computed directly, those for the
+    // remaining points are obtained by rotation.
+    //
+#define SPEC_CHUNK 32
+
+    struct sSpecJob
+    {
+        int j0, j1;             // frequency index range
+        int tlen;               // number of time points
+        int ngood;              // number of vectors
+        const double *time;     // time points
+        const double *win;      // window
+        const double *freq;     // frequency points
+        const double *dc;       // dc value for each vector
+        const double *cstep;    // rotation per frequency step
+        const double *sstep;
+        double **tdvec;         // input vectors
+        complex **fdvec;        // output vectors
+    };
+
+
+    // Compute the transform for a range of frequency points.  This
+    // can be called from any thread.
+    //
+    int spec_proc(sTPthreadData*, void *arg)
+    {
+        sSpecJob *jb = (sSpecJob*)arg;
+        int j0 = jb->j0;
+        int j1 = jb->j1;
+        int ngood = jb->ngood;
+        for (int j = j0; j < j1; j++) {
+            for (int i = 0; i < ngood; i++) {
+                jb->fdvec[i][j].real = 0.0;
+                jb->fdvec[i][j].imag = 0.0;
+            }
+        }
+        double *vals = new double[ngood];
+        int tlen = jb->tlen;
+        for (int k = 1; k < tlen; k++) {
+            double amp = 2*jb->win[k]/(tlen-1);
+            for (int i = 0; i < ngood; i++)
+                vals[i] = jb->tdvec[i][k] - jb->dc[i];
+            double rad = 2*M_PI*jb->time[k]*jb->freq[j0];
+            double cosa = amp*cos(rad);
+            double sina = amp*sin(rad);
+            double cs = jb->cstep[k];
+            double ss = jb->sstep[k];
+            for (int j = j0; j < j1; j++) {
+                for (int i = 0; i < ngood; i++) {
+                    jb->fdvec[i][j].real += vals[i]*cosa;
+                    jb->fdvec[i][j].imag += vals[i]*sina;
+                }
+                double t = cosa*cs - sina*ss;
+                sina = sina*cs + cosa*ss;
+                cosa = t;
+            }
+        }
+        delete [] vals;
+        return (0);
+    }
+}
+
+
 //
 // Code to do fourier transforms on transient analysis data.
 //
@@ -574,26 +651,61 @@ CommandTab::com_spec(wordlist *wl)
 
     bool trace = Sp.GetVar(kw_spectrace, VTYP_BOOL, 0);
 
-    for (int j = (startf == 0.0 ? 1 : 0); j < fpts; j++) {
+    int nthreads = DEF_postthreads;
+    VTvalue vv;
+    if (Sp.GetVar(kw_postthreads, VTYP_NUM, &vv) &&
+            vv.get_int() >= DEF_postthreads_MIN &&
+            vv.get_int() <= DEF_postthreads_MAX)
+        nthreads = vv.get_int();
+
+    // The per-sample phase increment between frequency points.
+    double *cstep = new double[tlen];
+    double *sstep = new double[tlen];
+    for (int k = 1; k < tlen; k++) {
+        double rad = 2*M_PI*time[k]*stepf;
+        cstep[k] = cos(rad);
+        sstep[k] = sin(rad);
+    }
+
+    int j0 = (startf == 0.0 ? 1 : 0);
+    for (int j = j0; j < fpts; j++)
         freq[j] = startf + j*stepf;
-        if (trace)
-            TTY.printf("spec: %e Hz: \r", freq[j]);
-        for (int i = 0; i < ngood; i++) {
-            fdvec[i][j].real = 0.0; 
-            fdvec[i][j].imag = 0.0;
-        }
-        for (int k = 1; k < tlen; k++) {
-            double amp = 2*win[k]/(tlen-1);
-            double rad = 2*M_PI*time[k]*freq[j];
-            double cosa = amp*cos(rad);
-            double sina = amp*sin(rad);
-            for (int i = 0; i < ngood; i++) {
-                double value = tdvec[i][k] - dc[i];
-                fdvec[i][j].real += value*cosa;
-                fdvec[i][j].imag += value*sina;
-            }
+
+    int njobs = (fpts - j0 + SPEC_CHUNK - 1)/SPEC_CHUNK;
+    sSpecJob *jobs = new sSpecJob[njobs];
+    for (int n = 0; n < njobs; n++) {
+        sSpecJob *jb = jobs + n;
+        jb->j0 = j0 + n*SPEC_CHUNK;
+        jb->j1 = SPMIN(jb->j0 + SPEC_CHUNK, fpts);
+        jb->tlen = tlen;
+        jb->ngood = ngood;
+        jb->time = time;
+        jb->win = win;
+        jb->freq = freq;
+        jb->dc = dc;
+        jb->cstep = cstep;
+        jb->sstep = sstep;
+        jb->tdvec = tdvec;
+        jb->fdvec = fdvec;
+    }
+    if (nthreads > 0 && njobs > 1) {
+        if (nthreads > njobs - 1)
+            nthreads = njobs - 1;
+        cThreadPool pool(nthreads);
+        for (int n = 0; n < njobs; n++)
+            pool.submit(spec_proc, jobs + n);
+        pool.run(0);
+    }
+    else {
+        for (int n = 0; n < njobs; n++) {
+            if (trace)
+                TTY.printf("spec: %e Hz: \r", freq[jobs[n].j0]);
+            spec_proc(0, jobs + n);
         }
     }
+    delete [] jobs;
+    delete [] cstep;
+    delete [] sstep;
     if (startf == 0.0) {
         freq[0] = 0.0;
         for (int i = 0; i < ngood; i++) {
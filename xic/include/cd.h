@@ -378,21 +378,32 @@ public:
 
     //
     // String table for cell names.  All cell names in database objects
-    // are in this table.
+    // are in this table.  These can be called from helper threads,
+    // e.g., parallel readers.
     //
 
     CDcellName CellNameTableAdd(const char *n)
         {
-            if (!cdCellNameTable)
-                cdCellNameTable = new strtab_t;
-            return ((CDcellName)cdCellNameTable->add(n));
+            mtstrtab_t *tab = __atomic_load_n(&cdCellNameTable,
+                __ATOMIC_ACQUIRE);
+            if (!tab) {
+                tab = new mtstrtab_t;
+                if (!__sync_bool_compare_and_swap(&cdCellNameTable, 0,
+                        tab)) {
+                    delete tab;
+                    tab = cdCellNameTable;
+                }
+            }
+            return ((CDcellName)tab->add(n));
         }
 
     CDcellName CellNameTableFind(const char *n)
         {
-            if (!cdCellNameTable)
+            mtstrtab_t *tab = __atomic_load_n(&cdCellNameTable,
+                __ATOMIC_ACQUIRE);
+            if (!tab)
                 return (0);
-            return ((CDcellName)cdCellNameTable->find(n));
+            return ((CDcellName)tab->find(n));
         }
 
     //
@@ -599,7 +610,7 @@ public:
     void SetOut32nodes(bool b)      { cdOut32nodes = b; }
 
 private:
-    strtab_t *cdCellNameTable;      // Cell name table
+    mtstrtab_t *cdCellNameTable;    // Cell name table, thread-safe
     cstrtab_t *cdPfxTable;          // Device prefix table
     cstrtab_t *cdInstNameTable;     // Instance name table
     strtab_t *cdArchiveTable;       // Archive/library name table
@@ -912,6 +912,7 @@ struct CDs : public CDdb
     bool computeBB();
     bool fixBBs(ptrtab_t* = 0);
     bool checkInstances();
+    void checkCoinc(const CDl*);
     bool findNode(int, int, int* = 0);
     bool checkVertex(int, int, CDw*);
     bool checkVertex(int*, int*, int, bool);
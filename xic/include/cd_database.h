@@ -127,6 +127,8 @@ struct CDdb
     int num_layers_used()           const { return (db_layers_used); }
 
     bool db_insert_deferred_instances();
+    bool db_set_deferred(CDl*);
+    bool db_insert_deferred(const CDl*);
     bool db_insert(CDo*);
     bool db_remove(CDo*);
     bool db_is_empty(const CDl*) const;
@@ -141,6 +143,9 @@ struct CDdb
     unsigned int db_objcnt() const;
     void db_bincnt(const CDl*, int) const;
 
+private:
+    CDtree *db_new_layer_head(CDl*);
+
 protected:
     CDtree *db_layer_heads;         // array of tree heads for layers
     unsigned short db_layers_used;  // length of array
@@ -123,6 +123,7 @@
 #define VA_OasWriteNoGCDcheck       "OasWriteNoGCDcheck"
 #define VA_OasWriteUseFastSort      "OasWriteUseFastSort"
 #define VA_OasWritePrptyMask        "OasWritePrptyMask"
+#define VA_OasWriteThreads          "OasWriteThreads"
 
 #endif
 
@@ -68,6 +68,7 @@
 #define VA_MergeMatchingNamed   "MergeMatchingNamed"
 #define VA_MergePhysContacts    "MergePhysContacts"
 #define VA_NoPermute            "NoPermute"
+#define VA_NoSignatureMatch     "NoSignatureMatch"
 #define VA_PinLayer             "PinLayer"
 #define VA_PinPurpose           "PinPurpose"
 #define VA_RLSolverDelta        "RLSolverDelta"
@@ -450,6 +451,7 @@ public:
     void invalidateGroups(bool = false);                            // export
     void destroyGroups(CDs*);                                       // export
     void clearGroups(CDs*);                                         // export
+    bool updateGroups(CDs*, CDo*, bool);                            // export
 
     // ext_menu.cc
     MenuBox *createMenu();
@@ -635,6 +637,8 @@ public:
     void setMergeMatchingNamed(bool b)  { ext_merge_named = b; }
     bool isNoPermute()                  { return (ext_no_permute); }
     void setNoPermute(bool b)           { ext_no_permute = b; }
+    bool isNoSignatureMatch()           { return (ext_no_sig_match); }
+    void setNoSignatureMatch(bool b)    { ext_no_sig_match = b; }
     bool isNoMeasure()                  { return (ext_no_measure); }
     void setNoMeasure(bool b)           { ext_no_measure = b; }
     bool isUseMeasurePrpty()            { return (ext_use_meas_prop); }
@@ -733,6 +737,7 @@ private:
     bool ext_find_old_term_labels;  // Hunt for old-style net labels.
     bool ext_merge_named;           // Merge groups with the same net name.
     bool ext_no_permute;            // Skip device permutations.
+    bool ext_no_sig_match;          // Skip signature net matching.
     bool ext_no_measure;            // Skip device measurements.
     bool ext_use_meas_prop;         // Disable measure results cache prpty.
     bool ext_no_read_meas_prop;     // Don't read measure results cache prpty.
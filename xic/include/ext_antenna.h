@@ -212,6 +212,100 @@ struct gate_t
     abl_t *bbs;             // gate area(s), multi components supported.
 };
 
+// Per-layer conductor area list element, used in net summaries.
+//
+struct ant_larea
+{
+    ant_larea(const CDl *ld, double a, ant_larea *n)
+        {
+            ldesc = ld;
+            area = a;
+            next = n;
+        }
+
+    static void destroy(ant_larea *al)
+        {
+            while (al) {
+                ant_larea *ax = al;
+                al = al->next;
+                delete ax;
+            }
+        }
+
+    // Add a to the area for ld, return the possibly new list head.
+    static ant_larea *add(ant_larea *al, const CDl *ld, double a)
+        {
+            for (ant_larea *ax = al; ax; ax = ax->next) {
+                if (ax->ldesc == ld) {
+                    ax->area += a;
+                    return (al);
+                }
+            }
+            return (new ant_larea(ld, a, al));
+        }
+
+    const CDl *ldesc;
+    double area;
+    ant_larea *next;
+};
+
+// Summary of a net of a cell, including the contribution from the
+// subcell hierarchy.
+//
+struct ant_gsum
+{
+    ant_gsum()
+        {
+            areas = 0;
+            gate_area = 0.0;
+            ngates = 0;
+        }
+
+    ~ant_gsum() { ant_larea::destroy(areas); }
+
+    void clear()
+        {
+            ant_larea::destroy(areas);
+            areas = 0;
+            gate_area = 0.0;
+            ngates = 0;
+        }
+
+    ant_larea *areas;       // conductor area by layer
+    double gate_area;       // total connected gate area
+    int ngates;             // number of gates connected
+    BBox refBB;             // a gate contact, cell coordinates
+};
+
+// Summary of a cell, the group summaries are kept only for groups
+// that connect to the parent.
+//
+struct ant_csum
+{
+    ant_csum(CDs *sd, int ng)
+        {
+            sdesc = sd;
+            gsums = new ant_gsum[ng > 0 ? ng : 1];
+            own = new ant_larea*[ng > 0 ? ng : 1];
+            memset(own, 0, (ng > 0 ? ng : 1)*sizeof(ant_larea*));
+            ngroups = ng;
+        }
+
+    ~ant_csum()
+        {
+            delete [] gsums;
+            for (int i = 0; i < ngroups; i++)
+                ant_larea::destroy(own[i]);
+            delete [] own;
+        }
+
+    CDs *sdesc;
+    ant_gsum *gsums;        // per-group summaries
+    ant_larea **own;        // per-group area of local geometry
+    int ngroups;
+    CDtf tf;                // transform to top, first placement
+};
+
 struct ant_pathfinder : public pathfinder, public cTfmStack
 {
     ant_pathfinder()
@@ -286,6 +380,7 @@ struct ant_pathfinder : public pathfinder, public cTfmStack
     bool find_antennae(CDs*);
     bool find_antennae_rc(CDs*, int) THROW_int;
     void process(const sDevContactInst*);
+    bool find_antennae_summ(CDs*);
 
     static bool read_file(int*, BBox*);
 
@@ -295,6 +390,10 @@ private:
     void recurse_up(int, int);
     void recurse_path(cGroupDesc*, int, int);
     void recurse_gnd_path(cGroupDesc*, int);
+    void summ_collect(CDs*, SymTab*, ant_csum***, int*, int*) THROW_int;
+    void summ_cell(ant_csum*, SymTab*) THROW_int;
+    void summ_report(const ant_gsum*, const ant_csum*, const CDc*,
+        int, int);
 
     CDs *pf_topcell;
     gate_t *pf_gates;
@@ -76,8 +76,8 @@ struct sDevComp
 
     // ext_ep_comp.cc
     bool set(sDevInst*);
-    bool set(sEinstList*);
-    int score(cGroupDesc*);
+    bool set(sEinstList*, bool = false);
+    int score(cGroupDesc*, bool = false);
     void associate(cGroupDesc*);
     bool is_parallel(const sEinstList*);
     bool is_mos_tpeq(cGroupDesc*, const sEinstList*);
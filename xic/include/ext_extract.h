@@ -1811,6 +1811,106 @@ private:
 };
 
 
+// Compressed-row connectivity tables, built from the group contact
+// lists and electrical node terminal lists.  Entries for group or
+// node i are in [start[i], start[i+1]) of the corresponding array,
+// in the same order as the lists.  The tables are a snapshot, used
+// by the association and LVS passes that make many traversals while
+// connectivity is unchanged, aside from bulk contacts resolved while
+// solving, which mark the tables for rebuilding.  The lists remain
+// the primary form and are used everywhere else, including the
+// netlist output, so the tables add to memory use rather than
+// replacing the lists.
+//
+struct sConnTab
+{
+    sConnTab()
+        {
+            ct_dstart = 0;
+            ct_dconts = 0;
+            ct_sstart = 0;
+            ct_sconts = 0;
+            ct_edstart = 0;
+            ct_edterms = 0;
+            ct_esstart = 0;
+            ct_esterms = 0;
+            ct_ngroups = 0;
+            ct_nnodes = 0;
+        }
+
+    ~sConnTab()
+        {
+            delete [] ct_dstart;
+            delete [] ct_dconts;
+            delete [] ct_sstart;
+            delete [] ct_sconts;
+            delete [] ct_edstart;
+            delete [] ct_edterms;
+            delete [] ct_esstart;
+            delete [] ct_esterms;
+        }
+
+    // Physical device contacts of group.
+    sDevContactInst *const *dev_contacts(int g, int *n) const
+        {
+            if (g < 0 || g >= ct_ngroups) {
+                *n = 0;
+                return (0);
+            }
+            *n = ct_dstart[g+1] - ct_dstart[g];
+            return (ct_dconts + ct_dstart[g]);
+        }
+
+    // Physical subcircuit contacts of group.
+    sSubcContactInst *const *subc_contacts(int g, int *n) const
+        {
+            if (g < 0 || g >= ct_ngroups) {
+                *n = 0;
+                return (0);
+            }
+            *n = ct_sstart[g+1] - ct_sstart[g];
+            return (ct_sconts + ct_sstart[g]);
+        }
+
+    // Electrical device terminals of node.
+    CDcterm *const *dev_terms(int node, int *n) const
+        {
+            if (node < 0 || node >= ct_nnodes) {
+                *n = 0;
+                return (0);
+            }
+            *n = ct_edstart[node+1] - ct_edstart[node];
+            return (ct_edterms + ct_edstart[node]);
+        }
+
+    // Electrical subcircuit terminals of node.
+    CDcterm *const *subc_terms(int node, int *n) const
+        {
+            if (node < 0 || node >= ct_nnodes) {
+                *n = 0;
+                return (0);
+            }
+            *n = ct_esstart[node+1] - ct_esstart[node];
+            return (ct_esterms + ct_esstart[node]);
+        }
+
+    // ext_conntab.cc
+    void build(const sGroup*, int, sElecNetList*);
+
+private:
+    int *ct_dstart;                 // Group device contact offsets.
+    sDevContactInst **ct_dconts;    // Device contacts.
+    int *ct_sstart;                 // Group subcircuit contact offsets.
+    sSubcContactInst **ct_sconts;   // Subcircuit contacts.
+    int *ct_edstart;                // Node device terminal offsets.
+    CDcterm **ct_edterms;           // Device terminals.
+    int *ct_esstart;                // Node subcircuit terminal offsets.
+    CDcterm **ct_esterms;           // Subcircuit terminals.
+    int ct_ngroups;
+    int ct_nnodes;
+};
+
+
 // These limits apply while associating.
 #define EXT_DEF_LVS_LOOP_MAX    10000
 #define EXT_DEF_LVS_ITER_MAX    200
@@ -1839,6 +1939,7 @@ public:
             gd_ignore_tab = 0;
             gd_sym_list = 0;
             gd_lvs_msgs = 0;
+            gd_conntab = 0;
             gd_asize = 0;
             gd_discreps = 0;
             gd_flags = 0;
@@ -1942,6 +2043,17 @@ public:
 // symmetry trials and without using hierarchy.
 #define EXT_GD_FIRST_PASS       0x20
 
+// Set when conductor objects have been added or removed since the
+// grouping was established, but the change is local enough that the
+// existing groups can be patched.  The area of change is kept in
+// gd_dirtyBB.
+#define EXT_GD_DIRTY            0x40
+
+// Set when a contact has been linked into a group since the
+// connectivity tables were built, the tables are rebuilt before they
+// are next read.
+#define EXT_GD_CONNTAB_STALE    0x80
+
     bool top_level()        const { return (gd_flags & EXT_GD_TOP_LEVEL); }
     void set_top_level(bool b)
         {
@@ -1976,6 +2088,7 @@ public:
     bool allow_errs()     const { return (gd_flags & EXT_GD_ALLOW_ERRS); }
     bool no_cont_brksym() const { return (gd_flags & EXT_GD_NO_CONT_BRKSYM); }
     bool first_pass()     const { return (gd_flags & EXT_GD_FIRST_PASS); }
+    bool dirty()          const { return (gd_flags & EXT_GD_DIRTY); }
 
     static int assoc_loop_max()             { return (gd_loop_max); }
     static void set_assoc_loop_max(int i)   { gd_loop_max = i; }
@@ -2006,6 +2119,21 @@ public:
     bool setup_dev_layer();
     bool update_measure_prpty();
 
+    // ext_conntab.cc
+    void build_conntab();
+    void clear_conntab();
+
+    // Return the connectivity tables, if in use, rebuilding them
+    // first if stale.  This must not be called from helper threads
+    // unless the tables are known to be current.
+    //
+    const sConnTab *conntab()
+        {
+            if (gd_conntab && (gd_flags & EXT_GD_CONNTAB_STALE))
+                build_conntab();
+            return (gd_conntab);
+        }
+
     // ext_duality.cc
     XIrt setup_duality_first_pass(SymTab*, int = 0);
     XIrt setup_duality(int = 0);
@@ -2041,6 +2169,8 @@ public:
 
     // ext_group.cc
     XIrt setup_groups();
+    XIrt update_groups();
+    bool mark_dirty(CDo*, bool);
     void clear_groups(bool = false);
     CDo *intersect_phony(BBox*);
     void dump(FILE*);
@@ -2110,6 +2240,9 @@ private:
     bool check_associations(int);
     bool break_symmetry() THROW_XIrt;
 
+    // ext_signature.cc
+    int signature_match();
+
     // ext_ep_comp.cc
     int ep_hier_comp(int, int);
     int ep_hier_comp_rc(int, int);
@@ -2149,7 +2282,9 @@ private:
     bool process_exclude();
     void alloc_groups(int);
     XIrt group_objects();
-    XIrt combine();
+    bool incr_ok(const CDo*) const;
+    void unlink_object(CDo*);
+    XIrt combine(const BBox* = 0);
     void reduce(int, int);
     void renumber_groups(int** = 0);
 
@@ -2243,6 +2378,8 @@ private:
     SymTab      *gd_ignore_tab;     // table of ignored insts
     ext_duality::sSymBrk *gd_sym_list; // context history for symmetry breaking
     stringlist  *gd_lvs_msgs;       // strings for LVS output
+    sConnTab    *gd_conntab;        // connectivity snapshot, transient
+    BBox        gd_dirtyBB;         // area changed since grouping
     int         gd_asize;           // size of array
     unsigned short gd_discreps;     // residual associaton discrepancy count
     unsigned short gd_flags;
@@ -59,6 +59,7 @@
 #define VA_FcPath               "FcPath"
 #define VA_FcPlaneBloat         "FcPlaneBloat"
 #define VA_FcUnits              "FcUnits"
+#define VA_FcWindow             "FcWindow"
 
 #define FC_LAYER_NAME           "FCAP"
 
@@ -66,6 +67,12 @@
 #define FC_MIN_TARG_PANELS      1e3
 #define FC_DEF_TARG_PANELS      1e4
 
+// Range of the windowed extraction coupling distance, microns, and
+// the default window core size in units of the coupling distance.
+#define FC_WINDOW_MIN           0.01
+#define FC_WINDOW_MAX           1e4
+#define FC_WINDOW_TILE_FACTOR   8
+
 // Default value and range of substrate bloat parameter.
 #define FC_PLANE_BLOAT_DEF      0.0
 #define FC_PLANE_BLOAT_MIN      0.0
@@ -212,6 +219,8 @@ struct fcLayout : public Ldb3d
     bool setup_refine(double);
     bool write_panels(FILE*, int, int, e_unit);
     fcGrpPtr *group_points() const;
+    int find_group(const fcLayout*, int) const;
+    double group_area(int, const BBox*) const;
 
     static void clear_dbg_zlist();
 
@@ -284,6 +293,7 @@ public:
     void doCmd(const char*, const char*);
     bool fcDump(const char*);
     void fcRun(const char*, const char*, const char*, bool = false);
+    bool fcRunWindowed(const char*);
     char *getFileName(const char*, int i = -1);
     const char *getUnitsString(const char*);
     int getUnitsIndex(const char*);
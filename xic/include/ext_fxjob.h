@@ -89,6 +89,7 @@ struct fxJob
     bool setup_fc_run(bool, bool);
     bool setup_fh_run(bool, bool);
     bool run(bool, bool);
+    static bool run_concurrent(fxJob**, int, int);
     void fc_post_process();
     void fh_post_process();
     void pid_string(sLstr&);
@@ -138,8 +139,9 @@ struct fxJob
             return (0);
         }
 
-private:
     static char *fc_get_matrix(const char*, int*, float***, double*, char***);
+
+private:
     static const char *fh_get_matrix(FILE*, zmat_t**);
 
     fxJobMode j_mode;           // program to run
@@ -182,6 +182,7 @@ public:
     virtual void invalidateGroups(bool = false) = 0;
     virtual void destroyGroups(CDs*) = 0;
     virtual void clearGroups(CDs*) = 0;
+    virtual bool updateGroups(CDs*, CDo*, bool) = 0;
 
     // ext_menu.cc
     virtual bool setupCommand(MenuEnt*, bool*, bool*) = 0;
@@ -252,6 +253,7 @@ class cExtIfStubs : public cExtIf
     void invalidateGroups(bool) { }
     void destroyGroups(CDs*) { }
     void clearGroups(CDs*) { }
+    bool updateGroups(CDs*, CDo*, bool) { return (false); }
 
     bool setupCommand(MenuEnt*, bool*, bool*) { return (false); }
 
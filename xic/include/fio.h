@@ -398,6 +398,9 @@ enum CgdType { CGDmemory, CGDfile, CGDremote };
 #define OAS_PRPMSK_XIC_LBL 0x2
 #define OAS_PRPMSK_ALL     0x4
 
+// Upper limit for cFIO::OasWriteThreads.
+#define OAS_MAX_THREADS    32
+
 // Number of bounding box registers.
 #define FIO_NUM_BB_STORE 8
 
@@ -916,6 +919,9 @@ public:
     int OasWritePrptyMask()             { return (fioOasWritePrptyMask); }
     void SetOasWritePrptyMask(int m)    { fioOasWritePrptyMask = m; }
 
+    int OasWriteThreads()               { return (fioOasWriteThreads); }
+    void SetOasWriteThreads(int n)      { fioOasWriteThreads = n; }
+
     bool IsWriteMacroProps()            { return (fioWriteMacroProps); }
     void SetWriteMacroProps(bool b)     { fioWriteMacroProps = b; }
 
@@ -1253,6 +1259,10 @@ private:
     unsigned char fioOasWritePrptyMask;
         // Omit certain or all properties from OASIS output.
 
+    unsigned char fioOasWriteThreads;
+        // Number of threads used to compress CBLOCKs in OASIS
+        // output, zero to compress inline.
+
     bool fioWriteMacroProps;
         // Write redundant and obsolete P_MACRO properties for
         // backward compatibility (to pre-4.5.6).
@@ -931,6 +931,7 @@ private:
 class cCGD;
 struct cgd_layer_mux;
 struct oas_cache;
+struct oas_zpipe;
 
 // Class for generating OASIS output
 //
@@ -996,6 +997,7 @@ private:
 
     bool begin_compression(const char*);
     bool end_compression();
+    bool flush_zpipe();
 
     bool setup_properties(CDp*);
     void set_layer_dt(int, int, int* = 0, int* = 0);
@@ -1036,6 +1038,7 @@ private:
     oas_modal   *out_modal;                 // modal variables
     zio_stream  *out_zfile;                 // zlib file pointer
     oas_cache   *out_cache;                 // repetition cache
+    oas_zpipe   *out_zpipe;                 // threaded CBLOCK compression
     unsigned char *out_compr_buf;           // buffer for compression
     const char  *out_rep_args;              // repetition cache args
     int         out_undef_count;            // unmapped layer indices
@@ -1049,6 +1052,7 @@ private:
     bool        out_faster_sort;            // use quicksort exclusively
     bool        out_no_gcd_check;           // skip gcd check in repetitions
     unsigned char out_use_compression;      // compression strategy
+    unsigned char out_zthreads;             // compression thread count
     bool        out_compressing;            // true when compressing
     bool        out_use_tables;             // use string tables
     unsigned char out_validation_type;      // validation scheme
@@ -62,6 +62,14 @@
 #define MIN_RoundFlashSides     8
 #define MAX_RoundFlashSides     256
 
+// Zlist boolean engine selection.
+//  ZSoff       Use the Ylist clipping functions (the default).
+//  ZSon        Use the plane-sweep engine.
+//  ZScheck     Use the Ylist functions, and compare with the sweep
+//              engine, logging differences.
+//
+enum ZSmode { ZSoff, ZSon, ZScheck };
+
 struct Point;
 struct BBox;
 struct Zlist;
@@ -225,6 +233,11 @@ public:
     bool useSclFuncs()                  { return (geoUseSclFuncs); }
     void setUseSclFuncs(bool b)         { geoUseSclFuncs = b; }
 
+    // Select the plane-sweep engine for the Zlist boolean operations,
+    // see geo_zsweep.cc.
+    ZSmode zlSweepMode()                { return (geoZlSweepMode); }
+    void setZlSweepMode(ZSmode m)       { geoZlSweepMode = m; }
+
     const sCurTx *curTx()               { return (&geoCurTform); }
     void setCurTx(sCurTx &t)            { geoCurTform = t; }
 
@@ -233,6 +246,7 @@ private:
     int geoElecRoundSides;  // Sides per 360 degrees for elec round objects
     int geoPhysRoundSides;  // Sides per 360 degrees for phys round objects
     bool geoUseSclFuncs;    // Use new scanline geometry functions.
+    ZSmode geoZlSweepMode;  // Zlist boolean engine selection.
     sCurTx geoCurTform;     // "Current Transform" parameters
 
     static cGEO *instancePtr;
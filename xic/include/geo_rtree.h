@@ -551,6 +551,7 @@ struct RTree
 
     bool set_deferred();
     bool unset_deferred();
+    bool load(RTelem**, unsigned int);
     bool remove(RTelem*);
     RTelem *to_list();
     void test(RTelem* = 0) const;
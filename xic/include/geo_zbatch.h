@@ -0,0 +1,85 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#ifndef GEO_ZBATCH_H
+#define GEO_ZBATCH_H
+
+#include "geo_zoid.h"
+
+
+struct Zlist;
+
+// Lanes tested per call of the extent kernel.
+#define ZB_LANES 8
+
+// A structure-of-arrays copy of the extents of a zoid list, for
+// testing one zoid against many.  The intersect method applies the
+// extent tests that are done first in Zoid::intersect (and by
+// ovlchk_t) to ZB_LANES zoids at once, using AVX2 or SSE2 when
+// available, with a scalar fallback.  Only the candidates get the
+// full, branchy test.  This pays off when the list is tested more
+// than once, so that building the arrays is amortized.
+//
+// The zoids are referenced, not copied, so the list must outlive
+// the Zbatch.
+//
+struct Zbatch
+{
+    Zbatch(const Zlist*);
+    ~Zbatch();
+
+    int num()                   const { return (zb_num); }
+    const Zoid *zoid(int i)     const { return (zb_zoids[i]); }
+
+    bool intersect(const Zoid*, bool) const;
+
+private:
+    int *zb_yl;                 // Zoid bottoms.
+    int *zb_yu;                 // Zoid tops.
+    int *zb_xmin;               // Zoid minleft.
+    int *zb_xmax;               // Zoid maxright.
+    const Zoid **zb_zoids;      // The zoids.
+    int zb_num;                 // Number of zoids.
+    int zb_size;                // Array size, multiple of ZB_LANES.
+    BBox zb_BB;                 // Overall extent.
+};
+
+#endif
+
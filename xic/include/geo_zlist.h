@@ -99,6 +99,17 @@ enum BLCtype { BLCclip, BLCflat, BLCextend, BLCextend1,
 // #define THROW_XIrt throw(XIrt)
 #define THROW_XIrt
 
+// Operations for Zlist::sweep.  The first list is A, the second is B,
+// the result is the area where:
+//  ZSor            A or B
+//  ZSand           A and B
+//  ZSandnot        A and not B
+//  ZSxor           A or B but not both
+//  ZSself_and      two or more zoids of A overlap, B is ignored
+//  ZSself_andnot   exactly one zoid of A, B is ignored
+//
+enum ZSop { ZSor, ZSand, ZSandnot, ZSxor, ZSself_and, ZSself_andnot };
+
 // List of zoids
 //
 struct Zlist
@@ -162,14 +173,7 @@ struct Zlist
             return (false);
         }
 
-    static bool intersect(const Zlist *thiszl, const Zlist *zl, bool touchok)
-        {
-            for (const Zlist *z = thiszl; z; z = z->next) {
-                if (Zlist::intersect(zl, &z->Z, touchok))
-                    return (true);
-            }
-            return (false);
-        }
+    static bool intersect(const Zlist*, const Zlist*, bool);
 
     static int length(const Zlist *thiszl)
         {
@@ -267,6 +271,8 @@ struct Zlist
     static void reset_join_params();
 
     // geo_zlfuncs.cc
+    static void sweep_check(const Zlist*, const Zlist*, ZSop, const Zlist*,
+        const char*);
     static bool zl_intersect(Zlist*, Zlist*, bool);
     static XIrt zl_or(Zlist**, Zlist*);
     static XIrt zl_and(Zlist**);
@@ -281,6 +287,9 @@ struct Zlist
     static XIrt zl_xor(Zlist**, Zlist*);
     static XIrt zl_bloat(Zlist**, int, int);
 
+    // geo_zsweep.cc
+    static Zlist *sweep(const Zlist*, const Zlist*, ZSop) THROW_XIrt;
+
     Zlist *next;
     Zoid Z;
 
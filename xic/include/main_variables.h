@@ -88,6 +88,7 @@
 #define VA_PCellKeepSubMasters      "PCellKeepSubMasters"
 #define VA_PCellListSubMasters      "PCellListSubMasters"
 #define VA_PCellScriptPath          "PCellScriptPath"
+#define VA_PCellCacheDir            "PCellCacheDir"
 #define VA_PCellShowAllWarnings     "PCellShowAllWarnings"
 
 // Standard Vias
@@ -118,6 +118,11 @@ public:
     char *md5Digest(const char*);
     void dump(FILE*);
 
+    // pcell_cache.cc
+    char *cacheKey(const CDs*, const char*);
+    bool readCache(const char*, CDs*, const char*, const char*);
+    bool writeCache(const char*, const CDs*);
+
 private:
     // The hash tables hash the lib/cell/view names as a token formatted
     // as a "dbname" with PCellDesc::mk_dbname.  For Xic native pcells,
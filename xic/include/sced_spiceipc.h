@@ -87,6 +87,10 @@ private:
     bool runnit(const char*);
     bool write_msg(const char*, int);
     bool isready(int, int, bool=false);
+    int read_byte(int, char*);
+    int read_bytes(int, char*, int);
+    bool read_pending(int);
+    bool read_data(int, const char*, unsigned char**);
     bool read_msg(int, int, char**, bool = false, unsigned char** = 0);
     bool read_cmd_return(char**,  char**, unsigned char**);
     char *read_stdout(int);
@@ -158,6 +162,12 @@ private:
     bool ipc_no_toolbar;    // don't show WRspice toolbar
     int ipc_msg_pgid;       // backup group ids for async
     int ipc_stdout_pgid;
+
+    // Input buffer for the message socket.
+    int ipc_rbuf_cnt;       // bytes in buffer
+    int ipc_rbuf_ptr;       // read offset
+    bool ipc_shm_ok;        // WRspice supports evalshm
+    char ipc_rbuf[4096];
 };
 
 #endif
@@ -926,6 +926,60 @@ CDs::checkInstances()
 }
 
 
+// Test the objects on ld for duplicates, as is done for each new
+// object while reading.  This is for a layer that was built in
+// deferred mode, where objects can't be tested as they are added. 
+// Coincident objects are adjacent in database order, so each
+// duplicate after the first is found once.
+//
+void
+CDs::checkCoinc(const CDl *ld)
+{
+    if (!CD()->IsReading() || CD()->DupCheckMode() == cCD::DupNoTest)
+        return;
+    const char *what = "kept";
+    if (CD()->DupCheckMode() == cCD::DupRemove)
+        what = "removed";
+
+    CDol *dups = 0;
+    CDg gdesc;
+    gdesc.init_gen(this, ld);
+    CDo *odesc;
+    while ((odesc = gdesc.next()) != 0) {
+        if (!db_check_coinc(odesc))
+            continue;
+        if (CD()->DupCheckMode() == cCD::DupRemove)
+            dups = new CDol(odesc, dups);
+
+        const char *type = "box";
+        if (odesc->type() == CDPOLYGON)
+            type = "polygon";
+        else if (odesc->type() == CDWIRE)
+            type = "wire";
+        else if (odesc->type() == CDLABEL)
+            type = "label";
+        int c = CD()->CheckCoincErrs();
+        if (c < 0) {
+            CD()->ifPrintCvLog(IFLOG_WARN, "coincident %s (%s) [%s %d,%d %s].",
+                type, what, Tstring(cellname()), odesc->oBB().left,
+                odesc->oBB().top, odesc->ldesc()->name());
+        }
+        else if (c == 0) {
+            CD()->ifPrintCvLog(IFLOG_WARN,
+                "more coincident objects (%s) [%s].", what,
+                Tstring(cellname()));
+        }
+    }
+    while (dups) {
+        CDol *ox = dups;
+        dups = dups->next;
+        if (!unlink(ox->odesc, false))
+            CD()->ifPrintCvLog(IFLOG_WARN, "%s", Errs()->get_error());
+        delete ox;
+    }
+}
+
+
 // Return true if there is an underlying connection point.
 //
 bool
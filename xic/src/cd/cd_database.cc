@@ -153,6 +153,43 @@ namespace {
 }
 
 
+// Put the database for ld into deferred mode, see
+// RTree::set_deferred.  Objects subsequently added to ld are saved
+// in a list, and the tree is built in a single pass when
+// db_insert_deferred is called, which must be done before the layer
+// is accessed in any other way.  This is much faster than inserting
+// objects one at a time when many objects are being added to an
+// empty layer.  False is returned if the layer is not empty, in
+// which case objects will be inserted normally.
+//
+bool
+CDdb::db_set_deferred(CDl *ld)
+{
+    if (!ld)
+        return (false);
+    pthread_mutex_lock(&db_mtx);
+    CDtree *l = db_find_layer_head(ld);
+    if (!l)
+        l = db_new_layer_head(ld);
+    bool ret = l->set_deferred();
+    pthread_mutex_unlock(&db_mtx);
+    return (ret);
+}
+
+
+// Build the database for ld if it is in deferred mode.
+//
+bool
+CDdb::db_insert_deferred(const CDl *ld)
+{
+    pthread_mutex_lock(&db_mtx);
+    CDtree *l = db_find_layer_head(ld);
+    bool ret = l ? l->unset_deferred() : true;
+    pthread_mutex_unlock(&db_mtx);
+    return (ret);
+}
+
+
 // Public function to insert odesc into the database, true is returned
 // on success.
 //
@@ -164,30 +201,7 @@ CDdb::db_insert(CDo *odesc)
     pthread_mutex_lock(&db_mtx);
     CDtree *l = db_find_layer_head(odesc->ldesc());
     if (!l) {
-        if (!db_layer_heads) {
-            db_layer_heads = new CDtree[1];
-            db_layer_heads->set_ldesc(odesc->ldesc());
-            db_layers_used = 1;
-            l = db_layer_heads;
-        }
-        else {
-            CDtree *lt = new CDtree[db_layers_used + 1];
-            unsigned int cnt = 0;
-            for ( ; cnt < db_layers_used; cnt++) {
-                if (db_layer_heads[cnt].ldesc() < odesc->ldesc())
-                    lt[cnt] = db_layer_heads[cnt];
-                else
-                    break;
-            }
-            lt[cnt].set_ldesc(odesc->ldesc());
-            l = lt + cnt;
-            for ( ; cnt < db_layers_used; cnt++)
-                lt[cnt+1] = db_layer_heads[cnt];
-            db_layers_used++;
-
-            delete [] db_layer_heads;
-            db_layer_heads = lt;
-        }
+        l = db_new_layer_head(odesc->ldesc());
 
         // If CD()->SetDeferInst(true) is in effect, set the deferred
         // flag in the new database created for the instance layer. 
@@ -206,6 +220,38 @@ CDdb::db_insert(CDo *odesc)
 }
 
 
+// Private function to create and return a new empty tree head for
+// ld, keeping the array sorted.  The caller should hold the lock.
+//
+CDtree *
+CDdb::db_new_layer_head(CDl *ld)
+{
+    if (!db_layer_heads) {
+        db_layer_heads = new CDtree[1];
+        db_layer_heads->set_ldesc(ld);
+        db_layers_used = 1;
+        return (db_layer_heads);
+    }
+    CDtree *lt = new CDtree[db_layers_used + 1];
+    unsigned int cnt = 0;
+    for ( ; cnt < db_layers_used; cnt++) {
+        if (db_layer_heads[cnt].ldesc() < ld)
+            lt[cnt] = db_layer_heads[cnt];
+        else
+            break;
+    }
+    lt[cnt].set_ldesc(ld);
+    CDtree *l = lt + cnt;
+    for ( ; cnt < db_layers_used; cnt++)
+        lt[cnt+1] = db_layer_heads[cnt];
+    db_layers_used++;
+
+    delete [] db_layer_heads;
+    db_layer_heads = lt;
+    return (l);
+}
+
+
 // Public function to remove odesc from the database.  True is returned
 // on success.
 //
@@ -372,9 +418,16 @@ CDdb::db_clear()
 // makes use of the ordering which causes od to be added ahead of any
 // existing duplicate.  This is NOT a general purpose function!
 //
+// If the layer is in deferred mode there is no database to check
+// yet, false is returned and CDs::checkCoinc should be called after
+// the layer is built.
+//
 bool
 CDdb::db_check_coinc(CDo *od)
 {
+    CDtree *l = db_find_layer_head(od->ldesc());
+    if (l && l->is_deferred())
+        return (false);
     for (CDo *o = od->db_next(); o; o = o->db_next()) {
         if (od->oBB().top != o->oBB().top || od->oBB().left != o->oBB().left)
             break;
@@ -421,8 +474,12 @@ CDdb::db_rebuild(bool(*process)(CDo*, CDdb*, void*), void *arg)
     CDtree *ttmp = db_layer_heads;
     db_layer_heads = 0;
 
+    // The objects are put back in deferred mode, so that each tree
+    // is rebuilt by packing rather than by reinsertion.
+
     for (unsigned int i = 0; i < ntmp; i++) {
         RTelem *list = ttmp[i].to_list();
+        ttmp[i].set_deferred();
         while (list) {
             RTelem *ln = 0;
             list = RTelem::list_next(list, &ln);
@@ -430,6 +487,7 @@ CDdb::db_rebuild(bool(*process)(CDo*, CDdb*, void*), void *arg)
                 ttmp[i].insert(list);
             list = ln;
         }
+        ttmp[i].unset_deferred();
     }
     db_layer_heads = ttmp;
     db_layers_used = ntmp;
@@ -757,6 +815,9 @@ namespace {
     // I haven't a clue why this is needed, but without it there is
     // geometric corruption.  For some reason it is necessary to lock
     // sPFel::advance and sPFel::init at the top level.
+    //
+    // Since the cause is unknown, the lock is taken even when the
+    // hierarchy is not being modified.
 
     pthread_mutex_t pf_mtx = PTHREAD_MUTEX_INITIALIZER;
 }
@@ -167,6 +167,20 @@ namespace {
         return (true);
     }
 
+    bool
+    evZlSweep(const char *vstring, bool set)
+    {
+        // Use the sweep engine for the Zlist boolean functions, or
+        // with "check", compare its results with the Ylist functions.
+        if (!set)
+            GEO()->setZlSweepMode(ZSoff);
+        else if (vstring && lstring::cieq(vstring, "check"))
+            GEO()->setZlSweepMode(ZScheck);
+        else
+            GEO()->setZlSweepMode(ZSon);
+        return (true);
+    }
+
     bool
     evNoFixRot45(const char*, bool set)
     {
@@ -681,6 +695,7 @@ cEdit::setupVariables()
     vsetup(VA_NoMergePolys,         B,  evNoMergePolys);
     vsetup(VA_AskSaveNative,        B,  evAskSaveNative);
     vsetup("scldebug",              B,  evSafeClipping);  // for debugging
+    vsetup("zlsweep",               S,  evZlSweep);       // for debugging
     vsetup(VA_NoFixRot45,           B,  evNoFixRot45);
 
     // Side Menu Commands
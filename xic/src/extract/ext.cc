@@ -111,6 +111,7 @@ cExt::cExt()
     ext_find_old_term_labels    = false;
     ext_merge_named             = false;
     ext_no_permute              = false;
+    ext_no_sig_match            = false;
     ext_no_measure              = false;
     ext_use_meas_prop           = false;
     ext_no_read_meas_prop       = false;
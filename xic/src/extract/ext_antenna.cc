@@ -48,6 +48,7 @@
 #include "geo_ylist.h"
 #include "promptline.h"
 #include "miscutil/timer.h"
+#include "miscutil/threadpool.h"
 
 
 cAntParams *cAntParams::instancePtr = 0;
@@ -661,3 +662,408 @@ ant_pathfinder::recurse_gnd_path(cGroupDesc *gdesc, int depth)
     }
 }
 
+
+
+//-----------------------------------------------------------------------------
+// Summary-based antenna check.
+//
+// Rather than following each gate net through the hierarchy and
+// merging a flat copy of its geometry, each master cell is processed
+// once, bottom-up.  For each group of a cell, the per-layer conductor
+// area and gate area are obtained from the local geometry and
+// devices, plus the summaries of the connected subcell groups.  Only
+// the summaries of groups that connect to the parent are retained,
+// other nets are complete and are reported when the cell is
+// processed.  The local geometry areas of the masters are independent
+// and are computed in the helper threads, if any.
+//
+// Differences from the path-based check:  a net internal to a master
+// cell is reported once, at the location of the first placement
+// found, and not for every instance.  Geometry overlapping between
+// cell levels is counted in each level, which can only increase the
+// area ratios.
+
+namespace {
+    // Return the area of the MOS gate contact, including parallel
+    // components, in cell coordinates.
+    //
+    double gate_area(const sDevContactInst *c)
+    {
+        const sDevInst *di = c->dev();
+        if (!di)
+            return (0.0);
+        if (di->mstatus() != MS_PARALLEL)
+            return (c->fillfct() * c->cBB()->area());
+        double a = 0.0;
+        for (di = di->multi_devs(); di; di = di->next()) {
+            for (const sDevContactInst *cc = di->contacts(); cc;
+                    cc = cc->next()) {
+                if (cc->cont_name() == AP()->gate_name()) {
+                    a += cc->fillfct() * cc->cBB()->area();
+                    break;
+                }
+            }
+        }
+        return (a);
+    }
+
+
+    // Compute the conductor area by layer of each group of the
+    // master cell, from the cell's own geometry.  This only reads the
+    // database, it is run in the helper threads.
+    //
+    int own_areas_proc(sTPthreadData*, void *arg)
+    {
+        ant_csum *cs = (ant_csum*)arg;
+        cGroupDesc *gdesc = cs->sdesc->groups();
+        if (!gdesc)
+            return (0);
+        for (int i = 0; i < cs->ngroups; i++) {
+            const sGroup *g = gdesc->group_for(i);
+            sGroupObjs *gobj = g ? g->net() : 0;
+            if (!gobj)
+                continue;
+            SymTab ltab(false, false);
+            for (CDol *o = gobj->objlist(); o; o = o->next) {
+                Zlist *zl = o->odesc->toZlist();
+                if (!zl)
+                    continue;
+                SymTabEnt *h =
+                    SymTab::get_ent(&ltab, (uintptr_t)o->odesc->ldesc());
+                if (!h) {
+                    ltab.add((uintptr_t)o->odesc->ldesc(), zl, false);
+                    continue;
+                }
+                Zlist *zx = (Zlist*)h->stData;
+                h->stData = zl;
+                while (zl->next)
+                    zl = zl->next;
+                zl->next = zx;
+            }
+            SymTabGen gen(&ltab);
+            SymTabEnt *h;
+            while ((h = gen.next()) != 0) {
+                Zlist *zl = Zlist::repartition_ni((Zlist*)h->stData);
+                cs->own[i] = ant_larea::add(cs->own[i], (CDl*)h->stTag,
+                    Zlist::area(zl));
+                Zlist::destroy(zl);
+                h->stData = 0;
+            }
+        }
+        return (0);
+    }
+
+
+    // True if the group of the master cell may be connected to in
+    // the parent.  The ground group is always connected.
+    //
+    bool is_port(cGroupDesc *gdesc, int grp)
+    {
+        if (grp == 0)
+            return (true);
+        const sGroup *g = gdesc->group_for(grp);
+        return (g && (g->cell_connection() || g->termlist()));
+    }
+}
+
+
+bool
+ant_pathfinder::find_antennae_summ(CDs *sdesc)
+{
+    pf_topcell = sdesc;
+    clear();
+    if (!sdesc) {
+        Errs()->add_error("find_antennae_summ: null cell pointer!");
+        return (false);
+    }
+    if (!AP()->gate_name()) {
+        Errs()->add_error("find_antennae_summ: null gate contact name!");
+        return (false);
+    }
+    if (!AP()->mos_names()) {
+        Errs()->add_error("find_antennae_summ: null MOS device name list!");
+        return (false);
+    }
+
+    SymTab tab(false, false);
+    ant_csum **cells = 0;
+    int ncells = 0, szcells = 0;
+    bool ret = true;
+    try {
+        TPush();
+        TIdentity();
+        summ_collect(sdesc, &tab, &cells, &ncells, &szcells);
+        TPop();
+
+        int nth = DSP()->NumThreads();
+        if (nth > ncells - 1)
+            nth = ncells - 1;
+        if (nth > 0) {
+            cThreadPool pool(nth);
+            for (int i = 0; i < ncells; i++)
+                pool.submit(own_areas_proc, cells[i]);
+            pool.run(0);
+        }
+        else {
+            for (int i = 0; i < ncells; i++) {
+                if (checkInterrupt())
+                    throw (1);
+                own_areas_proc(0, cells[i]);
+            }
+        }
+
+        // The list is in bottom-up order, the top cell is last.
+        for (int i = 0; i < ncells; i++)
+            summ_cell(cells[i], &tab);
+    }
+    catch (int) {
+        Errs()->add_error("find_antennae_summ: interrupted!");
+        ret = false;
+    }
+    for (int i = 0; i < ncells; i++)
+        delete cells[i];
+    delete [] cells;
+    return (ret);
+}
+
+
+// Add the master cells of the hierarchy to the table, and to the
+// list in bottom-up order.  The transform to the top cell of the
+// first placement found is saved with each master.
+//
+void
+ant_pathfinder::summ_collect(CDs *sdesc, SymTab *tab, ant_csum ***plist,
+    int *pcnt, int *psz) THROW_int
+{
+    if (!sdesc)
+        return;
+    if (SymTab::get(tab, (uintptr_t)sdesc) != ST_NIL)
+        return;
+    cGroupDesc *gdesc = sdesc->groups();
+    if (!gdesc)
+        return;
+    if (checkInterrupt())
+        throw (1);
+
+    ant_csum *cs = new ant_csum(sdesc, gdesc->num_groups());
+    TCurrent(&cs->tf);
+    tab->add((uintptr_t)sdesc, cs, false);
+
+    for (const sSubcList *sl = gdesc->subckts(); sl; sl = sl->next()) {
+        sSubcInst *s = sl->subs();
+        if (!s)
+            continue;
+        CDc *cdesc = s->cdesc();
+        if (TFull())
+            continue;
+        TPush();
+        TApplyTransform(cdesc);
+        TPremultiply();
+        CDap ap(cdesc);
+        TTransMult(s->ix()*ap.dx, s->iy()*ap.dy);
+        try {
+            summ_collect(cdesc->masterCell(true), tab, plist, pcnt, psz);
+        }
+        catch (int) {
+            TPop();
+            throw;
+        }
+        TPop();
+    }
+
+    if (*pcnt >= *psz) {
+        int nsz = *psz ? 2*(*psz) : 64;
+        ant_csum **tmp = new ant_csum*[nsz];
+        if (*pcnt)
+            memcpy(tmp, *plist, *pcnt*sizeof(ant_csum*));
+        delete [] *plist;
+        *plist = tmp;
+        *psz = nsz;
+    }
+    (*plist)[(*pcnt)++] = cs;
+}
+
+
+// Compute the group summaries of the cell, which is called after
+// all subcells have been processed.  Nets that are complete in this
+// cell are reported, and their summaries freed.
+//
+void
+ant_pathfinder::summ_cell(ant_csum *cs, SymTab *tab) THROW_int
+{
+    cGroupDesc *gdesc = cs->sdesc->groups();
+    if (!gdesc)
+        return;
+    if (checkInterrupt())
+        throw (1);
+
+    for (int i = 0; i < cs->ngroups; i++) {
+        ant_gsum *gs = cs->gsums + i;
+        gs->areas = cs->own[i];
+        cs->own[i] = 0;
+        const sGroup *g = gdesc->group_for(i);
+        if (!g)
+            continue;
+        for (sDevContactList *c = g->device_contacts(); c; c = c->next()) {
+            if (AP()->is_mos_gate(c->contact())) {
+                if (!gs->ngates)
+                    gs->refBB = *c->contact()->cBB();
+                gs->gate_area += gate_area(c->contact());
+                gs->ngates++;
+            }
+        }
+    }
+
+    bool *seen = 0;
+    int nseen = 0;
+    for (const sSubcList *sl = gdesc->subckts(); sl; sl = sl->next()) {
+        for (sSubcInst *s = sl->subs(); s; s = s->next()) {
+            CDc *cdesc = s->cdesc();
+            ant_csum *ccs = (ant_csum*)SymTab::get(tab,
+                (uintptr_t)cdesc->masterCell(true));
+            if (ccs == (ant_csum*)ST_NIL)
+                continue;
+            if (nseen < ccs->ngroups) {
+                delete [] seen;
+                nseen = ccs->ngroups;
+                seen = new bool[nseen];
+            }
+            memset(seen, 0, ccs->ngroups*sizeof(bool));
+
+            // The transform to the parent, for the reference box.
+            TPush();
+            TIdentity();
+            TApplyTransform(cdesc);
+            TPremultiply();
+            CDap ap(cdesc);
+            TTransMult(s->ix()*ap.dx, s->iy()*ap.dy);
+
+            for (int pass = 0; pass < 2; pass++) {
+                sSubcContactInst *c = s->contacts();
+                for (;;) {
+                    int sg, pg;
+                    if (pass == 0) {
+                        // Ground connects implicitly.
+                        sg = 0;
+                        pg = 0;
+                    }
+                    else {
+                        if (!c)
+                            break;
+                        sg = c->subc_group();
+                        pg = c->parent_group();
+                        c = c->next();
+                    }
+                    if (sg < 0 || sg >= ccs->ngroups || seen[sg] ||
+                            pg < 0 || pg >= cs->ngroups) {
+                        if (pass == 0)
+                            break;
+                        continue;
+                    }
+                    seen[sg] = true;
+                    const ant_gsum *src = ccs->gsums + sg;
+                    ant_gsum *dst = cs->gsums + pg;
+                    for (ant_larea *a = src->areas; a; a = a->next)
+                        dst->areas = ant_larea::add(dst->areas, a->ldesc,
+                            a->area);
+                    if (src->ngates) {
+                        if (!dst->ngates) {
+                            dst->refBB = src->refBB;
+                            TBB(&dst->refBB, 0);
+                        }
+                        dst->gate_area += src->gate_area;
+                        dst->ngates += src->ngates;
+                    }
+                    if (pass == 0)
+                        break;
+                }
+            }
+            TPop();
+
+            // Subcell nets that may connect, but do not connect in
+            // this instance, are complete.
+            for (int i = 1; i < ccs->ngroups; i++) {
+                if (!seen[i] && ccs->gsums[i].ngates)
+                    summ_report(ccs->gsums + i, cs, cdesc, s->ix(), s->iy());
+            }
+        }
+    }
+    delete [] seen;
+
+    bool top = (cs->sdesc == pf_topcell);
+    for (int i = 0; i < cs->ngroups; i++) {
+        if (!top && is_port(gdesc, i))
+            continue;
+        if (cs->gsums[i].ngates)
+            summ_report(cs->gsums + i, cs, 0, 0, 0);
+        cs->gsums[i].clear();
+    }
+}
+
+
+// Print a net summary.  The net belongs to cs if cdesc is null,
+// otherwise to the master of cdesc, instantiated in cs.
+//
+void
+ant_pathfinder::summ_report(const ant_gsum *gs, const ant_csum *cs,
+    const CDc *cdesc, int ix, int iy)
+{
+    BBox cBB(gs->refBB);
+    TPush();
+    TLoadCurrent(&cs->tf);
+    if (cdesc) {
+        TApplyTransform(cdesc);
+        TPremultiply();
+        CDap ap(cdesc);
+        TTransMult(ix*ap.dx, iy*ap.dy);
+    }
+    TBB(&cBB, 0);
+    TPop();
+
+    int ndgt = CD()->numDigits();
+    sLstr lstr;
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+        "net %-7d (ref %.*f,%.*f %.*f,%.*f)\n", pf_netcnt++,
+        ndgt, MICRONS(cBB.left), ndgt, MICRONS(cBB.bottom),
+        ndgt, MICRONS(cBB.right), ndgt, MICRONS(cBB.top));
+    lstr.add(buf);
+    snprintf(buf, sizeof(buf), "  cell=%s gates=%d\n",
+        Tstring(cdesc ? cdesc->cellname() : cs->sdesc->cellname()),
+        gs->ngates);
+    lstr.add(buf);
+    double gate_area = gs->gate_area;
+    snprintf(buf, sizeof(buf), "  total_gate_area=%.6e\n", gate_area);
+    lstr.add(buf);
+
+    bool show_me = (!specs() && limit() == 0.0);
+    double tot_net_area = 0.0;
+    for (const ant_larea *a = gs->areas; a; a = a->next) {
+        const char *lname = a->ldesc->name();
+        double lratio = a->area/gate_area;
+        snprintf(buf, sizeof(buf),
+            "  layer=%s area=%.6e norm_to_gate=%.6e\n", lname, a->area,
+            lratio);
+        lstr.add(buf);
+        tot_net_area += a->area;
+        for (const alimit_t *lim = specs(); lim; lim = lim->next) {
+            if (!show_me && !strcmp(lim->al_lname, lname)) {
+                if (lim->al_max_ratio > 0 && lratio > lim->al_max_ratio)
+                    show_me = true;
+                break;
+            }
+        }
+    }
+    double ratio = tot_net_area/gate_area;
+    snprintf(buf, sizeof(buf),
+        "  tot_net_area=%.6e norm_to_gate=%.6e\n", tot_net_area, ratio);
+    lstr.add(buf);
+    if (!show_me && limit() > 0 && ratio > limit())
+        show_me = true;
+    if (show_me) {
+        if (pf_outfp)
+            fputs(lstr.string(), pf_outfp);
+        else
+            fputs(lstr.string(), stdout);
+    }
+}
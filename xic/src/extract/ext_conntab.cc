@@ -0,0 +1,157 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "main.h"
+#include "ext.h"
+#include "ext_extract.h"
+#include "ext_nets.h"
+
+
+/*========================================================================*
+ *
+ *  Compressed connectivity tables
+ *
+ *========================================================================*/
+
+// Fill in the tables from the first ngrps groups, and the electrical
+// node list, if any.  Terminals whose instance has no master are
+// omitted, as in the list traversals.
+//
+void
+sConnTab::build(const sGroup *groups, int ngrps, sElecNetList *etlist)
+{
+    if (ngrps < 0)
+        ngrps = 0;
+    ct_ngroups = ngrps;
+    ct_dstart = new int[ngrps + 1];
+    ct_sstart = new int[ngrps + 1];
+
+    int nd = 0, ns = 0;
+    for (int i = 0; i < ngrps; i++) {
+        ct_dstart[i] = nd;
+        ct_sstart[i] = ns;
+        const sGroup &g = groups[i];
+        for (sDevContactList *c = g.device_contacts(); c; c = c->next())
+            nd++;
+        for (sSubcContactList *c = g.subc_contacts(); c; c = c->next())
+            ns++;
+    }
+    ct_dstart[ngrps] = nd;
+    ct_sstart[ngrps] = ns;
+
+    ct_dconts = new sDevContactInst*[nd ? nd : 1];
+    ct_sconts = new sSubcContactInst*[ns ? ns : 1];
+    nd = 0;
+    ns = 0;
+    for (int i = 0; i < ngrps; i++) {
+        const sGroup &g = groups[i];
+        for (sDevContactList *c = g.device_contacts(); c; c = c->next())
+            ct_dconts[nd++] = c->contact();
+        for (sSubcContactList *c = g.subc_contacts(); c; c = c->next())
+            ct_sconts[ns++] = c->contact();
+    }
+
+    int nn = etlist ? etlist->size() : 0;
+    ct_nnodes = nn;
+    ct_edstart = new int[nn + 1];
+    ct_esstart = new int[nn + 1];
+
+    nd = 0;
+    ns = 0;
+    for (int i = 0; i < nn; i++) {
+        ct_edstart[i] = nd;
+        ct_esstart[i] = ns;
+        for (CDcont *t = etlist->conts_of_node(i); t; t = t->next()) {
+            if (!t->term()->instance())
+                continue;
+            CDs *msdesc = t->term()->instance()->masterCell();
+            if (!msdesc)
+                continue;
+            if (msdesc->isDevice())
+                nd++;
+            else
+                ns++;
+        }
+    }
+    ct_edstart[nn] = nd;
+    ct_esstart[nn] = ns;
+
+    ct_edterms = new CDcterm*[nd ? nd : 1];
+    ct_esterms = new CDcterm*[ns ? ns : 1];
+    nd = 0;
+    ns = 0;
+    for (int i = 0; i < nn; i++) {
+        for (CDcont *t = etlist->conts_of_node(i); t; t = t->next()) {
+            if (!t->term()->instance())
+                continue;
+            CDs *msdesc = t->term()->instance()->masterCell();
+            if (!msdesc)
+                continue;
+            if (msdesc->isDevice())
+                ct_edterms[nd++] = t->term();
+            else
+                ct_esterms[ns++] = t->term();
+        }
+    }
+}
+// End of sConnTab functions.
+
+
+// Create the connectivity tables from the current group and node
+// lists.  The tables must be rebuilt or cleared when the lists
+// change.
+//
+void
+cGroupDesc::build_conntab()
+{
+    delete gd_conntab;
+    gd_conntab = new sConnTab;
+    gd_conntab->build(gd_groups, nextindex(), gd_etlist);
+    gd_flags &= ~EXT_GD_CONNTAB_STALE;
+}
+
+
+void
+cGroupDesc::clear_conntab()
+{
+    delete gd_conntab;
+    gd_conntab = 0;
+    gd_flags &= ~EXT_GD_CONNTAB_STALE;
+}
@@ -820,6 +820,12 @@ cGroupDesc::link_contact(sDevContactInst *ci)
     if (ci->group() >= 0 && ci->group() <= gd_asize) {
         gd_groups[ci->group()].set_device_contacts(
             new sDevContactList(ci, gd_groups[ci->group()].device_contacts()));
+
+        // A bulk contact can be resolved while solving, when the
+        // connectivity tables are in use.  Rebuild them before the
+        // next read, once for any number of new contacts.
+        if (gd_conntab)
+            gd_flags |= EXT_GD_CONNTAB_STALE;
         return (true);
     }
     return (false);
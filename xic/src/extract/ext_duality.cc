@@ -56,6 +56,7 @@
 #include "promptline.h"
 #include "select.h"
 #include "miscutil/timer.h"
+#include "miscutil/threadpool.h"
 #include <algorithm>
 
 #define TIME_DBG
@@ -823,6 +824,7 @@ cGroupDesc::clear_duality()
     }
     sEinstList::destroy(gd_extra_devs);
     gd_extra_devs = 0;
+    clear_conntab();
 
     // Delete electrical subcells in the subckts list.
     for (sSubcList *su = gd_subckts; su; su = su->next()) {
@@ -2551,8 +2553,10 @@ cGroupDesc::subcircuit_permutation_fix_rc(int nfixes)
         // than normal, which does not rely on subcircuits being correctly
         // associated, and uses that all groups are associated.
 
+        build_conntab();
         for (sSubcList *sl = gd_subckts; sl; sl = sl->next())
             ident_subckt(sl, -1, false, true);
+        clear_conntab();
     }
 
     // Run the permutation fix on the subcircuits.
@@ -2774,6 +2778,105 @@ again:
 }
 
 
+namespace {
+    // When there are at least this many candidate electrical
+    // devices, the comparison scores are computed in the helper
+    // threads, if any.
+    const int MT_SCORE_MIN = 64;
+
+    // Scoring job for a block of candidates.
+    //
+    struct sScoreJob
+    {
+        cGroupDesc *gd;
+        sDevInst *pdev;
+        sEinstList **edevs;
+        int *scores;
+        int nedevs;
+    };
+
+    int score_thread_proc(sTPthreadData*, void *arg)
+    {
+        sScoreJob *j = (sScoreJob*)arg;
+        sDevComp comp;
+        if (!comp.set(j->pdev))
+            return (0);
+        for (int i = 0; i < j->nedevs; i++) {
+            if (j->edevs[i] && comp.set(j->edevs[i], true))
+                j->scores[i] = comp.score(j->gd, true);
+        }
+        return (0);
+    }
+
+
+    // Return an array of the comparison scores of the physical
+    // device pdev to each electrical device in dv that does not have
+    // a dual, in list order.  Entries that must be computed in the
+    // caller contain INT_MIN.  The sDevComp::score function only
+    // reads the group and node data, with the exception of the bulk
+    // contact resolution, which depends only on the physical device
+    // and is done here before the threads start.  The threads skip
+    // it, so that a contact that can't be resolved yet is not
+    // retried there.  Null is returned if there are no helper threads
+    // or too few candidates.
+    //
+    int *mt_dev_scores(cGroupDesc *gd, sDevList *dv, sDevInst *pdev)
+    {
+        int nth = DSP()->NumThreads();
+        if (nth <= 0)
+            return (0);
+        int cnt = 0;
+        for (sEinstList *c = dv->edevs(); c; c = c->next()) {
+            if (!c->dual_dev())
+                cnt++;
+        }
+        if (cnt < MT_SCORE_MIN)
+            return (0);
+
+        for (sDevContactInst *ci = pdev->contacts(); ci; ci = ci->next()) {
+            if (ci->desc()->is_bulk())
+                gd->check_bulk_contact(pdev, ci);
+        }
+        // Bring the connectivity tables up to date, the threads only
+        // read them.
+        gd->conntab();
+
+        sEinstList **edevs = new sEinstList*[cnt];
+        int *scores = new int[cnt];
+        cnt = 0;
+        for (sEinstList *c = dv->edevs(); c; c = c->next()) {
+            if (c->dual_dev())
+                continue;
+            scores[cnt] = INT_MIN;
+            edevs[cnt] = c;
+            cnt++;
+        }
+
+        int blksz = (cnt + nth)/(nth + 1);
+        int njobs = (cnt + blksz - 1)/blksz;
+        sScoreJob *jobs = new sScoreJob[njobs];
+        if (nth > njobs - 1)
+            nth = njobs - 1;
+        cThreadPool pool(nth);
+        for (int i = 0; i < njobs; i++) {
+            sScoreJob *j = jobs + i;
+            j->gd = gd;
+            j->pdev = pdev;
+            j->edevs = edevs + i*blksz;
+            j->scores = scores + i*blksz;
+            j->nedevs = cnt - i*blksz;
+            if (j->nedevs > blksz)
+                j->nedevs = blksz;
+            pool.submit(score_thread_proc, j);
+        }
+        pool.run(0);
+        delete [] jobs;
+        delete [] edevs;
+        return (scores);
+    }
+}
+
+
 // Try to find the match for the physical device set into comp from
 // among the electrical devices in dv.
 // 
@@ -2797,13 +2900,19 @@ cGroupDesc::find_match(sDevList *dv, sDevComp &comp, bool brksym) THROW_XIrt
         dp = dv->edevs();
     }
     else {
+        // In a large flat cell there may be many candidates, the
+        // scores can be computed in parallel.
+        int *scores = mt_dev_scores(this, dv, di);
         try {
             int px = -1;
+            int cix = 0;
             for (sEinstList *c = dv->edevs(); c;  c = c->next()) {
                 if (c->dual_dev())
                     continue;
                 comp.set(c);
-                int n = comp.score(this);
+                int n = scores ? scores[cix++] : INT_MIN;
+                if (n == INT_MIN)
+                    n = comp.score(this);
                 if (n > mx) {
                     px = -1;
                     mx = n;
@@ -2849,6 +2958,8 @@ cGroupDesc::find_match(sDevList *dv, sDevComp &comp, bool brksym) THROW_XIrt
                 else if (!comp.is_parallel(dp) && !comp.is_mos_tpeq(this, dp))
                     dp = 0;
             }
+            delete [] scores;
+            scores = 0;
 
             if (!dp) {
                 if (ExtErrLog.log_associating() && ExtErrLog.verbose()) {
@@ -2878,6 +2989,7 @@ cGroupDesc::find_match(sDevList *dv, sDevComp &comp, bool brksym) THROW_XIrt
         }
         catch (XIrt) {
             sSymCll::destroy(eposs);
+            delete [] scores;
             throw;
         }
     }
@@ -3340,8 +3452,16 @@ cGroupDesc::solve_duals() THROW_XIrt
         }
     }
 
+    // Associate the nets that can be identified by signature.
+    signature_match();
+
     set_skip_permutes(first_pass() || CDvdb()->getVariable(VA_NoPermute));
 
+    // The traversals use the compressed tables while solving.  The
+    // contact lists change only when a bulk contact is resolved, and
+    // link_contact rebuilds the tables then.
+    build_conntab();
+
     sSymBrk *saved = 0;
     int last = -1, lastlast = -1;
     int check_count = 0;
@@ -3545,8 +3665,10 @@ cGroupDesc::solve_duals() THROW_XIrt
         gd_sym_list = 0;
         sSymBrk::destroy(saved);
         saved = 0;
+        clear_conntab();
         throw;
     }
+    clear_conntab();
 
     ExtErrLog.add_log(ExtLogAssoc,
         "Solving for duals complete, loops %d, max iters %d, errs %d.",
@@ -3575,8 +3697,10 @@ cGroupDesc::check_split()
             continue;
 
         int node = -1;
-        for (sDevContactList *dc = g.device_contacts(); dc; dc = dc->next()) {
-            int n = dc->contact()->node();
+        int ndc, nsc;
+        sDevContactInst *const *dcs = conntab()->dev_contacts(i, &ndc);
+        for (int j = 0; j < ndc; j++) {
+            int n = dcs[j]->node();
             if (n >= 0) {
                 if (node < 0)
                     node = n;
@@ -3588,8 +3712,9 @@ cGroupDesc::check_split()
         }
         if (node == -2)
             continue;
-        for (sSubcContactList *sc = g.subc_contacts(); sc; sc = sc->next()) {
-            int n = sc->contact()->node();
+        sSubcContactInst *const *scs = conntab()->subc_contacts(i, &nsc);
+        for (int j = 0; j < nsc; j++) {
+            int n = scs[j]->node();
             if (n >= 0) {
                 if (node < 0)
                     node = n;
@@ -3758,6 +3883,9 @@ cGroupDesc::check_associations(int grp)
         return (false);
 
     bool retval = false;
+    int ndc, nsc;
+    sDevContactInst *const *dcs = conntab()->dev_contacts(grp, &ndc);
+    sSubcContactInst *const *scs = conntab()->subc_contacts(grp, &nsc);
     int tcnt = 0;
     for (CDcont *t = conts_of_node(g->node()); t; t = t->next())
         tcnt++;
@@ -3783,14 +3911,14 @@ cGroupDesc::check_associations(int grp)
             lstr.add(Tstring(terms[i]->master_name()));
         }
         lstr.add("\n  Phys Dev:");
-        for (sDevContactList *dc = g->device_contacts(); dc; dc = dc->next()) {
+        for (int k = 0; k < ndc; k++) {
             lstr.add_c(' ');
-            lstr.add(Tstring(dc->contact()->desc()->name()));
+            lstr.add(Tstring(dcs[k]->desc()->name()));
         }
         ExtErrLog.add_log(ExtLogAssoc, lstr.string());
     }
-    for (sDevContactList *dc = g->device_contacts(); dc; dc = dc->next()) {
-        sDevInst *di = dc->contact()->dev();
+    for (int k = 0; k < ndc; k++) {
+        sDevInst *di = dcs[k]->dev();
         bool found = false;
         for (int i = 0; i < tcnt; i++) {
             if (!terms[i])
@@ -3799,12 +3927,12 @@ cGroupDesc::check_associations(int grp)
                 continue;
             if (di->desc()->name() != terms[i]->instance()->cellname())
                 continue;
-            if (terms[i]->master_name() == dc->contact()->desc()->name()) {
+            if (terms[i]->master_name() == dcs[k]->desc()->name()) {
                 found = true;
                 terms[i] = 0;
                 break;
             }
-            else if (di->desc()->is_permute(dc->contact()->desc()->name())) {
+            else if (di->desc()->is_permute(dcs[k]->desc()->name())) {
                 if (di->desc()->is_permute(terms[i]->master_name())) {
                     found = true;
                     terms[i] = 0;
@@ -3816,7 +3944,7 @@ cGroupDesc::check_associations(int grp)
             ExtErrLog.add_log(ExtLogAssoc,
                 "Unassociating %s %d, %s not connected to node.",
                 di->desc()->name(), di->index(),
-                dc->contact()->desc()->name());
+                dcs[k]->desc()->name());
             retval = true;
 
             // unassociate device
@@ -3859,8 +3987,8 @@ cGroupDesc::check_associations(int grp)
             lstr.add(buf);
         }
         lstr.add("\n  Phys Subc: ");
-        for (sSubcContactList *sc = g->subc_contacts(); sc; sc = sc->next()) {
-            sSubcContactInst *ci = sc->contact();
+        for (int k = 0; k < nsc; k++) {
+            sSubcContactInst *ci = scs[k];
             sEinstList *el = ci->subc()->dual();
             snprintf(buf, sizeof(buf), " %s:%d:%d",
                 el ? Tstring(el->cdesc()->cellname()) : "",
@@ -3869,8 +3997,8 @@ cGroupDesc::check_associations(int grp)
         }
         ExtErrLog.add_log(ExtLogAssoc, lstr.string());
     }
-    for (sSubcContactList *sc = g->subc_contacts(); sc; sc = sc->next()) {
-        sSubcContactInst *ci = sc->contact();
+    for (int k = 0; k < nsc; k++) {
+        sSubcContactInst *ci = scs[k];
         sSubcInst *subc = ci->subc();
         CDs *sd = subc->cdesc()->masterCell(true);
         cGroupDesc *gd = sd->groups();
@@ -3919,7 +4047,7 @@ cGroupDesc::check_associations(int grp)
         if (ci->is_wire_only())
             found = true;
 
-        if (!found && sc->contact()->subc()->dual()) {
+        if (!found && scs[k]->subc()->dual()) {
             char *iname = subc->instance_name();
             ExtErrLog.add_log(ExtLogAssoc,
                 "Unassociating %s, group %d not connected to node.",
@@ -133,16 +133,28 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
     CDcont *t0 = conts_of_node(node);
     if (!t0 && !num_formal_terms)
         return (0);
-    for (CDcont *t = t0; t; t = t->next()) {
-        if (!t->term()->instance())
-            continue;
-        CDs *msdesc = t->term()->instance()->masterCell();
-        if (!msdesc)
-            continue;
-        if (msdesc->isDevice())
-            num_dev_terms++;
-        else
-            num_subc_terms++;
+
+    // Use the connectivity table when available, otherwise traverse
+    // the lists.
+    const sConnTab *ctab = conntab();
+    CDcterm *const *tab_dev_terms = 0;
+    CDcterm *const *tab_subc_terms = 0;
+    if (ctab) {
+        tab_dev_terms = ctab->dev_terms(node, &num_dev_terms);
+        tab_subc_terms = ctab->subc_terms(node, &num_subc_terms);
+    }
+    else {
+        for (CDcont *t = t0; t; t = t->next()) {
+            if (!t->term()->instance())
+                continue;
+            CDs *msdesc = t->term()->instance()->masterCell();
+            if (!msdesc)
+                continue;
+            if (msdesc->isDevice())
+                num_dev_terms++;
+            else
+                num_subc_terms++;
+        }
     }
     if (!num_dev_terms && !num_subc_terms) {
         // If the net is not connected to anything but a contact
@@ -162,22 +174,32 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
     }
     if (num_dev_terms) {
         dev_terms = new CDcterm*[num_dev_terms];
-        num_dev_terms = 0;
+        if (tab_dev_terms) {
+            memcpy(dev_terms, tab_dev_terms,
+                num_dev_terms*sizeof(CDcterm*));
+        }
     }
     if (num_subc_terms) {
         subc_terms = new CDcterm*[num_subc_terms];
-        num_subc_terms = 0;
+        if (tab_subc_terms) {
+            memcpy(subc_terms, tab_subc_terms,
+                num_subc_terms*sizeof(CDcterm*));
+        }
     }
-    for (CDcont *t = t0; t; t = t->next()) {
-        if (!t->term()->instance())
-            continue;
-        CDs *msdesc = t->term()->instance()->masterCell();
-        if (!msdesc)
-            continue;
-        if (msdesc->isDevice())
-            dev_terms[num_dev_terms++] = t->term();
-        else
-            subc_terms[num_subc_terms++] = t->term();
+    if (!ctab) {
+        num_dev_terms = 0;
+        num_subc_terms = 0;
+        for (CDcont *t = t0; t; t = t->next()) {
+            if (!t->term()->instance())
+                continue;
+            CDs *msdesc = t->term()->instance()->masterCell();
+            if (!msdesc)
+                continue;
+            if (msdesc->isDevice())
+                dev_terms[num_dev_terms++] = t->term();
+            else
+                subc_terms[num_subc_terms++] = t->term();
+        }
     }
     int cnt = num_formal_terms + num_dev_terms + num_subc_terms;
     int good = 0;
@@ -189,8 +211,27 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
     int num_subc_left = num_subc_terms;
     int num_formal_left = num_formal_terms;
 
-    for (sDevContactList *dc = g->device_contacts(); dc; dc = dc->next()) {
-        sDevInst *di = dc->contact()->dev();
+    int num_dconts = 0;
+    sDevContactInst **tmp_dconts = 0;
+    sDevContactInst *const *dconts = 0;
+    if (ctab)
+        dconts = ctab->dev_contacts(grp, &num_dconts);
+    else {
+        sDevContactList *d0 = g->device_contacts();
+        for (sDevContactList *dc = d0; dc; dc = dc->next())
+            num_dconts++;
+        if (num_dconts) {
+            tmp_dconts = new sDevContactInst*[num_dconts];
+            num_dconts = 0;
+            for (sDevContactList *dc = d0; dc; dc = dc->next())
+                tmp_dconts[num_dconts++] = dc->contact();
+        }
+        dconts = tmp_dconts;
+    }
+
+    for (int k = 0; k < num_dconts; k++) {
+        sDevContactInst *dci = dconts[k];
+        sDevInst *di = dci->dev();
         int p1, p2;
         find_prm_indices(di, &p1, &p2);
 
@@ -212,14 +253,14 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
             // per device.
 
             int ix = term->index();
-            if (ix == dc->contact()->desc()->elec_index()) {
+            if (ix == dci->desc()->elec_index()) {
                 good++;
                 num_devs_left--;
                 dev_terms[i] = 0;
                 break;
             }
             else if (ix == p1) {
-                if (dc->contact()->desc()->elec_index() == p2) {
+                if (dci->desc()->elec_index() == p2) {
                     good++;
                     num_devs_left--;
                     dev_terms[i] = 0;
@@ -227,7 +268,7 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
                 }
             }
             else if (ix == p2) {
-                if (dc->contact()->desc()->elec_index() == p1) {
+                if (dci->desc()->elec_index() == p1) {
                     good++;
                     num_devs_left--;
                     dev_terms[i] = 0;
@@ -237,6 +278,7 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
         }
         cnt++;
     }
+    delete [] tmp_dconts;
 
     // Count the number of matches involving a subcircuit group with a
     // label.  We give these a slightly higher score than unlabeled
@@ -244,8 +286,26 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
     //
     int label_bias = 0;
 
-    for (sSubcContactList *sc = g->subc_contacts(); sc; sc = sc->next()) {
-        sSubcContactInst *ci = sc->contact();
+    int num_sconts = 0;
+    sSubcContactInst **tmp_sconts = 0;
+    sSubcContactInst *const *sconts = 0;
+    if (ctab)
+        sconts = ctab->subc_contacts(grp, &num_sconts);
+    else {
+        sSubcContactList *s0 = g->subc_contacts();
+        for (sSubcContactList *sc = s0; sc; sc = sc->next())
+            num_sconts++;
+        if (num_sconts) {
+            tmp_sconts = new sSubcContactInst*[num_sconts];
+            num_sconts = 0;
+            for (sSubcContactList *sc = s0; sc; sc = sc->next())
+                tmp_sconts[num_sconts++] = sc->contact();
+        }
+        sconts = tmp_sconts;
+    }
+
+    for (int k = 0; k < num_sconts; k++) {
+        sSubcContactInst *ci = sconts[k];
         sSubcInst *subc = ci->subc();
         CDs *sd = subc->cdesc()->masterCell(true);
         cGroupDesc *gd = sd ? sd->groups() : 0;
@@ -306,6 +366,8 @@ cGroupDesc::ep_grp_comp(int grp, int node, const sSubcInst *sc_permuting)
         cnt++;
     }
 
+    delete [] tmp_sconts;
+
     // Now account for formal terminal connections.
     for (CDpin *p = g->termlist(); p; p = p->next()) {
         for (int i = 0; i < num_formal_terms; i++) {
@@ -1050,12 +1112,18 @@ sDevComp::set(sDevInst *di)
 }
 
 
+// If quiet is true, errors are not reported through Errs, which is
+// not thread-safe.
+//
 bool
-sDevComp::set(sEinstList *el)
+sDevComp::set(sEinstList *el, bool quiet)
 {
     if (!el) {
-        Errs()->add_error(
-            "Internal error: in sDevComp::set, null elec instance address.");
+        if (!quiet) {
+            Errs()->add_error(
+                "Internal error: in sDevComp::set, null elec instance "
+                "address.");
+        }
         return (false);
     }
     dc_edev = el;
@@ -1063,8 +1131,10 @@ sDevComp::set(sEinstList *el)
     unsigned int cnt = 0;
     for (CDp_cnode *pc = pc0; pc; pc = pc->next(), cnt++) ;
     if (!cnt) {
-        Errs()->add_error("Instance of device %s has no nodes.",
-            Tstring(el->cdesc()->cellname()));
+        if (!quiet) {
+            Errs()->add_error("Instance of device %s has no nodes.",
+                Tstring(el->cdesc()->cellname()));
+        }
         return (false);
     }
     if (cnt > dc_nodes_sz) {
@@ -1078,9 +1148,11 @@ sDevComp::set(sEinstList *el)
     if (vix) {
         pr = (CDp_range*)el->cdesc()->prpty(P_RANGE);
         if (!pr) {
-            Errs()->add_error("Instance of device %s has nonzero vector "
-                "index but no range property.",
-                Tstring(el->cdesc()->cellname()));
+            if (!quiet) {
+                Errs()->add_error("Instance of device %s has nonzero "
+                    "vector index but no range property.",
+                    Tstring(el->cdesc()->cellname()));
+            }
             return (false);
         }
     }
@@ -1094,10 +1166,12 @@ sDevComp::set(sEinstList *el)
     }
     for (unsigned int i = 0; i < dc_nodes_sz; i++) {
         if (!dc_nodes[i]) {
-            Errs()->add_error(
-                "Instance of device %s has no node property "
-                "for index %d",
-                Tstring(el->cdesc()->cellname()), i);
+            if (!quiet) {
+                Errs()->add_error(
+                    "Instance of device %s has no node property "
+                    "for index %d",
+                    Tstring(el->cdesc()->cellname()), i);
+            }
             return (false);
         }
     }
@@ -1105,8 +1179,12 @@ sDevComp::set(sEinstList *el)
 }
 
 
+// If in_thread is set, the score is being computed in a helper
+// thread and the bulk contacts are not resolved, as this changes
+// shared tables.  The caller has already tried to resolve them.
+//
 int
-sDevComp::score(cGroupDesc *gd)
+sDevComp::score(cGroupDesc *gd, bool in_thread)
 {
     if (!dc_conts_sz)
         return (-CMP_SCALE); // Bogus device, some error ocurred.
@@ -1172,7 +1250,8 @@ sDevComp::score(cGroupDesc *gd)
         else {
             sDevContactInst *ci = dc_conts[i];
             if (ci->desc()->is_bulk()) {
-                gd->check_bulk_contact(dc_pdev, ci);
+                if (!in_thread)
+                    gd->check_bulk_contact(dc_pdev, ci);
                 continue;
             }
             int node = dc_nodes[i]->enode();
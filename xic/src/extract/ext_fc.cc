@@ -54,6 +54,7 @@
 #include "dsp_color.h"
 #include "dsp_tkif.h"
 #include "miscutil/filestat.h"
+#include <algorithm>
 
 //
 // A new interface to FasterCap and FastCap-WR.
@@ -252,6 +253,12 @@ cFC::fcRun(const char *infile, const char *outfile, const char *resfile,
         Log()->PopUpErr("No current cell!");
         return;
     }
+    if (!nodump && CDvdb()->getVariable(VA_FcWindow)) {
+        // The windowed extraction creates its own input files, and
+        // runs in the foreground as the results must be stitched.
+        fcRunWindowed(resfile);
+        return;
+    }
     bool run_foreg = CDvdb()->getVariable(VA_FcForeg);
     bool monitor = CDvdb()->getVariable(VA_FcMonitor);
 
@@ -338,6 +345,393 @@ cFC::fcRun(const char *infile, const char *outfile, const char *resfile,
 }
 
 
+namespace {
+    // Per-window data for windowed extraction.
+    //
+    struct fc_win_t
+    {
+        fc_win_t()
+            {
+                job = 0;
+                gmap = 0;
+                frac = 0;
+                mat = 0;
+                names = 0;
+                units = 0.0;
+                ngroups = 0;
+                size = 0;
+            }
+
+        ~fc_win_t()
+            {
+                delete job;
+                delete [] gmap;
+                delete [] frac;
+                for (int i = 0; i < size; i++) {
+                    delete [] mat[i];
+                    delete [] names[i];
+                }
+                delete [] mat;
+                delete [] names;
+            }
+
+        fxJob *job;         // Job for the window.
+        int *gmap;          // Window group to whole-cell group.
+        double *frac;       // Fraction of group area in window core.
+        float **mat;        // Maxwell matrix from the job output.
+        char **names;       // Conductor names from the job output.
+        double units;       // Matrix scale factor.
+        int ngroups;        // Conductor groups in window.
+        int size;           // Matrix size.
+    };
+
+
+    // Stitched Maxwell matrix element, a <= b.
+    //
+    struct fc_elt_t
+    {
+        bool operator<(const fc_elt_t &e) const
+            {
+                if (a != e.a)
+                    return (a < e.a);
+                return (b < e.b);
+            }
+
+        double val;
+        int a;
+        int b;
+    };
+}
+
+
+// Windowed extraction, used when the FcWindow variable is set.  The
+// cell area is tiled into windows, each consisting of a core tile
+// and a surrounding halo whose width is the coupling distance. 
+// Each window is panelized and run as a separate job, and the jobs
+// are run concurrently, up to the Threads count at a time.  The
+// conductors of each window are mapped to conductor groups of the
+// whole cell, and the window matrices are stitched into a sparse
+// matrix.  A coupling found in several windows is weighted by the
+// fraction of the conductor area within each window core, so that
+// contributions from the overlapping halos are not counted twice. 
+// The results are written to resfile, or a default file, which is
+// presented in a file browser.
+//
+bool
+cFC::fcRunWindowed(const char *resfile)
+{
+    CDs *sdesc = CurCell(Physical);
+    if (!sdesc) {
+        Log()->PopUpErr("No current cell!");
+        return (false);
+    }
+    const char *wstr = CDvdb()->getVariable(VA_FcWindow);
+    double cdist = 0.0, tsize = 0.0;
+    if (!wstr || sscanf(wstr, "%lf %lf", &cdist, &tsize) < 1 ||
+            cdist < FC_WINDOW_MIN || cdist > FC_WINDOW_MAX) {
+        Log()->ErrorLog(mh::Initialization, "Bad FcWindow value.");
+        return (false);
+    }
+    if (tsize < cdist)
+        tsize = FC_WINDOW_TILE_FACTOR*cdist;
+    int halo = INTERNAL_UNITS(cdist);
+    int tile = INTERNAL_UNITS(tsize);
+
+    const char *fcap = CDvdb()->getVariable(VA_FcLayerName);
+    if (!fcap)
+        fcap = FC_LAYER_NAME;
+    const char *ustring = CDvdb()->getVariable(VA_FcUnits);
+    int u = ustring ? unit_t::find_unit(ustring) : FC_DEF_UNITS;
+    if (u < 0)
+        u = FC_DEF_UNITS;
+    e_unit unit = (e_unit)u;
+    double target = 0.0;
+    const char *str = CDvdb()->getVariable(VA_FcPanelTarget);
+    if (str && sscanf(str, "%lf", &target) == 1 &&
+            (target < FC_MIN_TARG_PANELS || target > FC_MAX_TARG_PANELS))
+        target = 0.0;
+
+    // The whole-cell layout provides the conductor groups used in
+    // the stitched result.  It is not panelized.
+
+    fcLayout gl;
+    bool ret = gl.init_for_extraction(sdesc, 0, fcap,
+        Tech()->SubstrateEps(), Tech()->SubstrateThickness());
+    if (ret)
+        ret = gl.check_dielectrics();
+    if (!ret) {
+        if (Errs()->has_error())
+            Log()->ErrorLog(mh::Initialization, Errs()->get_error());
+        return (false);
+    }
+    const BBox *cBB = gl.aoi();
+    int nx = (cBB->width() + tile - 1)/tile;
+    int ny = (cBB->height() + tile - 1)/tile;
+    if (nx < 1)
+        nx = 1;
+    if (ny < 1)
+        ny = 1;
+    int nwin = nx*ny;
+
+    fc_win_t *wins = new fc_win_t[nwin];
+    fxJob **jobs = new fxJob*[nwin];
+    int njobs = 0;
+    for (int i = 0; i < nwin; i++) {
+        BBox core;
+        core.left = cBB->left + (i % nx)*tile;
+        core.bottom = cBB->bottom + (i / nx)*tile;
+        core.right = mmMin(core.left + tile, cBB->right);
+        core.top = mmMin(core.bottom + tile, cBB->top);
+        BBox wBB(core);
+        wBB.bloat(halo);
+        wBB.left = mmMax(wBB.left, cBB->left);
+        wBB.bottom = mmMax(wBB.bottom, cBB->bottom);
+        wBB.right = mmMin(wBB.right, cBB->right);
+        wBB.top = mmMin(wBB.top, cBB->top);
+
+        fcLayout wl;
+        if (!wl.init_for_extraction(sdesc, &wBB, fcap,
+                Tech()->SubstrateEps(), Tech()->SubstrateThickness()) ||
+                !wl.check_dielectrics()) {
+            // Likely no conductors in the window.
+            Errs()->init_error();
+            continue;
+        }
+        int ng = wl.num_groups();
+        if (!ng)
+            continue;
+
+        fxJob *job = new fxJob(Tstring(sdesc->cellname()), fxCapMode, 0, 0);
+        job->set_flag(FX_UNLINK_IN | FX_UNLINK_OUT);
+        job->set_infiles(new stringlist(filestat::make_temp("fci"), 0));
+        job->set_outfile(filestat::make_temp("fco"));
+        wins[i].job = job;
+        if (!job->setup_fc_run(true, false)) {
+            delete [] jobs;
+            delete [] wins;
+            return (false);
+        }
+        if (job->if_type() == fxJobMIT) {
+            DSPpkg::self()->ErrPrintf(ET_ERROR,
+    "\nThe FastCap program found is not supported.  This interface requires\n"
+    "either the FasterCap program from FastFieldSolvers.com, or the free\n"
+    "Whiteley Research FastCap program from wrcad.com.\n");
+            delete [] jobs;
+            delete [] wins;
+            return (false);
+        }
+
+        FILE *fp = filestat::open_file(job->infile(), "w");
+        if (!fp) {
+            Log()->ErrorLog(mh::Initialization, filestat::error_msg());
+            delete [] jobs;
+            delete [] wins;
+            return (false);
+        }
+        fprintf(fp, "** Fast[er]Cap input from cell %s, window %d\n",
+            Tstring(sdesc->cellname()), i);
+        fprintf(fp, "** Generated by %s\n", XM()->IdString());
+        fprintf(fp, "** Units %s\n", unit_t::units(unit)->name());
+        fprintf(fp, "\n");
+        wl.layer_dump(fp);
+        if (target > 0.0)
+            wl.setup_refine(target);
+        ret = wl.write_panels(fp, 0, 0, unit);
+        fclose(fp);
+        if (!ret) {
+            if (Errs()->has_error())
+                Log()->ErrorLog(mh::Initialization, Errs()->get_error());
+            delete [] jobs;
+            delete [] wins;
+            return (false);
+        }
+
+        wins[i].ngroups = ng;
+        wins[i].gmap = new int[ng];
+        wins[i].frac = new double[ng];
+        for (int j = 0; j < ng; j++) {
+            wins[i].gmap[j] = gl.find_group(&wl, j);
+            double a = wl.group_area(j, 0);
+            wins[i].frac[j] = a > 0.0 ? wl.group_area(j, &core)/a : 0.0;
+        }
+        jobs[njobs++] = job;
+    }
+    if (!njobs) {
+        Log()->ErrorLog(mh::Processing,
+            "No conductors found for windowed extraction.");
+        delete [] jobs;
+        delete [] wins;
+        return (false);
+    }
+
+    PL()->ShowPromptV("Running %d windowed extraction jobs...", njobs);
+    int nthr = DSP()->NumThreads();
+    ret = fxJob::run_concurrent(jobs, njobs, nthr > 1 ? nthr : 1);
+    delete [] jobs;
+    if (!ret) {
+        Log()->ErrorLog(mh::JobControl,
+            "One or more windowed extraction jobs failed.");
+        delete [] wins;
+        return (false);
+    }
+
+    // Read the matrices, and collect the weighted elements.
+
+    int nelts = 0;
+    for (int i = 0; i < nwin; i++) {
+        fc_win_t &w = wins[i];
+        if (!w.job)
+            continue;
+        char *err = fxJob::fc_get_matrix(w.job->outfile(), &w.size,
+            &w.mat, &w.units, &w.names);
+        if (err) {
+            Log()->ErrorLog(mh::Processing, err);
+            delete [] err;
+            delete [] wins;
+            return (false);
+        }
+        nelts += w.size*w.size;
+    }
+    fc_elt_t *elts = new fc_elt_t[nelts ? nelts : 1];
+    nelts = 0;
+    for (int i = 0; i < nwin; i++) {
+        fc_win_t &w = wins[i];
+        if (!w.job)
+            continue;
+        // Map the matrix rows to window groups by conductor name, as
+        // the conductor names are "g<group>" followed by the panel
+        // type and count.
+        int *rmap = new int[w.size];
+        for (int p = 0; p < w.size; p++) {
+            const char *nm = w.names[p];
+            int g = -1;
+            if (nm && nm[0] == 'g' && isdigit(nm[1]))
+                g = atoi(nm + 1);
+            rmap[p] = (g >= 0 && g < w.ngroups) ? g : -1;
+        }
+        for (int p = 0; p < w.size; p++) {
+            int gp = rmap[p];
+            if (gp < 0)
+                continue;
+            int a = w.gmap[gp];
+            if (a < 0)
+                continue;
+            for (int q = p; q < w.size; q++) {
+                int gq = rmap[q];
+                if (gq < 0)
+                    continue;
+                int b = w.gmap[gq];
+                if (b < 0)
+                    continue;
+                double wt = 0.5*(w.frac[gp] + w.frac[gq]);
+                if (wt <= 0.0)
+                    continue;
+                // To farads.  If distinct conductors map to the same
+                // group, both off-diagonal terms add to its diagonal,
+                // otherwise use the symmetric average.
+                double v;
+                if (p == q)
+                    v = w.mat[p][p]*w.units;
+                else if (a == b)
+                    v = (w.mat[p][q] + w.mat[q][p])*w.units;
+                else
+                    v = 0.5*(w.mat[p][q] + w.mat[q][p])*w.units;
+                fc_elt_t &e = elts[nelts++];
+                e.a = mmMin(a, b);
+                e.b = mmMax(a, b);
+                e.val = wt*v;
+            }
+        }
+        delete [] rmap;
+    }
+    std::sort(elts, elts + nelts);
+    int n = 0;
+    for (int i = 0; i < nelts; i++) {
+        if (n && elts[n-1].a == elts[i].a && elts[n-1].b == elts[i].b)
+            elts[n-1].val += elts[i].val;
+        else
+            elts[n++] = elts[i];
+    }
+    nelts = n;
+
+    // Capacitance to ground is the row sum of the Maxwell matrix.
+    int ngrp = gl.num_groups();
+    double *gcap = new double[ngrp ? ngrp : 1];
+    for (int i = 0; i < ngrp; i++)
+        gcap[i] = 0.0;
+    for (int i = 0; i < nelts; i++) {
+        gcap[elts[i].a] += elts[i].val;
+        if (elts[i].b != elts[i].a)
+            gcap[elts[i].b] += elts[i].val;
+    }
+
+    char *rf = 0;
+    if (!resfile || !*resfile) {
+        rf = getFileName("fc_log");
+        resfile = rf;
+    }
+    GCarray<char*> gc_rf(rf);
+    if (!filestat::create_bak(resfile)) {
+        DSPpkg::self()->ErrPrintf(ET_ERROR, "%s", filestat::error_msg());
+        delete [] gcap;
+        delete [] elts;
+        delete [] wins;
+        return (false);
+    }
+    FILE *fp = filestat::open_file(resfile, "w");
+    if (!fp) {
+        Log()->ErrorLog(mh::Initialization, filestat::error_msg());
+        delete [] gcap;
+        delete [] elts;
+        delete [] wins;
+        return (false);
+    }
+    fprintf(fp, "** %s: Output from FastCap interface, windowed\n", resfile);
+    fprintf(fp, "** Generated by %s\n", XM()->IdString());
+    fprintf(fp, "DataSet: %s\n", Tstring(sdesc->cellname()));
+    fprintf(fp, "Windows: %d of %d x %d, coupling distance %g, tile %g\n",
+        njobs, nx, ny, cdist, tsize);
+    for (int i = 0; i < nwin; i++) {
+        if (wins[i].job) {
+            fprintf(fp, "Command: %s\n", wins[i].job->command());
+            break;
+        }
+    }
+
+    fprintf(fp, "\nSelf Capacitance (femtofarads):\n");
+    char buf[64];
+    for (int i = 0; i < ngrp; i++) {
+        snprintf(buf, sizeof(buf), "C.g%d", i);
+        fprintf(fp, " %-12s%.3g\n", buf, gcap[i]*1e15);
+    }
+    bool hdr = false;
+    for (int i = 0; i < nelts; i++) {
+        if (elts[i].a == elts[i].b)
+            continue;
+        if (!hdr) {
+            fprintf(fp, "\nMutual Capacitance (femtofarads):\n");
+            hdr = true;
+        }
+        snprintf(buf, sizeof(buf), "C.g%d.g%d", elts[i].a, elts[i].b);
+        fprintf(fp, " %-12s%.3g\n", buf, -elts[i].val*1e15);
+    }
+    fclose(fp);
+    delete [] gcap;
+    delete [] elts;
+    delete [] wins;
+
+    delete [] fc_groups;
+    fc_groups = gl.group_points();
+    fc_ngroups = gl.num_groups();
+
+    PL()->ErasePrompt();
+    DSPmainWbag(PopUpFileBrowser(resfile))
+    updateString();
+    updateMarks();
+    return (true);
+}
+
+
 // Return a file name for use with output.
 //
 char *
@@ -1140,6 +1534,64 @@ fcLayout::group_points() const
 }
 
 
+// Return the index of the group in this layout that contains the
+// group grp of wl, which covers a sub-area of the same cell.  Return
+// -1 if not found.
+//
+int
+fcLayout::find_group(const fcLayout *wl, int grp) const
+{
+    if (!wl || grp < 0 || grp >= wl->db3_ngroups || !db3_groups)
+        return (-1);
+    for (glZlistRef3d *z = wl->db3_groups->list[grp]; z; z = z->next) {
+        Layer3d *wld = wl->layer(z->PZ->layer_index);
+        if (!wld)
+            continue;
+        for (Layer3d *l = db3_stack; l; l = l->next()) {
+            if (l->layer_desc() != wld->layer_desc())
+                continue;
+            for (glYlist3d *y = l->yl3d(); y; y = y->next) {
+                if (y->y_yl >= z->PZ->yu)
+                    continue;
+                if (y->y_yu <= z->PZ->yl)
+                    break;
+                for (glZlist3d *zl = y->y_zlist; zl; zl = zl->next) {
+                    if (zl->Z.zbot >= z->PZ->ztop ||
+                            zl->Z.ztop <= z->PZ->zbot)
+                        continue;
+                    if (zl->Z.Zoid::intersect(z->PZ, false))
+                        return (zl->Z.group);
+                }
+            }
+        }
+    }
+    return (-1);
+}
+
+
+// Return the footprint area of the group, summed over layers.  If BB
+// is given, only the area within BB is counted.
+//
+double
+fcLayout::group_area(int grp, const BBox *BB) const
+{
+    if (grp < 0 || grp >= db3_ngroups || !db3_groups)
+        return (0.0);
+    double a = 0.0;
+    for (glZlistRef3d *z = db3_groups->list[grp]; z; z = z->next) {
+        if (!BB) {
+            a += z->PZ->area();
+            continue;
+        }
+        Zlist *zc = z->PZ->clip_to(BB);
+        for (Zlist *zx = zc; zx; zx = zx->next)
+            a += zx->Z.area();
+        Zlist::destroy(zc);
+    }
+    return (a);
+}
+
+
 namespace {
     // Return true if the right side of Zr and the left side of Zl
     // are colinear.  We don't really care about overlap here.
@@ -56,6 +56,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
 #ifdef WIN32
 #include "miscutil/msw.h"
 #include <windows.h>
@@ -795,6 +796,72 @@ fxJob::run(bool run_foreg, bool monitor)
 }
 
 
+// Static function.
+// Run the jobs in the foreground, with up to maxp of them running
+// concurrently.  The jobs must have been set up for foreground
+// execution.  Return false if any job failed.
+//
+bool
+fxJob::run_concurrent(fxJob **jobs, int njobs, int maxp)
+{
+    if (maxp < 1)
+        maxp = 1;
+    for (int i = 0; i < njobs; i++)
+        time(&jobs[i]->j_start_time);
+    bool ok = true;
+
+#ifdef WIN32
+    for (int i = 0; i < njobs; i++) {
+        if (cMain::System(jobs[i]->j_command) != 0)
+            ok = false;
+    }
+#else
+    // Block SIGCHLD, so that the child handler won't reap our
+    // processes.
+    sigset_t newsigblock, oldsigblock;
+    sigemptyset(&newsigblock);
+    sigaddset(&newsigblock, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &newsigblock, &oldsigblock);
+
+    int *pids = new int[njobs];
+    int nstarted = 0;
+    for (int ndone = 0; ndone < njobs; ndone++) {
+        while (nstarted < njobs && nstarted - ndone < maxp) {
+            int pid = fork();
+            if (pid == 0) {
+                DSPpkg::self()->CloseGraphicsConnection();
+                sigprocmask(SIG_SETMASK, &oldsigblock, 0);
+                setsid();
+                execl("/bin/sh", "sh", "-c", jobs[nstarted]->j_command,
+                    (char*)0);
+                _exit(127);
+            }
+            if (pid == -1)
+                ok = false;
+            pids[nstarted++] = pid;
+        }
+
+        // Wait for the oldest job.
+        int pid = pids[ndone];
+        if (pid == -1)
+            continue;
+        int status = 0;
+        for (;;) {
+            int rpid = waitpid(pid, &status, 0);
+            if (rpid == -1 && errno == EINTR)
+                continue;
+            break;
+        }
+        if (status != 0)
+            ok = false;
+    }
+    delete [] pids;
+    sigprocmask(SIG_SETMASK, &oldsigblock, 0);
+#endif
+    return (ok);
+}
+
+
 namespace {
     void copyin(FILE *fp, char *fname)
     {
@@ -285,6 +285,23 @@ cExt::clearGroups(CDs *sd)
 }
 
 
+// Called when odesc is being added to or removed from sd.  If the
+// grouping can be patched locally, the change is recorded and true
+// is returned.  Otherwise false is returned, and the caller should
+// invalidate the grouping.  For export.
+//
+bool
+cExt::updateGroups(CDs *sd, CDo *odesc, bool removing)
+{
+    if (!sd || !odesc || sd->isElectrical())
+        return (false);
+    cGroupDesc *gd = sd->groups();
+    if (!gd)
+        return (false);
+    return (gd->mark_dirty(odesc, removing));
+}
+
+
 // Private recursive core for the group function.
 //
 XIrt
@@ -317,6 +334,13 @@ cExt::group_rec(CDs *sdesc, int depth, SymTab *tab)
             ret = gd->setup_groups();
             activateGroundPlane(false);
         }
+        else if (sdesc->groups() && sdesc->groups()->dirty()) {
+            // Objects were added or removed since grouping, patch
+            // the affected groups.
+            activateGroundPlane(true);
+            ret = sdesc->groups()->update_groups();
+            activateGroundPlane(false);
+        }
         if (sdesc->cellname() == DSP()->CurCellName() && isShowingGroups()) {
             cGroupDesc *gd = sdesc->groups();
             if (gd) {
@@ -340,6 +364,51 @@ cExt::group_rec(CDs *sdesc, int depth, SymTab *tab)
 // End of cExt functions.
 
 
+namespace {
+    // Sort the objects in o0, which are all on the same layer, into
+    // lists of touching objects.  On entry, cntp points to the length of
+    // o0.  The returned array contains the lists, the number of which is
+    // returned in cntp.
+    //
+    CDol **
+    find_clusters(CDol *o0, int *cntp)
+    {
+        sGroupObjs::sort_list(o0);
+
+        CDol **ary = new CDol*[*cntp];
+        int cnt = 0;
+        while (o0) {
+            ary[cnt] = o0;
+            o0 = o0->next;
+            ary[cnt]->next = 0;
+            CDol *oe = ary[cnt];
+            for (CDol *oc = oe; oc; oc = oc->next) {
+                CDol *op = 0, *on;
+                for (CDol *o = o0; o; o = on) {
+                    if (o->odesc->oBB().top < oc->odesc->oBB().bottom)
+                        break;
+                    on = o->next;
+                    if (oc->odesc->intersect(o->odesc, true)) {
+                        if (!op)
+                            o0 = on;
+                        else
+                            op->next = on;
+                        o->next = 0;
+                        oe->next = o;
+                        oe = oe->next;
+                        continue;
+                    }
+                    op = o;
+                }
+            }
+            cnt++;
+        }
+        *cntp = cnt;
+        return (ary);
+    }
+}
+
+
 // This is the main function for establishing the conductor grouping.
 //
 XIrt
@@ -365,6 +434,199 @@ cGroupDesc::setup_groups()
 }
 
 
+// Patch the grouping after local changes.  The groups with objects
+// in the changed area, expanded to cover vias that overlap it, are
+// taken apart.  Their objects, plus new objects in the area, are
+// regrouped, and connections are found only within the area spanned
+// by these objects.  The remaining groups are untouched, other than
+// renumbering.  If the change can't be handled locally, the grouping
+// is redone from scratch.
+//
+XIrt
+cGroupDesc::update_groups()
+{
+    if (!dirty())
+        return (XIok);
+    gd_flags &= ~EXT_GD_DIRTY;
+    if (!gd_groups)
+        return (setup_groups());
+
+    // A via that overlaps the area may have made or broken a
+    // connection, the area must enclose these.
+    BBox dBB(gd_dirtyBB);
+    CDl *ld;
+    CDextLgen vgen(CDL_VIA);
+    while ((ld = vgen.next()) != 0) {
+        sPF gen(gd_celldesc, &gd_dirtyBB, ld, EX()->viaSearchDepth());
+        CDo *odesc;
+        while ((odesc = gen.next(false, false)) != 0) {
+            dBB.add(&odesc->oBB());
+            delete odesc;
+        }
+    }
+
+    // Find the groups that must be rebuilt.  New objects have a
+    // negative group number.  If the ground group is involved, give
+    // up and regroup everything.
+    char *dmap = new char[gd_asize];
+    memset(dmap, 0, gd_asize);
+    CDextLgen lgen(CDL_CONDUCTOR, CDextLgen::TopToBot);
+    while ((ld = lgen.next()) != 0) {
+        if (ld->isGroundPlane() && ld->isDarkField())
+            continue;
+        sGrpGen gdesc;
+        gdesc.init_gen(this, ld, &dBB);
+        CDo *odesc;
+        while ((odesc = gdesc.next()) != 0) {
+            if (odesc->type() == CDLABEL)
+                continue;
+            int g = odesc->group();
+            if (g < 0)
+                continue;
+            if (g == 0 || g >= gd_asize) {
+                delete [] dmap;
+                return (setup_groups());
+            }
+            dmap[g] = 1;
+        }
+    }
+
+    // Pull the objects out of these groups, and add the new objects.
+    CDol *pool = 0;
+    int pcnt = 0;
+    for (int i = 1; i < gd_asize; i++) {
+        if (!dmap[i])
+            continue;
+        sGroupObjs *go = gd_groups[i].net();
+        if (go) {
+            CDol *ol = go->objlist();
+            if (ol) {
+                CDol *oe = ol;
+                for (pcnt++; oe->next; oe = oe->next, pcnt++) ;
+                oe->next = pool;
+                pool = ol;
+            }
+            go->set_objlist(0);
+            delete go;
+        }
+        gd_groups[i].clear();
+    }
+    delete [] dmap;
+
+    lgen = CDextLgen(CDL_CONDUCTOR, CDextLgen::TopToBot);
+    while ((ld = lgen.next()) != 0) {
+        if (ld->isGroundPlane() && ld->isDarkField())
+            continue;
+        sGrpGen gdesc;
+        gdesc.init_gen(this, ld, &dBB);
+        CDo *odesc;
+        while ((odesc = gdesc.next()) != 0) {
+            if (odesc->type() == CDLABEL)
+                continue;
+            if (!odesc->is_normal())
+                continue;
+            if (odesc->group() >= 0)
+                continue;
+            pool = new CDol(odesc, pool);
+            pcnt++;
+        }
+    }
+
+    if (ExtErrLog.log_grouping() && ExtErrLog.log_fp()) {
+        FILE *fp = ExtErrLog.log_fp();
+        fprintf(fp,
+            "\n=======================================================\n");
+        fprintf(fp, "Regrouping %d objects in cell %s\n", pcnt,
+            Tstring(gd_celldesc->cellname()));
+    }
+
+    // Regroup the pooled objects on each layer, into new groups
+    // at the end of the array.
+    BBox cBB(dBB);
+    lgen = CDextLgen(CDL_CONDUCTOR, CDextLgen::TopToBot);
+    while ((ld = lgen.next()) != 0 && pool) {
+        CDol *o0 = 0, *op = 0, *on;
+        int cnt = 0;
+        for (CDol *o = pool; o; o = on) {
+            on = o->next;
+            if (o->odesc->ldesc() != ld) {
+                op = o;
+                continue;
+            }
+            if (op)
+                op->next = on;
+            else
+                pool = on;
+            o->next = o0;
+            o0 = o;
+            cBB.add(&o->odesc->oBB());
+            cnt++;
+        }
+        if (!cnt)
+            continue;
+
+        int last = nextindex();
+        CDol **ary = find_clusters(o0, &cnt);
+        alloc_groups(last + cnt);
+        sGroup *gp = gd_groups + last;
+        for (int i = 0; i < cnt; i++) {
+            sGroupObjs *go = new sGroupObjs(ary[i], 0);
+            gp[i].set_net(go);
+            gp[i].newnum(i + last);
+        }
+        delete [] ary;
+    }
+    // Anything left over is on a layer that is no longer a conductor.
+    CDol::destroy(pool);
+
+    XIrt ret = combine(&cBB);
+    if (ret != XIok) {
+        clear_groups();
+        return (ret);
+    }
+    renumber_groups();
+    // trim size;
+    alloc_groups(nextindex());
+
+    if (ExtErrLog.log_grouping() && ExtErrLog.log_fp())
+        dump(ExtErrLog.log_fp());
+
+    return (XIok);
+}
+
+
+// The object odesc is being added to the cell, or removed if removing
+// is true.  If the grouping can be patched later by update_groups,
+// record the change and return true.  Otherwise return false, the
+// caller should invalidate the grouping.
+//
+bool
+cGroupDesc::mark_dirty(CDo *odesc, bool removing)
+{
+    if (!gd_groups || !gd_celldesc->isConnected())
+        return (false);
+    if (!incr_ok(odesc))
+        return (false);
+
+    if (!dirty()) {
+        clear_extract();
+        gd_dirtyBB = odesc->oBB();
+        gd_flags |= EXT_GD_DIRTY;
+    }
+    else
+        gd_dirtyBB.add(&odesc->oBB());
+    gd_celldesc->setExtracted(false);
+
+    if (removing) {
+        if (odesc->ldesc()->isConductor())
+            unlink_object(odesc);
+    }
+    else
+        odesc->set_group(-1);
+    return (true);
+}
+
+
 // Destroy the groups and the lists in grdesc, but not grdesc itself. 
 // The extraction and duality are gone, too.  Keep the inverted ground
 // plane, if any, unless true is passed.
@@ -394,6 +656,7 @@ cGroupDesc::clear_groups(bool gptoo)
         EX()->setShowingNodes(false);
         EX()->PopUpExtSetup(0, MODE_UPD);
     }
+    clear_conntab();
     delete [] gd_groups;
     gd_groups = 0;
     gd_asize = 0;
@@ -404,6 +667,7 @@ cGroupDesc::clear_groups(bool gptoo)
     delete gd_ignore_tab;
     gd_ignore_tab = 0;
     set_top_level(false);
+    gd_flags &= ~EXT_GD_DIRTY;
     if (gptoo && EX()->groundPlaneLayerInv()) {
         gd_celldesc->setGPinv(false);
         gd_celldesc->db_clear_layer(EX()->groundPlaneLayerInv());
@@ -905,36 +1169,7 @@ cGroupDesc::group_objects()
             continue;
         }
 
-        sGroupObjs::sort_list(o0);
-
-        CDol **ary = new CDol*[cnt];
-        cnt = 0;
-        while (o0) {
-            ary[cnt] = o0;
-            o0 = o0->next;
-            ary[cnt]->next = 0;
-            CDol *oe = ary[cnt];
-            for (CDol *oc = oe; oc; oc = oc->next) {
-                CDol *op = 0, *on;
-                for (CDol *o = o0; o; o = on) {
-                    if (o->odesc->oBB().top < oc->odesc->oBB().bottom)
-                        break;
-                    on = o->next;
-                    if (oc->odesc->intersect(o->odesc, true)) {
-                        if (!op)
-                            o0 = on;
-                        else
-                            op->next = on;
-                        o->next = 0;
-                        oe->next = o;
-                        oe = oe->next;
-                        continue;
-                    }
-                    op = o;
-                }
-            }
-            cnt++;
-        }
+        CDol **ary = find_clusters(o0, &cnt);
         alloc_groups(last + cnt);
         sGroup *gp = gd_groups + last;
         for (int i = 0; i < cnt; i++) {
@@ -989,12 +1224,76 @@ cGroupDesc::group_objects()
 }
 
 
+// Return true if adding or removing odesc can be handled by patching
+// the existing groups.  Instances, ground plane objects, and anything
+// that might interact with exclusion require full regrouping.
+//
+bool
+cGroupDesc::incr_ok(const CDo *odesc) const
+{
+    if (odesc->type() == CDINSTANCE)
+        return (false);
+    if (EX()->skipExtract(gd_celldesc))
+        return (false);
+    const sLspec *globex = EX()->globalExclude();
+    if (globex->tree() || globex->ldesc())
+        return (false);
+
+    CDl *ld;
+    CDextLgen lgen(CDL_CONDUCTOR);
+    while ((ld = lgen.next()) != 0) {
+        if (tech_prm(ld)->exclude())
+            return (false);
+    }
+    ld = odesc->ldesc();
+    if (!ld || ld->isGroundPlane())
+        return (false);
+    if (odesc->type() == CDLABEL)
+        return (true);
+    return (ld->isConductor() || ld->isVia());
+}
+
+
+// Remove odesc from the object list of its group, the object is
+// being taken out of the cell.
+//
+void
+cGroupDesc::unlink_object(CDo *odesc)
+{
+    int g = odesc->group();
+    sGroupObjs *go = net_of_group(g);
+    if (!go)
+        return;
+    CDol *op = 0;
+    for (CDol *o = go->objlist(); o; o = o->next) {
+        if (o->odesc == odesc) {
+            if (op)
+                op->next = o->next;
+            else
+                go->set_objlist(o->next);
+            delete o;
+            break;
+        }
+        op = o;
+    }
+    if (!go->objlist()) {
+        delete go;
+        gd_groups[g].set_net(0);
+    }
+    else
+        go->set_objlist(go->objlist());  // reset length and sort flag
+}
+
+
 // Combine groups that are connected through a Contact layer or
-// through a via.
+// through a via.  Only objects that overlap AOI are considered, if
+// given.
 //
 XIrt
-cGroupDesc::combine()
+cGroupDesc::combine(const BBox *AOI)
 {
+    if (!AOI)
+        AOI = &CDinfiniteBB;
     ext_group::Ufb ufb;
     // First, combine groups connected through Contact layers.
     ufb.save("Looking for straps...");
@@ -1014,7 +1313,7 @@ cGroupDesc::combine()
             if (!ld1->isConductor())
                 continue;
             sGrpGen gdesc;
-            gdesc.init_gen(this, ld, &CDinfiniteBB);
+            gdesc.init_gen(this, ld, AOI);
             CDo *odesc;
             while ((odesc = gdesc.next()) != 0) {
                 if (ufb.checkPrint())
@@ -1074,7 +1373,7 @@ cGroupDesc::combine()
             bool null_ok1 = ld1->isGroundPlane() && ld1->isDarkField();
             bool null_ok2 = ld2->isGroundPlane() && ld2->isDarkField();
 
-            sPF gen(gd_celldesc, &CDinfiniteBB, ld, EX()->viaSearchDepth());
+            sPF gen(gd_celldesc, AOI, ld, EX()->viaSearchDepth());
             CDo *odesc;
             while ((odesc = gen.next(false, false)) != 0) {
                 if (ufb.checkPrint()) {
@@ -563,8 +563,10 @@ cGroupDesc::print_lvs(FILE *fp)
 
     // Terminal references.
     fprintf(fp, "\nChecking per-group/node terminal references:\n\n");
+    build_conntab();
     for (int i = 0; i < psize; i++)
         check_grp_node(i, lvs, fp);
+    clear_conntab();
     if (!lvs.bad_nets)
         fprintf(fp, "  No errors.\n");
     else
@@ -850,8 +852,12 @@ cGroupDesc::check_grp_node(int grp, sLVSstat &lvs, FILE *fp)
     for (CDcont *t = conts_of_node(g->node()); t; t = t->next())
         terms[tcnt++] = t->term();
 
-    for (sDevContactList *dc = g->device_contacts(); dc; dc = dc->next()) {
-        sDevInst *di = dc->contact()->dev();
+    int ndc, nsc;
+    sDevContactInst *const *dcs = conntab()->dev_contacts(grp, &ndc);
+    sSubcContactInst *const *scs = conntab()->subc_contacts(grp, &nsc);
+
+    for (int k = 0; k < ndc; k++) {
+        sDevInst *di = dcs[k]->dev();
         bool found = false;
         for (int i = 0; i < tcnt; i++) {
             if (!terms[i] || !terms[i]->instance())
@@ -860,15 +866,14 @@ cGroupDesc::check_grp_node(int grp, sLVSstat &lvs, FILE *fp)
                 continue;
             if (di->desc()->name() != terms[i]->instance()->cellname())
                 continue;
-            if (di->desc()->is_permute(dc->contact()->desc()->name())) {
+            if (di->desc()->is_permute(dcs[k]->desc()->name())) {
                 if (di->desc()->is_permute(terms[i]->master_name())) {
                     found = true;
                     terms[i] = 0;
                     break;
                 }
             }
-            else if (terms[i]->master_name() ==
-                    dc->contact()->desc()->name()) {
+            else if (terms[i]->master_name() == dcs[k]->desc()->name()) {
                 found = true;
                 terms[i] = 0;
                 break;
@@ -882,13 +887,13 @@ cGroupDesc::check_grp_node(int grp, sLVSstat &lvs, FILE *fp)
             fprintf(fp,
             "    Physical device contact %s %d %s not connected to node.\n",
                 TstringNN(di->desc()->name()), di->index(),
-                TstringNN(dc->contact()->desc()->name()));
+                TstringNN(dcs[k]->desc()->name()));
             retval |= GROUP_ASSOC_ERROR;
         }
     }
 
-    for (sSubcContactList *sc = g->subc_contacts(); sc; sc = sc->next()) {
-        sSubcContactInst *ci = sc->contact();
+    for (int k = 0; k < nsc; k++) {
+        sSubcContactInst *ci = scs[k];
         sSubcInst *subc = ci->subc();
         CDs *sd = subc->cdesc()->masterCell(true);
         cGroupDesc *gd = sd->groups();
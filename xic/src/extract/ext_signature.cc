@@ -0,0 +1,454 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "main.h"
+#include "ext.h"
+#include "ext_extract.h"
+#include "ext_nets.h"
+#include "ext_errlog.h"
+#include <algorithm>
+
+
+/*========================================================================*
+ *
+ *  Signature matching for association
+ *
+ *========================================================================*/
+
+// Before the iterative association in solve_duals, the physical and
+// electrical circuits are each described as a bipartite graph of
+// device instances and nets.  The nets are colored by iterated
+// neighborhood hashing (Weisfeiler-Lehman refinement):  a device
+// color hashes its type and the colors of the nets at each terminal
+// class, and a net color hashes the device colors and terminal
+// classes of its connections.  Nets already associated, such as
+// ground and nets tied to cell terminals, are given a fixed color
+// derived from the node number, which anchors the refinement.
+//
+// When the number of distinct colors no longer increases, a net
+// whose color is unique in both circuits is associated directly.
+// The existing matcher then resolves the devices and the remaining,
+// symmetric, nets.
+//
+// Subcircuit instances are not included, as their terminal mapping
+// is not known until the masters are associated.
+
+namespace {
+    // Cells with fewer unassociated devices than this are left to
+    // the iterative matcher.
+    const int SG_MIN_DEVS = 32;
+
+    // Limit on refinement rounds.
+    const int SG_MAX_ROUNDS = 64;
+
+    inline uint64_t sg_fmix(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return (k);
+    }
+
+    inline uint64_t sg_mix(uint64_t h, uint64_t v)
+    {
+        return (sg_fmix(h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) +
+            (h >> 2))));
+    }
+
+    // Growable array.
+    //
+    template <class T>
+    struct sg_buf
+    {
+        sg_buf() : data(0), num(0), size(0) { }
+        ~sg_buf() { delete [] data; }
+
+        void add(T t)
+            {
+                if (num == size) {
+                    size = size ? 2*size : 256;
+                    T *tmp = new T[size];
+                    if (num)
+                        memcpy(tmp, data, num*sizeof(T));
+                    delete [] data;
+                    data = tmp;
+                }
+                data[num++] = t;
+            }
+
+        T *data;
+        int num;
+        int size;
+    };
+
+
+    // The device/net graph for one side.  The contacts of device i
+    // are in [i_start[i], i_start[i+1]) of the c_net and c_cls
+    // arrays.  Nets are identified by group or node number.
+    //
+    struct sg_graph
+    {
+        sg_graph(int nn)
+            {
+                g_nnets = nn;
+                g_ndevs = 0;
+                g_icol = 0;
+                g_ncol = 0;
+                g_nfixed = new int[nn];
+                for (int i = 0; i < nn; i++)
+                    g_nfixed[i] = -1;
+                g_ndeg = new int[nn];
+                memset(g_ndeg, 0, nn*sizeof(int));
+                g_nsum = new uint64_t[nn];
+            }
+
+        ~sg_graph()
+            {
+                delete [] g_icol;
+                delete [] g_ncol;
+                delete [] g_nfixed;
+                delete [] g_ndeg;
+                delete [] g_nsum;
+            }
+
+        void add_dev(uint64_t type)
+            {
+                g_istart.add(g_cnet.num);
+                g_itype.add(type);
+                g_ndevs++;
+            }
+
+        void add_contact(int net, int cls)
+            {
+                if (net < 0 || net >= g_nnets)
+                    return;
+                g_cnet.add(net);
+                g_ccls.add(cls);
+                g_ndeg[net]++;
+            }
+
+        void fix_net(int net, int node)
+            {
+                if (net >= 0 && net < g_nnets)
+                    g_nfixed[net] = node;
+            }
+
+        int degree(int net)     const { return (g_ndeg[net]); }
+        int num_colors()        const;
+        uint64_t color(int net) const { return (g_ncol[net]); }
+
+        void init_colors();
+        void refine();
+        void add_colors(uint64_t*, int*);
+
+    private:
+        sg_buf<int> g_istart;   // Contact start index per device.
+        sg_buf<int> g_cnet;     // Contact net.
+        sg_buf<int> g_ccls;     // Contact terminal class.
+        sg_buf<uint64_t> g_itype; // Device type.
+        uint64_t *g_icol;       // Device color.
+        uint64_t *g_ncol;       // Net color.
+        uint64_t *g_nsum;       // Net color accumulator.
+        int *g_nfixed;          // Associated node, or -1.
+        int *g_ndeg;            // Net connection count.
+        int g_nnets;
+        int g_ndevs;
+    };
+
+
+    void
+    sg_graph::init_colors()
+    {
+        g_istart.add(g_cnet.num);
+        g_icol = new uint64_t[g_ndevs];
+        for (int i = 0; i < g_ndevs; i++) {
+            int nc = g_istart.data[i+1] - g_istart.data[i];
+            g_icol[i] = sg_mix(sg_fmix(g_itype.data[i]), nc);
+        }
+        g_ncol = new uint64_t[g_nnets];
+        for (int i = 0; i < g_nnets; i++) {
+            if (g_nfixed[i] >= 0)
+                g_ncol[i] = sg_mix(0x5a5a5a5aULL, g_nfixed[i]);
+            else
+                g_ncol[i] = sg_mix(0xa5a5a5a5ULL, g_ndeg[i]);
+        }
+    }
+
+
+    // One round of refinement.  The multisets of neighbor colors are
+    // combined with a commutative sum of hashes, so that no sorting
+    // is needed.
+    //
+    void
+    sg_graph::refine()
+    {
+        for (int i = 0; i < g_ndevs; i++) {
+            uint64_t sum = 0;
+            for (int j = g_istart.data[i]; j < g_istart.data[i+1]; j++)
+                sum += sg_fmix(sg_mix(g_ncol[g_cnet.data[j]],
+                    g_ccls.data[j]));
+            g_icol[i] = sg_mix(g_icol[i], sum);
+        }
+        memset(g_nsum, 0, g_nnets*sizeof(uint64_t));
+        for (int i = 0; i < g_ndevs; i++) {
+            for (int j = g_istart.data[i]; j < g_istart.data[i+1]; j++)
+                g_nsum[g_cnet.data[j]] += sg_fmix(sg_mix(g_icol[i],
+                    g_ccls.data[j]));
+        }
+        for (int i = 0; i < g_nnets; i++) {
+            if (g_nfixed[i] < 0)
+                g_ncol[i] = sg_mix(g_ncol[i], g_nsum[i]);
+        }
+    }
+
+
+    // Return the number of colors provided by add_colors.
+    //
+    int
+    sg_graph::num_colors() const
+    {
+        int n = g_ndevs;
+        for (int i = 0; i < g_nnets; i++) {
+            if (g_ndeg[i])
+                n++;
+        }
+        return (n);
+    }
+
+
+    // Append the device and net colors to ary, *pn is the current
+    // count, which is updated.
+    //
+    void
+    sg_graph::add_colors(uint64_t *ary, int *pn)
+    {
+        int n = *pn;
+        for (int i = 0; i < g_ndevs; i++)
+            ary[n++] = g_icol[i];
+        for (int i = 0; i < g_nnets; i++) {
+            if (g_ndeg[i])
+                ary[n++] = g_ncol[i];
+        }
+        *pn = n;
+    }
+
+
+    // Return the electrical terminal class of device contact index
+    // ix, the permutable contacts share a class.
+    //
+    inline int sg_class(int ix, int p1, int p2)
+    {
+        return (ix == p2 ? p1 : ix);
+    }
+
+
+    // Sort element for matching.
+    //
+    struct sg_elt
+    {
+        bool operator<(const sg_elt &e) const
+            {
+                if (color != e.color)
+                    return (color < e.color);
+                return (side < e.side);
+            }
+
+        uint64_t color;
+        int index;
+        int side;       // 0 physical, 1 electrical
+    };
+}
+
+
+// Associate nets that have a unique signature in both the physical
+// and electrical circuits.  Return the number of new associations.
+//
+int
+cGroupDesc::signature_match()
+{
+    if (!gd_etlist || !gd_devices || EX()->isNoSignatureMatch())
+        return (0);
+
+    int ndevs = 0;
+    for (sDevList *dv = gd_devices; dv; dv = dv->next()) {
+        for (sDevPrefixList *p = dv->prefixes(); p; p = p->next()) {
+            for (sDevInst *di = p->devs(); di; di = di->next()) {
+                if (!di->dual())
+                    ndevs++;
+            }
+        }
+    }
+    if (ndevs < SG_MIN_DEVS)
+        return (0);
+
+    int psize = nextindex();
+    int esize = gd_etlist->size();
+    sg_graph pg(psize);
+    sg_graph eg(esize);
+
+    for (int i = 0; i < psize; i++) {
+        int n = gd_groups[i].node();
+        if (n >= 0)
+            pg.fix_net(i, n);
+    }
+    for (int i = 0; i < esize; i++) {
+        if (group_of_node(i) >= 0)
+            eg.fix_net(i, i);
+    }
+
+    for (sDevList *dv = gd_devices; dv; dv = dv->next()) {
+        sDevInst *d0 = dv->prefixes() ? dv->prefixes()->devs() : 0;
+        if (!d0)
+            continue;
+        const sDevDesc *dd = d0->desc();
+        uint64_t dtype = (uintptr_t)dv->devname();
+
+        // Permutable and bulk contact indices, from the description.
+        int p1 = -1, p2 = -1;
+        unsigned int bulkmask = 0;
+        for (sDevContactDesc *c = dd->contacts(); c; c = c->next()) {
+            if (dd->permute_cont1()) {
+                if (c->name() == dd->permute_cont1())
+                    p1 = c->elec_index();
+                else if (c->name() == dd->permute_cont2())
+                    p2 = c->elec_index();
+            }
+            if (c->is_bulk() && c->elec_index() < 32)
+                bulkmask |= (1 << c->elec_index());
+        }
+        if (p1 < 0 || p2 < 0)
+            p1 = p2 = -1;
+
+        for (sDevPrefixList *p = dv->prefixes(); p; p = p->next()) {
+            for (sDevInst *di = p->devs(); di; di = di->next()) {
+                pg.add_dev(dtype);
+                sDevContactInst *ci = di->contacts();
+                for ( ; ci; ci = ci->next()) {
+                    if (ci->desc()->is_bulk())
+                        continue;
+                    int ix = ci->desc()->elec_index();
+                    pg.add_contact(ci->group(), sg_class(ix, p1, p2));
+                }
+            }
+        }
+        for (sEinstList *el = dv->edevs(); el; el = el->next()) {
+            eg.add_dev(dtype);
+            unsigned int sz;
+            const CDp_cnode *const *nodes = el->nodes(&sz);
+            if (!nodes)
+                continue;
+            for (unsigned int ix = 0; ix < sz; ix++) {
+                if (!nodes[ix])
+                    continue;
+                if (ix < 32 && (bulkmask & (1 << ix)))
+                    continue;
+                eg.add_contact(nodes[ix]->enode(), sg_class(ix, p1, p2));
+            }
+            delete [] nodes;
+        }
+    }
+    pg.init_colors();
+    eg.init_colors();
+
+    // Refine until the number of distinct colors stops increasing.
+
+    uint64_t *ary = new uint64_t[pg.num_colors() + eg.num_colors()];
+    int last = 0;
+    int rounds = 0;
+    for ( ; rounds < SG_MAX_ROUNDS; rounds++) {
+        pg.refine();
+        eg.refine();
+        int n = 0;
+        pg.add_colors(ary, &n);
+        eg.add_colors(ary, &n);
+        std::sort(ary, ary + n);
+        int ncolors = std::unique(ary, ary + n) - ary;
+        if (ncolors <= last)
+            break;
+        last = ncolors;
+    }
+    delete [] ary;
+
+    // Collect the unassociated nets, and associate the colors that
+    // appear exactly once on each side.
+
+    sg_elt *elts = new sg_elt[psize + esize];
+    int nelts = 0;
+    for (int i = 1; i < psize; i++) {
+        sGroup &g = gd_groups[i];
+        if (g.node() >= 0 || !pg.degree(i) || g.global() ||
+                g.unas_wire_only())
+            continue;
+        sg_elt &e = elts[nelts++];
+        e.color = pg.color(i);
+        e.index = i;
+        e.side = 0;
+    }
+    for (int i = 1; i < esize; i++) {
+        if (group_of_node(i) >= 0 || !eg.degree(i))
+            continue;
+        sg_elt &e = elts[nelts++];
+        e.color = eg.color(i);
+        e.index = i;
+        e.side = 1;
+    }
+    std::sort(elts, elts + nelts);
+
+    int nassoc = 0;
+    for (int i = 0; i < nelts; ) {
+        int j = i + 1;
+        while (j < nelts && elts[j].color == elts[i].color)
+            j++;
+        if (j - i == 2 && elts[i].side == 0 && elts[i+1].side == 1) {
+            set_association(elts[i].index, elts[i+1].index);
+            nassoc++;
+        }
+        i = j;
+    }
+    delete [] elts;
+
+    ExtErrLog.add_log(ExtLogAssoc,
+        "Signature matching, %d rounds, associated %d groups.",
+        rounds, nassoc);
+    return (nassoc);
+}
+
@@ -109,7 +109,7 @@ void
 ext_bangcmds::antenna(const char *s)
 {
     const char *usage =
-        "Usage: !antenna [layer_name layer_min_ratio]... [min_ratio]";
+        "Usage: !antenna [-s] [layer_name layer_min_ratio]... [min_ratio]";
 
     CDs *sdesc = CDcdb()->findCell(DSP()->CurCellName(), Physical);
     if (!sdesc) {
@@ -181,8 +181,14 @@ ext_bangcmds::antenna(const char *s)
         s = sbak;
         delete [] tok;
     }
+    bool summ = false;
     while ((tok = lstring::gettok(&s)) != 0) {
         double d;
+        if (!strcmp(tok, "-s")) {
+            summ = true;
+            delete [] tok;
+            continue;
+        }
         if ((ld = CDldb()->findLayer(tok, Physical)) != 0) {
             char *tok2 = lstring::gettok(&s);
             if (tok2 && sscanf(tok2, "%lf", &d) == 1 && d >= 0.0) {
@@ -260,11 +266,14 @@ ext_bangcmds::antenna(const char *s)
         fprintf(fp, "Layer: %s  MinRatio: %.6f\n", al->al_lname,
             al->al_max_ratio);
     fprintf(fp, "MinRatio: %.6e\n", apf.limit());
+    if (summ)
+        fprintf(fp, "Mode: summary\n");
     fprintf(fp, "-----------------------------\n");
 
     DSPpkg::self()->SetWorking(true);
 
-    bool ret = apf.find_antennae(sdesc);
+    bool ret = summ ? apf.find_antennae_summ(sdesc) :
+        apf.find_antennae(sdesc);
 
     DSPpkg::self()->SetWorking(false);
 
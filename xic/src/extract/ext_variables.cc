@@ -341,6 +341,15 @@ namespace {
         return (true);
     }
 
+    bool
+    evNoSignatureMatch(const char*, bool set)
+    {
+        if (EX()->isNoSignatureMatch() != set)
+            EX()->invalidateGroups();
+        EX()->setNoSignatureMatch(set);
+        return (true);
+    }
+
     bool
     evPinLayer(const char*, bool)
     {
@@ -681,6 +690,25 @@ namespace {
         return (true);
     }
 
+    bool
+    evFcWindow(const char *vstring, bool set)
+    {
+        if (set) {
+            double d, t;
+            int n = sscanf(vstring, "%lf %lf", &d, &t);
+            if (n < 1 || d < FC_WINDOW_MIN || d > FC_WINDOW_MAX ||
+                    (n == 2 && t < d)) {
+                Log()->ErrorLogV(mh::Variables,
+                    "Incorrect FcWindow: coupling distance range "
+                    "%g - %g,\noptional tile size not less than "
+                    "coupling distance.", FC_WINDOW_MIN, FC_WINDOW_MAX);
+                return (false);
+            }
+        }
+        CDvdb()->registerPostFunc(post_fc);
+        return (true);
+    }
+
     bool
     evFcZoids(const char*, bool set)
     {
@@ -861,6 +889,7 @@ cExt::setupVariables()
     vsetup(VA_MergeMatchingNamed,   B,  evMergeMatchingNamed);
     vsetup(VA_MergePhysContacts,    B,  evMergePhysContacts);
     vsetup(VA_NoPermute,            B,  evNoPermute);
+    vsetup(VA_NoSignatureMatch,     B,  evNoSignatureMatch);
     vsetup(VA_PinLayer,             S,  evPinLayer);
     vsetup(VA_PinPurpose,           S,  evPinPurpose);
     vsetup(VA_RLSolverDelta,        S,  evRLSolverDelta);
@@ -912,6 +941,7 @@ cExt::setupVariables()
     vsetup(VA_FcPath,               S,  evFC);
     vsetup(VA_FcPlaneBloat,         S,  evFcPlaneBloat);
     vsetup(VA_FcUnits,              S,  evFC);
+    vsetup(VA_FcWindow,             S,  evFcWindow);
     vsetup(VA_FcZoids,              B,  evFcZoids);
 
     // FastHenry Interface
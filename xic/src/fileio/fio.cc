@@ -153,6 +153,7 @@ cFIO::cFIO()
     fioOasWriteNoGCDcheck = false;
     fioOasWriteUseFastSort = false;
     fioOasWritePrptyMask = 0;
+    fioOasWriteThreads = 0;
     fioWriteMacroProps = false;
 
     // Default parameters when reading into the database.  Unit scale,
@@ -51,6 +51,97 @@
 #include "geo_zlist.h"
 #include "miscutil/filestat.h"
 #include <ctype.h>
+#include <pthread.h>
+
+
+// Pipeline for CBLOCK compression, used when OasWriteThreads is
+// nonzero.  Rather than compressing each cell inline, the encoded
+// cell records are queued in memory, and a pool of threads deflates
+// the queued cells while the main thread continues encoding.  The
+// main thread writes the blocks to the file strictly in order, as
+// they become available, so that the file content is the same as
+// would be produced inline.
+
+// Stop and wait for the compressors when this many uncompressed
+// bytes per thread are queued.
+#define ZP_QUEUE_MAX    (64 << 20)
+
+// Queue element, one per CBLOCK candidate or run of plain output.
+//
+struct oas_zblk
+{
+    // Block states.
+    enum { ZBopen, ZBraw, ZBqueued, ZBdone, ZBfail };
+
+    oas_zblk()
+        {
+            zb_ubuf = 0;
+            zb_cbuf = 0;
+            zb_usize = 0;
+            zb_ualloc = 0;
+            zb_csize = 0;
+            zb_next = 0;
+            zb_jnext = 0;
+            zb_state = ZBopen;
+        }
+
+    ~oas_zblk()
+        {
+            delete [] zb_ubuf;
+            delete [] zb_cbuf;
+        }
+
+    void grow();
+    bool compress();
+
+    unsigned char *zb_ubuf;     // uncompressed data
+    unsigned char *zb_cbuf;     // compressed data
+    uint64_t zb_usize;          // uncompressed size
+    uint64_t zb_ualloc;         // allocated size of zb_ubuf
+    uint64_t zb_csize;          // compressed size
+    oas_zblk *zb_next;          // output order link
+    oas_zblk *zb_jnext;         // compression queue link
+    int zb_state;               // block state
+};
+
+struct oas_zpipe
+{
+    oas_zpipe(FILE*, int, bool);
+    ~oas_zpipe();
+
+    bool start();
+    void begin_block();
+    bool end_block();
+    bool finish();
+
+    void put(int c)
+        {
+            oas_zblk *b = zp_tail;
+            if (b->zb_usize == b->zb_ualloc)
+                b->grow();
+            b->zb_ubuf[b->zb_usize++] = c;
+        }
+
+private:
+    bool write_ready(uint64_t);
+    bool write_block(oas_zblk*);
+    static void *thread_proc(void*);
+
+    FILE *zp_fp;                // output file
+    oas_zblk *zp_head;          // oldest unwritten block
+    oas_zblk *zp_tail;          // block being filled
+    oas_zblk *zp_jobs;          // compression queue head
+    oas_zblk *zp_jtail;         // compression queue tail
+    pthread_t *zp_threads;      // compression threads
+    int zp_nthreads;            // number of threads
+    int zp_nstarted;            // number of threads running
+    uint64_t zp_queued;         // uncompressed bytes awaiting compression
+    pthread_mutex_t zp_mtx;
+    pthread_cond_t zp_cv_work;  // signals compressors
+    pthread_cond_t zp_cv_done;  // signals writer
+    bool zp_force;              // compress all blocks (OAScompForce)
+    bool zp_quit;               // compressor shutdown flag
+};
 
 
 // Convert the hierarchies under the named symbols to OASIS format
@@ -230,6 +321,7 @@ oas_out::oas_out(cCGD *cgd)
     out_modal = &out_default_modal;
     out_zfile = 0;
     out_cache = 0;
+    out_zpipe = 0;
     out_compr_buf = 0;
     if (use_cgd)
         out_rep_args = lstring::copy("");
@@ -266,6 +358,7 @@ oas_out::oas_out(cCGD *cgd)
     else
         out_use_compression = FIO()->OasWriteCompressed();
     out_compressing = false;
+    out_zthreads = use_cgd ? 0 : FIO()->OasWriteThreads();
     out_use_tables = use_cgd ? true : FIO()->IsOasWriteNameTab();
 
     if (use_cgd)
@@ -286,6 +379,7 @@ oas_out::~oas_out()
 
     if (out_zfile)
         delete out_zfile;
+    delete out_zpipe;
     if (out_fp)
         fclose(out_fp);
     if (out_tmp_fp)
@@ -436,6 +530,8 @@ oas_out::set_destination(FILE *fp, void **new_cx, void **old_cx)
         else
             memcpy((void*)out_modal, *new_cx, sizeof(oas_modal));
     }
+    if (!flush_zpipe())
+        return (false);
     out_fp = fp;
     return (true);
 }
@@ -1745,6 +1841,8 @@ oas_out::write_endlib(const char*)
     }
     if (out_cgd)
         return (true);
+    if (!flush_zpipe())
+        return (false);
     if (!write_tables())
         return (false);
 
@@ -2233,6 +2331,13 @@ oas_out::write_char(int c)
         }
         return (true);
     }
+    if (out_zpipe) {
+        // All output is queued while the compression threads are
+        // active.
+        out_zpipe->put(c);
+        out_byte_count++;
+        return (true);
+    }
     if (out_compressing) {
         if (out_zfile) {
             if (out_zfile->zio_putc(c) == EOF) {
@@ -3519,6 +3624,25 @@ oas_out::begin_compression(const char *cellname)
             "begin_compression: internal, already compressing!");
         return (false);
     }
+    if (cellname && out_zthreads) {
+        // Cell content is compressed in the pipeline.  The tables
+        // (null cellname) are written after the pipeline is
+        // flushed, since their offsets are needed.
+
+        if (!out_zpipe) {
+            out_zpipe = new oas_zpipe(out_fp, out_zthreads,
+                out_use_compression == OAScompForce);
+            if (!out_zpipe->start()) {
+                delete out_zpipe;
+                out_zpipe = 0;
+                Errs()->add_error(
+                    "begin_compression: thread creation failed.");
+                return (false);
+            }
+        }
+        out_zpipe->begin_block();
+        return (true);
+    }
     out_comp_start = large_ftell(out_fp);
     out_byte_count = out_comp_start;  // should already be equal
     out_compressing = true;
@@ -3544,6 +3668,8 @@ oas_out::end_compression()
         return (true);
     }
 
+    if (out_zpipe)
+        return (out_zpipe->end_block());
     if (!out_compressing)
         return (true);
     out_compressing = false;
@@ -3589,6 +3715,23 @@ oas_out::end_compression()
 }
 
 
+// Write everything queued in the compression pipeline and shut it
+// down.  This must be called before the file position is used.
+//
+bool
+oas_out::flush_zpipe()
+{
+    if (!out_zpipe)
+        return (true);
+    bool ret = out_zpipe->finish();
+    delete out_zpipe;
+    out_zpipe = 0;
+    if (ret)
+        out_byte_count = large_ftell(out_fp);
+    return (ret);
+}
+
+
 // If using repetitions, the objects are dumped here.
 //
 bool
@@ -3763,3 +3906,327 @@ oas_out::set_layer_dt(int l, int d, int *pl, int *pd)
         out_modal = out_lmux->set_layer(l, d);
 }
 
+
+//-----------------------------------------------------------------------------
+// oas_zblk functions
+
+// Expand the uncompressed buffer.
+//
+void
+oas_zblk::grow()
+{
+    uint64_t sz = zb_ualloc ? 2*zb_ualloc : 4096;
+    unsigned char *nbuf = new unsigned char[sz];
+    if (zb_usize)
+        memcpy(nbuf, zb_ubuf, zb_usize);
+    delete [] zb_ubuf;
+    zb_ubuf = nbuf;
+    zb_ualloc = sz;
+}
+
+
+// Deflate the uncompressed data into zb_cbuf.  The compressor is set
+// up as in zio_stream::zio_open.  This is called in a compression
+// thread.
+//
+bool
+oas_zblk::compress()
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    int err = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+        -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    if (err != Z_OK)
+        return (false);
+
+    // zlib counts are 32 bits, feed large blocks in pieces.
+    const uint64_t zmax = 0x40000000;
+    uint64_t asize = zb_usize/2 + 1024;
+    zb_cbuf = new unsigned char[asize];
+    zb_csize = 0;
+    uint64_t nin = 0;
+    int flush = Z_NO_FLUSH;
+    for (;;) {
+        if (strm.avail_in == 0 && flush == Z_NO_FLUSH) {
+            uint64_t n = zb_usize - nin;
+            if (n > zmax)
+                n = zmax;
+            strm.next_in = zb_ubuf + nin;
+            strm.avail_in = n;
+            nin += n;
+            if (nin == zb_usize)
+                flush = Z_FINISH;
+        }
+        if (zb_csize == asize) {
+            unsigned char *nbuf = new unsigned char[2*asize];
+            memcpy(nbuf, zb_cbuf, zb_csize);
+            delete [] zb_cbuf;
+            zb_cbuf = nbuf;
+            asize *= 2;
+        }
+        uint64_t n = asize - zb_csize;
+        if (n > zmax)
+            n = zmax;
+        strm.next_out = zb_cbuf + zb_csize;
+        strm.avail_out = n;
+        err = deflate(&strm, flush);
+        zb_csize += n - strm.avail_out;
+        if (err == Z_STREAM_END)
+            break;
+        if (err != Z_OK && err != Z_BUF_ERROR) {
+            deflateEnd(&strm);
+            return (false);
+        }
+    }
+    deflateEnd(&strm);
+
+    // The uncompressed data are no longer needed.
+    delete [] zb_ubuf;
+    zb_ubuf = 0;
+    zb_ualloc = 0;
+    return (true);
+}
+// End of oas_zblk functions.
+
+
+//-----------------------------------------------------------------------------
+// oas_zpipe functions
+
+oas_zpipe::oas_zpipe(FILE *fp, int nthr, bool force)
+{
+    zp_fp = fp;
+    zp_head = new oas_zblk;
+    zp_tail = zp_head;
+    zp_jobs = 0;
+    zp_jtail = 0;
+    zp_threads = new pthread_t[nthr];
+    zp_nthreads = nthr;
+    zp_nstarted = 0;
+    zp_queued = 0;
+    pthread_mutex_init(&zp_mtx, 0);
+    pthread_cond_init(&zp_cv_work, 0);
+    pthread_cond_init(&zp_cv_done, 0);
+    zp_force = force;
+    zp_quit = false;
+}
+
+
+oas_zpipe::~oas_zpipe()
+{
+    pthread_mutex_lock(&zp_mtx);
+    zp_quit = true;
+    pthread_cond_broadcast(&zp_cv_work);
+    pthread_mutex_unlock(&zp_mtx);
+    for (int i = 0; i < zp_nstarted; i++)
+        pthread_join(zp_threads[i], 0);
+    delete [] zp_threads;
+
+    while (zp_head) {
+        oas_zblk *b = zp_head;
+        zp_head = zp_head->zb_next;
+        delete b;
+    }
+    pthread_mutex_destroy(&zp_mtx);
+    pthread_cond_destroy(&zp_cv_work);
+    pthread_cond_destroy(&zp_cv_done);
+}
+
+
+// Start the compression threads.
+//
+bool
+oas_zpipe::start()
+{
+    while (zp_nstarted < zp_nthreads) {
+        if (pthread_create(&zp_threads[zp_nstarted], 0, thread_proc, this))
+            break;
+        zp_nstarted++;
+    }
+    return (zp_nstarted > 0);
+}
+
+
+// Close the plain output block and start a block to contain the
+// CBLOCK data.
+//
+void
+oas_zpipe::begin_block()
+{
+    zp_tail->zb_state = oas_zblk::ZBraw;
+    zp_tail->zb_next = new oas_zblk;
+    zp_tail = zp_tail->zb_next;
+}
+
+
+// Close the CBLOCK candidate and queue it for compression.  As in
+// the inline code, short blocks are not compressed unless forcing. 
+// Any blocks ready to go are written.
+//
+bool
+oas_zpipe::end_block()
+{
+    oas_zblk *b = zp_tail;
+    zp_tail->zb_next = new oas_zblk;
+    zp_tail = zp_tail->zb_next;
+
+    if (!b->zb_usize || (!zp_force && b->zb_usize <= CGD_COMPR_BUFSIZE))
+        b->zb_state = oas_zblk::ZBraw;
+    else {
+        pthread_mutex_lock(&zp_mtx);
+        b->zb_state = oas_zblk::ZBqueued;
+        if (zp_jtail)
+            zp_jtail->zb_jnext = b;
+        else
+            zp_jobs = b;
+        zp_jtail = b;
+        zp_queued += b->zb_usize;
+        pthread_cond_signal(&zp_cv_work);
+        pthread_mutex_unlock(&zp_mtx);
+    }
+
+    // Keep the memory use bounded.
+    return (write_ready((uint64_t)zp_nthreads*ZP_QUEUE_MAX));
+}
+
+
+// Write out everything, waiting for the compressors as necessary.
+//
+bool
+oas_zpipe::finish()
+{
+    zp_tail->zb_state = oas_zblk::ZBraw;
+    if (!write_ready(0))
+        return (false);
+    if (fflush(zp_fp) == EOF) {
+        Errs()->sys_error("write");
+        Errs()->add_error("write error, file system full?");
+        return (false);
+    }
+    return (true);
+}
+
+
+// Write the blocks at the head of the list that are complete.  If
+// the count of bytes waiting for compression exceeds limit, wait for
+// the compressors.  With a zero limit, all closed blocks are written.
+// Only the main thread modifies zp_queued.
+//
+bool
+oas_zpipe::write_ready(uint64_t limit)
+{
+    while (zp_head != zp_tail || zp_head->zb_state == oas_zblk::ZBraw) {
+        oas_zblk *b = zp_head;
+        pthread_mutex_lock(&zp_mtx);
+        while (b->zb_state == oas_zblk::ZBqueued && zp_queued > limit)
+            pthread_cond_wait(&zp_cv_done, &zp_mtx);
+        int state = b->zb_state;
+        if (state == oas_zblk::ZBdone)
+            zp_queued -= b->zb_usize;
+        pthread_mutex_unlock(&zp_mtx);
+
+        if (state == oas_zblk::ZBqueued)
+            break;
+        if (state == oas_zblk::ZBfail) {
+            Errs()->add_error("CBLOCK compression failed.");
+            return (false);
+        }
+        if (!write_block(b))
+            return (false);
+        if (b == zp_tail) {
+            // Only in finish.
+            b->zb_usize = 0;
+            b->zb_state = oas_zblk::ZBopen;
+            break;
+        }
+        zp_head = b->zb_next;
+        delete b;
+    }
+    return (true);
+}
+
+
+namespace {
+    // Encode an OASIS unsigned integer into buf, return the byte
+    // count.
+    //
+    int
+    encode_unsigned64(unsigned char *buf, uint64_t i)
+    {
+        int n = 0;
+        for (;;) {
+            unsigned char b = i & 0x7f;
+            i >>= 7;
+            if (!i) {
+                buf[n++] = b;
+                break;
+            }
+            buf[n++] = b | 0x80;
+        }
+        return (n);
+    }
+}
+
+
+// Write a block to the file, with a CBLOCK header if compressed.
+//
+bool
+oas_zpipe::write_block(oas_zblk *b)
+{
+    if (b->zb_state == oas_zblk::ZBdone) {
+        // CBLOCK: '34' '0' u-count c-count bytes
+        unsigned char hdr[24];
+        int n = 0;
+        hdr[n++] = 34;
+        hdr[n++] = 0;
+        n += encode_unsigned64(hdr + n, b->zb_usize);
+        n += encode_unsigned64(hdr + n, b->zb_csize);
+        if (fwrite(hdr, 1, n, zp_fp) != (size_t)n ||
+                fwrite(b->zb_cbuf, 1, b->zb_csize, zp_fp) != b->zb_csize) {
+            Errs()->sys_error("write");
+            Errs()->add_error("write error, file system full?");
+            return (false);
+        }
+    }
+    else if (b->zb_usize) {
+        if (fwrite(b->zb_ubuf, 1, b->zb_usize, zp_fp) != b->zb_usize) {
+            Errs()->sys_error("write");
+            Errs()->add_error("write error, file system full?");
+            return (false);
+        }
+    }
+    return (true);
+}
+
+
+// Static function.
+// Compression thread, take blocks from the queue and compress until
+// told to quit.
+//
+void *
+oas_zpipe::thread_proc(void *arg)
+{
+    oas_zpipe *zp = (oas_zpipe*)arg;
+    for (;;) {
+        pthread_mutex_lock(&zp->zp_mtx);
+        while (!zp->zp_jobs && !zp->zp_quit)
+            pthread_cond_wait(&zp->zp_cv_work, &zp->zp_mtx);
+        if (zp->zp_quit) {
+            pthread_mutex_unlock(&zp->zp_mtx);
+            break;
+        }
+        oas_zblk *b = zp->zp_jobs;
+        zp->zp_jobs = b->zb_jnext;
+        if (!zp->zp_jobs)
+            zp->zp_jtail = 0;
+        pthread_mutex_unlock(&zp->zp_mtx);
+
+        bool ok = b->compress();
+
+        pthread_mutex_lock(&zp->zp_mtx);
+        b->zb_state = ok ? oas_zblk::ZBdone : oas_zblk::ZBfail;
+        pthread_cond_broadcast(&zp->zp_cv_done);
+        pthread_mutex_unlock(&zp->zp_mtx);
+    }
+    return (0);
+}
+// End of oas_zpipe functions.
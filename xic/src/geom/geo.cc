@@ -56,6 +56,7 @@ cGEO::cGEO()
     geoElecRoundSides = DEF_RoundFlashSides;
     geoPhysRoundSides = DEF_RoundFlashSides;
     geoUseSclFuncs = false;
+    geoZlSweepMode = ZSoff;
 
     new cGEOmmgr;   // Memory manager.
 }
@@ -206,8 +206,8 @@ namespace {
 
 
 // Unset "deferred mode", sort the objects, and create the actual
-// database tree.  Adding object in sorted order can be much faster
-// than adding objects in arbitrary order.
+// database tree.  The tree is built by packing the sorted objects,
+// see RTree::load.
 //
 bool
 RTree::unset_deferred()
@@ -228,24 +228,93 @@ RTree::unset_deferred()
             break;
         ary[cnt++] = rt;
     }
-    std::sort(ary, ary + cnt, rt_cmp);
+    for (unsigned int i = 0; i < cnt; i++) {
+        ary[i]->e_right = 0;
+        ary[i]->e_up = 0;
+    }
 
     rt_root = 0;
     rt_allocated = 0;
     rt_deferred = false;
 
-    bool ok = true;
-    for (unsigned int i = 0; i < cnt; i++) {
-        ary[i]->e_right = 0;
-        ary[i]->e_up = 0;
-        if (!insert_prv(ary[i]))
-            ok = false;
-    }
+    bool ok = load(ary, cnt);
     delete [] ary;
     return (ok);
 }
 
 
+// Bulk-load the cnt objects in ary into the tree, which must be
+// empty.  The array is sorted into database order and used as
+// scratch space, the caller should free it.
+//
+// Rather than inserting the objects one at a time, the tree is built
+// bottom-up.  The sorted objects are divided into runs of at most
+// e_maxlinks, each run becoming the children of a new node, and the
+// process is repeated on the new nodes until a single root remains.
+// The runs at a level are made as nearly equal in length as
+// possible, which keeps every node above e_minlinks.  Since the tree
+// is ordered (descending top, ascending left), the tiling used by
+// the sort-tile-recursive method would break the ordering the
+// generators depend on, but the packing of sorted objects gives full
+// nodes and adjacent, mostly non-overlapping node boxes, in a
+// fraction of the time of incremental insertion.
+//
+bool
+RTree::load(RTelem **ary, unsigned int cnt)
+{
+    if (rt_root || rt_deferred)
+        return (false);
+    if (!cnt)
+        return (true);
+    for (unsigned int i = 0; i < cnt; i++) {
+        RTelem *rd = ary[i];
+        if (!rd || rd->e_up || rd->e_right || !rd->is_leaf())
+            return (false);
+    }
+    std::sort(ary, ary + cnt, rt_cmp);
+
+    // Each new node consumes at least one entry before it is written
+    // back, so the array can be reused in place for the next level.
+
+    unsigned int maxl = RTelem::e_maxlinks;
+    unsigned int n = cnt;
+    while (n > 1) {
+        unsigned int nn = (n + maxl - 1)/maxl;
+        unsigned int per = n/nn;
+        unsigned int xtra = n%nn;
+        unsigned int k = 0;
+        for (unsigned int j = 0; j < nn; j++) {
+            unsigned int nc = per + (j < xtra ? 1 : 0);
+            RTelem *rn = new RTelem;
+            RTelem *rp = 0;
+            for (unsigned int c = 0; c < nc; c++) {
+                RTelem *rt = ary[k++];
+                rt->e_up = rn;
+                if (!rp) {
+                    rn->e_children = rt;
+                    rn->e_BB = rt->e_BB;
+                }
+                else {
+                    rp->e_right = rt;
+                    rn->e_BB.add(&rt->e_BB);
+                }
+                rp = rt;
+            }
+            rn->e_nchildren = nc;
+            ary[j] = rn;
+        }
+        n = nn;
+    }
+    rt_root = ary[0];
+    rt_root->set_parent(RT_ROOT_UP);
+    rt_allocated = cnt;
+#ifdef RT_DEBUG
+    test();
+#endif
+    return (true);
+}
+
+
 // Remove rd from the tree.
 //
 bool
@@ -351,6 +420,9 @@ RTree::remove(RTelem *rd)
                 rt = rt->sibling();
             rt->set_sibling(r0);
             rprev->set_count(xcnt + cnt);
+
+            // The previous node may have a different parent.
+            rprev->expand_bb_to_root();
         }
         if (rnext && r->children()) {
             int xcnt = rnext->get_count();
@@ -371,6 +443,7 @@ RTree::remove(RTelem *rd)
                 r0 = r0->sibling();
             r0->set_sibling(rt);
             rnext->set_count(xcnt + cnt);
+            rnext->expand_bb_to_root();
         }
 
         p = r->parent();
@@ -608,7 +608,7 @@ Ylist::slice(Ylist *thisyl, const int *scans, int nscans) THROW_XIrt
 // representation where each zoid is as wide as possible.
 //
 // This will process the trapezoids by group, which is generally far
-// more efficient.
+// more efficient.  In ZSon mode, the sweep engine is used instead.
 //
 // On interrupt, 'this' is freed.
 //
@@ -617,6 +617,19 @@ Ylist::repartition(Ylist *thisyl) THROW_XIrt
 {
     TimeDbgAccum ac("repartition");
 
+    if (GEO()->zlSweepMode() == ZSon) {
+        Zlist *z0 = to_zlist(thisyl);
+        try {
+            Zlist *zl = Zlist::sweep(z0, 0, ZSor);
+            Zlist::destroy(z0);
+            return (zl);
+        }
+        catch (XIrt) {
+            Zlist::destroy(z0);
+            throw;
+        }
+    }
+
     Ylist *yl0 = thisyl;
     Zlist *zl0 = 0;
 
@@ -0,0 +1,234 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "cd.h"
+#include "geo_zlist.h"
+#include "geo_zbatch.h"
+#include <limits.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ZB_X86
+#include <immintrin.h>
+#endif
+
+
+//
+// Batched zoid extent tests.
+//
+
+namespace {
+    // The reference extent, adjusted so that all comparisons are
+    // strict.  A zoid k is a candidate if
+    //   yl[k] < yu && yu[k] > yl && xmin[k] < xmax && xmax[k] > xmin
+    //
+    struct zbref_t
+    {
+        zbref_t(const Zoid *Z, bool touchok)
+            {
+                int t = touchok ? 1 : 0;
+                yl = Z->yl - t;
+                yu = Z->yu + t;
+                xmin = Z->minleft() - t;
+                xmax = Z->maxright() + t;
+            }
+
+        int yl, yu, xmin, xmax;
+    };
+
+
+    unsigned int
+    ovl_scalar(const int *yl, const int *yu, const int *xmin,
+        const int *xmax, const zbref_t &r)
+    {
+        unsigned int m = 0;
+        for (int k = 0; k < ZB_LANES; k++) {
+            if (yl[k] < r.yu && yu[k] > r.yl && xmin[k] < r.xmax &&
+                    xmax[k] > r.xmin)
+                m |= 1 << k;
+        }
+        return (m);
+    }
+
+
+#ifdef ZB_X86
+#ifdef __SSE2__
+    unsigned int
+    ovl_sse2(const int *yl, const int *yu, const int *xmin,
+        const int *xmax, const zbref_t &r)
+    {
+        __m128i ryl = _mm_set1_epi32(r.yl);
+        __m128i ryu = _mm_set1_epi32(r.yu);
+        __m128i rxmin = _mm_set1_epi32(r.xmin);
+        __m128i rxmax = _mm_set1_epi32(r.xmax);
+        unsigned int m = 0;
+        for (int k = 0; k < ZB_LANES; k += 4) {
+            __m128i a = _mm_cmplt_epi32(
+                _mm_loadu_si128((const __m128i*)(yl + k)), ryu);
+            a = _mm_and_si128(a, _mm_cmpgt_epi32(
+                _mm_loadu_si128((const __m128i*)(yu + k)), ryl));
+            a = _mm_and_si128(a, _mm_cmplt_epi32(
+                _mm_loadu_si128((const __m128i*)(xmin + k)), rxmax));
+            a = _mm_and_si128(a, _mm_cmpgt_epi32(
+                _mm_loadu_si128((const __m128i*)(xmax + k)), rxmin));
+            m |= _mm_movemask_ps(_mm_castsi128_ps(a)) << k;
+        }
+        return (m);
+    }
+#endif
+
+
+    __attribute__((target("avx2"))) unsigned int
+    ovl_avx2(const int *yl, const int *yu, const int *xmin,
+        const int *xmax, const zbref_t &r)
+    {
+        __m256i a = _mm256_cmpgt_epi32(_mm256_set1_epi32(r.yu),
+            _mm256_loadu_si256((const __m256i*)yl));
+        a = _mm256_and_si256(a, _mm256_cmpgt_epi32(
+            _mm256_loadu_si256((const __m256i*)yu), _mm256_set1_epi32(r.yl)));
+        a = _mm256_and_si256(a, _mm256_cmpgt_epi32(
+            _mm256_set1_epi32(r.xmax),
+            _mm256_loadu_si256((const __m256i*)xmin)));
+        a = _mm256_and_si256(a, _mm256_cmpgt_epi32(
+            _mm256_loadu_si256((const __m256i*)xmax),
+            _mm256_set1_epi32(r.xmin)));
+        return (_mm256_movemask_ps(_mm256_castsi256_ps(a)));
+    }
+#endif
+
+
+    typedef unsigned int(*ovlfunc_t)(const int*, const int*, const int*,
+        const int*, const zbref_t&);
+
+    // Choose the kernel for this CPU.
+    //
+    ovlfunc_t
+    ovl_func()
+    {
+#ifdef ZB_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return (ovl_avx2);
+#ifdef __SSE2__
+        return (ovl_sse2);
+#endif
+#endif
+        return (ovl_scalar);
+    }
+
+    ovlfunc_t zb_ovl = ovl_func();
+}
+
+
+Zbatch::Zbatch(const Zlist *zl0)
+{
+    zb_num = Zlist::length(zl0);
+    zb_size = ((zb_num + ZB_LANES - 1)/ZB_LANES)*ZB_LANES;
+    zb_yl = new int[4*zb_size];
+    zb_yu = zb_yl + zb_size;
+    zb_xmin = zb_yu + zb_size;
+    zb_xmax = zb_xmin + zb_size;
+    zb_zoids = new const Zoid*[zb_size];
+    zb_BB = CDnullBB;
+
+    int i = 0;
+    for (const Zlist *z = zl0; z; z = z->next, i++) {
+        zb_yl[i] = z->Z.yl;
+        zb_yu[i] = z->Z.yu;
+        zb_xmin[i] = z->Z.minleft();
+        zb_xmax[i] = z->Z.maxright();
+        zb_zoids[i] = &z->Z;
+        BBox tBB;
+        z->Z.BB(&tBB);
+        zb_BB.add(&tBB);
+    }
+
+    // Padding, masked out in the tests.
+    for ( ; i < zb_size; i++) {
+        zb_yl[i] = INT_MAX;
+        zb_yu[i] = INT_MIN;
+        zb_xmin[i] = INT_MAX;
+        zb_xmax[i] = INT_MIN;
+        zb_zoids[i] = 0;
+    }
+}
+
+
+Zbatch::~Zbatch()
+{
+    delete [] zb_yl;
+    delete [] zb_zoids;
+}
+
+
+// Return true if one of the zoids intersects Z, as per
+// Zoid::intersect.
+//
+bool
+Zbatch::intersect(const Zoid *Z, bool touchok) const
+{
+    if (!zb_num)
+        return (false);
+    if (touchok) {
+        if (Z->yl > zb_BB.top || Z->yu < zb_BB.bottom ||
+                Z->minleft() > zb_BB.right || Z->maxright() < zb_BB.left)
+            return (false);
+    }
+    else {
+        if (Z->yl >= zb_BB.top || Z->yu <= zb_BB.bottom ||
+                Z->minleft() >= zb_BB.right || Z->maxright() <= zb_BB.left)
+            return (false);
+    }
+
+    zbref_t r(Z, touchok);
+    for (int i = 0; i < zb_size; i += ZB_LANES) {
+        unsigned int m = (*zb_ovl)(zb_yl + i, zb_yu + i, zb_xmin + i,
+            zb_xmax + i, r);
+        if (zb_num - i < ZB_LANES)
+            m &= (1u << (zb_num - i)) - 1;
+        while (m) {
+            int k = __builtin_ctz(m);
+            if (zb_zoids[i + k]->intersect(Z, touchok))
+                return (true);
+            m &= m - 1;
+        }
+    }
+    return (false);
+}
+
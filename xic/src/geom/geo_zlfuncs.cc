@@ -40,6 +40,7 @@
 
 #include "cd.h"
 #include "geo_ylist.h"
+#include "geo_zbatch.h"
 #include "miscutil/timedbg.h"
 
 
@@ -50,6 +51,117 @@
 // Enable the old "safe clipping" mode for debugging.
 //#define SCLDEBUG
 
+namespace {
+    // Set while the Ylist functions run in ZScheck mode.
+    __thread bool zs_busy;
+
+    // Return true if the operations should use the sweep engine,
+    // either for the result or for checking.
+    //
+    inline bool use_sweep()
+    {
+        return (GEO()->zlSweepMode() != ZSoff && !zs_busy);
+    }
+
+
+    // Return the result of the operation in *zl1p, using the sweep
+    // engine.  The sources are consumed, also on exception.
+    //
+    XIrt
+    zs_sweep(Zlist **zl1p, Zlist *zl2, ZSop op)
+    {
+        try {
+            Zlist *zr = Zlist::sweep(*zl1p, zl2, op);
+            Zlist::destroy(*zl1p);
+            Zlist::destroy(zl2);
+            *zl1p = zr;
+            return (XIok);
+        }
+        catch (XIrt ret) {
+            Zlist::destroy(*zl1p);
+            Zlist::destroy(zl2);
+            *zl1p = 0;
+            return (ret);
+        }
+    }
+
+
+    // Return the result of the operation in *zl1p.  In ZSon mode,
+    // use the sweep engine, otherwise call func and compare its
+    // result with the sweep result.
+    //
+    XIrt
+    zs_dispatch(Zlist **zl1p, Zlist *zl2, ZSop op, const char *name,
+        XIrt(*func)(Zlist**, Zlist*))
+    {
+        if (GEO()->zlSweepMode() == ZSon)
+            return (zs_sweep(zl1p, zl2, op));
+
+        Zlist *za = Zlist::copy(*zl1p);
+        Zlist *zb = Zlist::copy(zl2);
+        zs_busy = true;
+        XIrt ret = (*func)(zl1p, zl2);
+        zs_busy = false;
+        if (ret == XIok)
+            Zlist::sweep_check(za, zb, op, *zl1p, name);
+        Zlist::destroy(za);
+        Zlist::destroy(zb);
+        return (ret);
+    }
+
+
+    // As above, for the "self" operations.
+    //
+    XIrt
+    zs_dispatch(Zlist **zp, ZSop op, const char *name,
+        XIrt(*func)(Zlist**))
+    {
+        if (GEO()->zlSweepMode() == ZSon)
+            return (zs_sweep(zp, 0, op));
+
+        Zlist *za = Zlist::copy(*zp);
+        zs_busy = true;
+        XIrt ret = (*func)(zp);
+        zs_busy = false;
+        if (ret == XIok)
+            Zlist::sweep_check(za, 0, op, *zp, name);
+        Zlist::destroy(za);
+        return (ret);
+    }
+}
+
+
+// Static function.
+// Compare res, the result of the operation on the lists from the
+// Ylist functions, with the sweep result, and log the difference if
+// not empty.  Rounding slivers along non-Manhattan edges are
+// ignored.  This is for the ZScheck mode.
+//
+void
+Zlist::sweep_check(const Zlist *zla, const Zlist *zlb, ZSop op,
+    const Zlist *res, const char *opname)
+{
+    Zlist *zx = 0;
+    try {
+        Zlist *zs = sweep(zla, zlb, op);
+        zx = sweep(zs, res, ZSxor);
+        Zlist::destroy(zs);
+    }
+    catch (XIrt) {
+        return;
+    }
+    zx = Zlist::filter_slivers(zx, 2);
+    if (zx) {
+        BBox BB;
+        Zlist::BB(zx, BB);
+        GEO()->ifInfoMessage(IFMSG_LOG_WARN,
+            "Sweep check for %s: %d zoids differ, area %g, in %d,%d %d,%d.",
+            opname, Zlist::length(zx), Zlist::area(zx),
+            BB.left, BB.bottom, BB.right, BB.top);
+        Zlist::destroy(zx);
+    }
+}
+
 
 // Static function.
 // Check whether or not the lists intersect.  The lists are destroyed.
@@ -78,6 +190,39 @@ Zlist::zl_intersect(Zlist *zl1, Zlist *zl2, bool touchok)
 }
 
 
+// Static function.
+// Return true if a zoid in thiszl intersects a zoid in zl.  Unlike
+// zl_intersect, the lists are not consumed or sorted.  If thiszl has
+// more than one zoid and zl is not short, the extents of zl are put
+// in a Zbatch, so that each zoid of thiszl is screened against
+// several zoids of zl at a time.
+//
+bool
+Zlist::intersect(const Zlist *thiszl, const Zlist *zl, bool touchok)
+{
+    if (!thiszl || !zl)
+        return (false);
+    int n = 0;
+    for (const Zlist *z = zl; z && n < ZB_LANES; z = z->next, n++) ;
+    if (!thiszl->next || n < ZB_LANES) {
+        for (const Zlist *z = thiszl; z; z = z->next) {
+            if (Zlist::intersect(zl, &z->Z, touchok))
+                return (true);
+        }
+        return (false);
+    }
+
+    TimeDbgAccum ac("zl_intersect_batch");
+
+    Zbatch zb(zl);
+    for (const Zlist *z = thiszl; z; z = z->next) {
+        if (zb.intersect(&z->Z, touchok))
+            return (true);
+    }
+    return (false);
+}
+
+
 // Static function.
 // On success, return (zl1 | zl2) in zl1p, zl2 is consumed.
 // On exception: *zl1p and zl2 are freed.
@@ -91,6 +236,9 @@ Zlist::zl_or(Zlist **zl1p, Zlist *zl2)
         *zl1p = zl2;
         return (XIok);
     }
+    if (use_sweep())
+        return (zs_dispatch(zl1p, zl2, ZSor, "zl_or", zl_or));
+
     Zlist *zn = *zl1p;
     while (zn->next)
         zn = zn->next;
@@ -119,6 +267,9 @@ Zlist::zl_and(Zlist **zp)
         *zp = 0;
         return (XIok);
     }
+    if (use_sweep())
+        return (zs_dispatch(zp, ZSself_and, "zl_and", zl_and));
+
     Ylist *yl = new Ylist(zl);
     try {
         *zp = Ylist::clip_to_self(yl);
@@ -180,6 +331,8 @@ Zlist::zl_and(Zlist **zl1p, Zlist *zl2)
         Zlist::destroy(zt);
         return (XIok);
     }
+    if (use_sweep())
+        return (zs_dispatch(zl1p, zl2, ZSand, "zl_and", zl_and));
 
     Ylist *yl1 = new Ylist(*zl1p);
     Ylist *yl2 = new Ylist(zl2);
@@ -262,6 +415,9 @@ Zlist::zl_andnot(Zlist **zp)
 {
     if (!*zp || !(*zp)->next)
         return (XIok);
+    if (use_sweep())
+        return (zs_dispatch(zp, ZSself_andnot, "zl_andnot", zl_andnot));
+
     Ylist *yl = new Ylist(*zp);
 
 #ifdef SCLDEBUG
@@ -343,6 +499,8 @@ Zlist::zl_andnot(Zlist **zl1p, Zlist *zl2)
         Zlist::destroy(zl2);
         return (XIok);
     }
+    if (use_sweep())
+        return (zs_dispatch(zl1p, zl2, ZSandnot, "zl_andnot", zl_andnot));
 
     Ylist *yl = new Ylist(*zl1p);
     if (!zl2->next) {
@@ -470,6 +628,9 @@ Zlist::zl_xor(Zlist **zl1p, Zlist *zl2)
 {
     TimeDbgAccum ac("zl_xor");
 
+    if (use_sweep())
+        return (zs_dispatch(zl1p, zl2, ZSxor, "zl_xor", zl_xor));
+
 #ifdef SCLDEBUG
     if (GEO()->useSclFuncs()) {
         Ylist *yl1 = new Ylist(*zl1p);
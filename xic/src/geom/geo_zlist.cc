@@ -1250,6 +1250,16 @@ Zlist::add(const Zlist *thiszl, CDs *sdesc, CDl *ld, bool undoable,
     if (!sdesc || !ld)
         return;
     Errs()->init_error();
+
+    // If not undoable and the layer is empty, as for a new temporary
+    // layer, the objects are added in deferred mode and the layer
+    // database is built in one pass at the end.  When checking for
+    // coincident objects while reading, the new objects are checked
+    // after the layer is built.
+
+    bool defer = !undoable && thiszl && thiszl->next &&
+        sdesc->db_set_deferred(ld);
+
     for (const Zlist *z = thiszl; z; z = z->next) {
         if (z->Z.xll == z->Z.xul && z->Z.xlr == z->Z.xur) {
             if (z->Z.xll == z->Z.xlr || z->Z.yl >= z->Z.yu) {
@@ -1306,6 +1316,10 @@ Zlist::add(const Zlist *thiszl, CDs *sdesc, CDl *ld, bool undoable,
             }
         }
     }
+    if (defer) {
+        sdesc->db_insert_deferred(ld);
+        sdesc->checkCoinc(ld);
+    }
 }
 
 
@@ -0,0 +1,1002 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "cd.h"
+#include "geo.h"
+#include "geo_zlist.h"
+#include "cd_chkintr.h"
+#include "miscutil/timedbg.h"
+#include <math.h>
+#include <algorithm>
+
+
+//
+// A plane-sweep boolean engine for zoid lists.
+//
+// Each zoid provides a left edge with winding 1 and a right edge with
+// winding -1, and a sweep line moves upward through the events:  zoid
+// bottoms and tops, and crossings of adjacent active edges.  The
+// active edges are kept in left to right order, each with the winding
+// numbers of the two operands to its right.  Since zoid edges never
+// reverse direction, the winding number of an operand is the number
+// of its zoids covering a point, so overlapping input zoids need no
+// preprocessing.
+//
+// The result is kept as a set of open spans, each bounded by two
+// active edges and owning an output zoid whose top is set when the
+// span closes.  An event changes the edge order and windings only
+// within a range of the active list, so only the spans that touch the
+// range are closed or opened, and the output zoids are as tall as the
+// edges allow.
+//
+// The events come from heaps, and the active list is a treap ordered
+// by position, with parent links and subtree counts.  An edge's
+// index, the edge at an index, the insertion index of a new edge,
+// and the nearest open span to the left are found in O(log m) for m
+// active edges, and a range is replaced by splitting and merging.
+// The edges in a range are those between the two sides of a zoid
+// that starts or ends, which are crossed by its bottom or top, or a
+// crossing pair.  So the sweep takes O((n + k) log n) for n zoids and
+// k crossings, where k counts the crossings of zoid bottoms and tops
+// with other edges as well as the crossings of edges.  The Ylist
+// functions, which clip zoid pairs within rows, grow much faster when
+// many zoids overlap.
+//
+
+namespace {
+    // A non-horizontal zoid edge.  A left edge of an open span keeps
+    // the span's output zoid and right edge.
+    //
+    struct zs_edge
+    {
+        void set(int xb, int yb, int xt, int yt, int w, bool s,
+            zs_edge *m)
+            {
+                x0 = xb;
+                y0 = yb;
+                y1 = yt;
+                dx = xt - xb;
+                slope = dx/(double)(yt - yb);
+                mate = m;
+                t_left = 0;
+                t_right = 0;
+                t_up = 0;
+                t_prio = 0;
+                t_size = 1;
+                t_nopen = 0;
+                open = 0;
+                open_r = 0;
+                open_l = 0;
+                x_next = 0;
+                x_y = 0;
+                x_pass = 0;
+                wa = 0;
+                wb = 0;
+                wind = w;
+                set_b = s;
+                in = false;
+                active = false;
+                dead = false;
+                seg = false;
+                listed = false;
+                keep = false;
+            }
+
+        // Detach from the tree, as a single node.
+        void t_reset()
+            {
+                t_left = 0;
+                t_right = 0;
+                t_up = 0;
+                t_size = 1;
+                t_nopen = open ? 1 : 0;
+            }
+
+        // Same rounding as Zoid::xl_y.
+        int x_at(int y) const
+            {
+                if (!dx)
+                    return (x0);
+                return (mmRnd(x0 + (y - y0)*slope));
+            }
+
+        int x0, y0, y1;         // Bottom point, top y.
+        int dx;                 // Top x - x0.
+        double slope;           // dx/dy.
+        zs_edge *mate;          // Other edge of the zoid.
+        zs_edge *t_left;        // Active tree links.
+        zs_edge *t_right;
+        zs_edge *t_up;
+        unsigned int t_prio;    // Tree heap priority.
+        int t_size;             // Edges in subtree.
+        int t_nopen;            // Span left edges in subtree.
+        Zlist *open;            // Output zoid of span, if left edge.
+        zs_edge *open_r;        // Right edge of span, if left edge.
+        zs_edge *open_l;        // Left edge of span, if right edge.
+        zs_edge *x_next;        // Right neighbor of last queued crossing.
+        int x_y;                // Y of last queued crossing.
+        unsigned int x_pass;    // Pass when last taken as crossing left.
+        int wa, wb;             // Winding numbers to the right.
+        signed char wind;       // 1 for left edges, -1 for right edges.
+        bool set_b;             // Edge is from operand B.
+        bool in;                // Result covers area to the right.
+        bool active;            // In the active list.
+        bool dead;              // Ending at the current event.
+        bool seg;               // In the range being updated.
+        bool listed;            // In zs_spans.
+        bool keep;              // Span is unchanged by the update.
+    };
+
+
+    inline int t_size(const zs_edge *e)
+    {
+        return (e ? e->t_size : 0);
+    }
+
+
+    inline int t_nopen(const zs_edge *e)
+    {
+        return (e ? e->t_nopen : 0);
+    }
+
+
+    // Recompute the counts of e from its children, and set their
+    // parent links.
+    //
+    inline void t_pull(zs_edge *e)
+    {
+        e->t_size = 1 + t_size(e->t_left) + t_size(e->t_right);
+        e->t_nopen = (e->open ? 1 : 0) + t_nopen(e->t_left) +
+            t_nopen(e->t_right);
+        if (e->t_left)
+            e->t_left->t_up = e;
+        if (e->t_right)
+            e->t_right->t_up = e;
+    }
+
+
+    // Return the tree of the edges of t1 followed by those of t2.
+    //
+    zs_edge *t_merge(zs_edge *t1, zs_edge *t2)
+    {
+        if (!t1)
+            return (t2);
+        if (!t2)
+            return (t1);
+        if (t1->t_prio > t2->t_prio) {
+            t1->t_right = t_merge(t1->t_right, t2);
+            t_pull(t1);
+            return (t1);
+        }
+        t2->t_left = t_merge(t1, t2->t_left);
+        t_pull(t2);
+        return (t2);
+    }
+
+
+    // Split t into the first k edges and the rest.  The parent links
+    // of the returned roots are not set.
+    //
+    void t_split(zs_edge *t, int k, zs_edge **t1, zs_edge **t2)
+    {
+        if (!t) {
+            *t1 = 0;
+            *t2 = 0;
+            return;
+        }
+        if (t_size(t->t_left) < k) {
+            t_split(t->t_right, k - t_size(t->t_left) - 1, &t->t_right, t2);
+            t_pull(t);
+            *t1 = t;
+        }
+        else {
+            t_split(t->t_left, k, t1, &t->t_left);
+            t_pull(t);
+            *t2 = t;
+        }
+    }
+
+
+    // Append the edges of t to ary, in order.
+    //
+    void t_collect(zs_edge *t, zs_edge **ary, int *n)
+    {
+        while (t) {
+            t_collect(t->t_left, ary, n);
+            ary[(*n)++] = t;
+            t = t->t_right;
+        }
+    }
+
+
+    // Return the index of e in its tree.
+    //
+    int t_rank(const zs_edge *e)
+    {
+        int r = t_size(e->t_left);
+        while (e->t_up) {
+            const zs_edge *p = e->t_up;
+            if (p->t_right == e)
+                r += t_size(p->t_left) + 1;
+            e = p;
+        }
+        return (r);
+    }
+
+
+    // Return the edge following e.
+    //
+    zs_edge *t_next(zs_edge *e)
+    {
+        if (e->t_right) {
+            e = e->t_right;
+            while (e->t_left)
+                e = e->t_left;
+            return (e);
+        }
+        while (e->t_up && e->t_up->t_right == e)
+            e = e->t_up;
+        return (e->t_up);
+    }
+
+
+    // Return the rightmost span left edge in t, or null if none.
+    //
+    zs_edge *t_last_open(zs_edge *t)
+    {
+        while (t && t->t_nopen) {
+            if (t_nopen(t->t_right))
+                t = t->t_right;
+            else if (t->open)
+                return (t);
+            else
+                t = t->t_left;
+        }
+        return (0);
+    }
+
+
+    // Return the rightmost span left edge among the first k edges of
+    // t, or null if none.
+    //
+    zs_edge *t_last_open(zs_edge *t, int k)
+    {
+        if (!t || k <= 0 || !t->t_nopen)
+            return (0);
+        int ls = t_size(t->t_left);
+        if (k <= ls)
+            return (t_last_open(t->t_left, k));
+        zs_edge *e = t_last_open(t->t_right, k - ls - 1);
+        if (e)
+            return (e);
+        if (t->open)
+            return (t);
+        return (t_last_open(t->t_left));
+    }
+
+
+    // Update the span counts from e to the root, after e->open
+    // changes.
+    //
+    void t_fix_open(zs_edge *e)
+    {
+        for ( ; e; e = e->t_up) {
+            e->t_nopen = (e->open ? 1 : 0) + t_nopen(e->t_left) +
+                t_nopen(e->t_right);
+        }
+    }
+
+
+    // Active edge order at y.  At equal positions, the edge to the
+    // left just above y goes first, then left edges so that abutting
+    // spans merge, and the final tie break keeps the order stable.
+    //
+    inline bool zs_before(const zs_edge *e1, const zs_edge *e2, int y)
+    {
+        int x1 = e1->x_at(y);
+        int x2 = e2->x_at(y);
+        if (x1 != x2)
+            return (x1 < x2);
+        if (e1->slope != e2->slope)
+            return (e1->slope < e2->slope);
+        if (e1->wind != e2->wind)
+            return (e1->wind > e2->wind);
+        return (e1 < e2);
+    }
+
+
+    struct zs_cmp
+    {
+        zs_cmp(int yy)          { y = yy; }
+
+        bool operator()(const zs_edge *e1, const zs_edge *e2) const
+            {
+                return (zs_before(e1, e2, y));
+            }
+
+        int y;
+    };
+
+
+    inline bool zs_ycmp(const zs_edge *e1, const zs_edge *e2)
+    {
+        return (e1->y0 < e2->y0);
+    }
+
+
+    // A zoid top (e2 null, e1 the left edge) or edge crossing event.
+    //
+    struct zs_event
+    {
+        int y;
+        zs_edge *e1, *e2;
+    };
+
+
+    inline bool zs_evcmp(const zs_event &ev1, const zs_event &ev2)
+    {
+        return (ev1.y > ev2.y);
+    }
+
+
+    // Priority queue of events, lowest y first.
+    //
+    struct zs_heap
+    {
+        zs_heap()
+            {
+                h_evs = 0;
+                h_num = 0;
+                h_size = 0;
+            }
+
+        ~zs_heap()
+            {
+                delete [] h_evs;
+            }
+
+        int num()                   const { return (h_num); }
+        int top_y()                 const { return (h_evs[0].y); }
+
+        void push(int y, zs_edge *e1, zs_edge *e2)
+            {
+                if (h_num == h_size) {
+                    int sz = h_size ? 2*h_size : 64;
+                    zs_event *e = new zs_event[sz];
+                    for (int i = 0; i < h_num; i++)
+                        e[i] = h_evs[i];
+                    delete [] h_evs;
+                    h_evs = e;
+                    h_size = sz;
+                }
+                h_evs[h_num].y = y;
+                h_evs[h_num].e1 = e1;
+                h_evs[h_num].e2 = e2;
+                h_num++;
+                std::push_heap(h_evs, h_evs + h_num, zs_evcmp);
+            }
+
+        zs_event pop()
+            {
+                std::pop_heap(h_evs, h_evs + h_num, zs_evcmp);
+                h_num--;
+                return (h_evs[h_num]);
+            }
+
+    private:
+        zs_event *h_evs;
+        int h_num;
+        int h_size;
+    };
+
+
+    // A range of active list indices to update, b < a if empty, with
+    // the edges to insert.
+    //
+    struct zs_range
+    {
+        int a, b;
+        int ins;                // Offset of inserted edges.
+        int nins;               // Number of inserted edges.
+    };
+
+
+    inline bool zs_rcmp(const zs_range &r1, const zs_range &r2)
+    {
+        if (r1.a != r2.a)
+            return (r1.a < r2.a);
+        return (r1.b < r2.b);
+    }
+
+
+    struct zs_sweep
+    {
+        zs_sweep(ZSop o)
+            {
+                zs_op = o;
+                zs_out = 0;
+                zs_edges = 0;
+                zs_order = 0;
+                zs_root = 0;
+                zs_old = 0;
+                zs_tmp = 0;
+                zs_new = 0;
+                zs_ins = 0;
+                zs_gins = 0;
+                zs_spans = 0;
+                zs_rngs = 0;
+                zs_nedges = 0;
+                zs_nzoids = 0;
+                zs_nspans = 0;
+            }
+
+        ~zs_sweep()
+            {
+                Zlist::destroy(zs_out);
+                delete [] zs_edges;
+                delete [] zs_order;
+                delete [] zs_old;
+                delete [] zs_tmp;
+                delete [] zs_new;
+                delete [] zs_ins;
+                delete [] zs_gins;
+                delete [] zs_spans;
+                delete [] zs_rngs;
+            }
+
+        void setup(const Zlist*, const Zlist*);
+        Zlist *run() THROW_XIrt;
+
+    private:
+        int add(const Zlist*, bool, int);
+        zs_edge *select(int) const;
+        int lower_rank(const zs_edge*, int) const;
+        zs_edge *last_open_before(int) const;
+        void update(int, int, zs_edge**, int, int);
+        void add_span(zs_edge*);
+        void close_span(zs_edge*, int);
+        void check_cross(zs_edge*, zs_edge*, int);
+
+        // The area test for the operation, given the winding numbers
+        // of the two operands.
+        //
+        bool inside(int wa, int wb) const
+            {
+                switch (zs_op) {
+                case ZSor:
+                    return (wa || wb);
+                case ZSand:
+                    return (wa && wb);
+                case ZSandnot:
+                    return (wa && !wb);
+                case ZSxor:
+                    return ((wa != 0) != (wb != 0));
+                case ZSself_and:
+                    return (wa > 1);
+                case ZSself_andnot:
+                    return (wa == 1);
+                }
+                return (false);
+            }
+
+        ZSop        zs_op;      // Operation.
+        Zlist       *zs_out;    // Output zoids.
+        zs_edge     *zs_edges;  // Edge storage, left/right pairs.
+        zs_edge     **zs_order; // Left edges sorted by bottom y.
+        zs_edge     *zs_root;   // Active edges, left to right.
+        zs_edge     **zs_old;   // Range edges before update.
+        zs_edge     **zs_tmp;   // Range edges after update.
+        zs_edge     **zs_new;   // New span edge pairs, for update.
+        zs_edge     **zs_ins;   // Edges starting at the event.
+        zs_edge     **zs_gins;  // Same, grouped by range.
+        zs_edge     **zs_spans; // Span left edges, for update.
+        zs_range    *zs_rngs;   // Changed ranges at the event.
+        zs_heap     zs_tops;    // Zoid top events.
+        zs_heap     zs_cross;   // Edge crossing events.
+        int         zs_nedges;  // Number of edges.
+        int         zs_nzoids;  // Number of zoids.
+        int         zs_nspans;  // Number of spans in zs_spans.
+    };
+
+
+    // Create the edges of the operands, and sort.
+    //
+    void
+    zs_sweep::setup(const Zlist *zla, const Zlist *zlb)
+    {
+        if (zs_op == ZSself_and || zs_op == ZSself_andnot)
+            zlb = 0;
+        int n = Zlist::length(zla) + Zlist::length(zlb);
+        zs_edges = new zs_edge[2*n];
+        zs_order = new zs_edge*[n];
+        zs_old = new zs_edge*[2*n];
+        zs_tmp = new zs_edge*[2*n];
+        zs_new = new zs_edge*[2*n + 2];
+        zs_ins = new zs_edge*[2*n];
+        zs_gins = new zs_edge*[2*n];
+        zs_spans = new zs_edge*[2*n + 2];
+        zs_rngs = new zs_range[3*n];
+
+        zs_nedges = add(zla, false, 0);
+        zs_nedges = add(zlb, true, zs_nedges);
+        zs_nzoids = zs_nedges/2;
+
+        // Tree priorities, from a fixed xorshift sequence so that
+        // results are repeatable.
+        unsigned int r = 2463534242u;
+        for (int i = 0; i < zs_nedges; i++) {
+            r ^= r << 13;
+            r ^= r >> 17;
+            r ^= r << 5;
+            zs_edges[i].t_prio = r;
+        }
+        for (int i = 0; i < zs_nzoids; i++)
+            zs_order[i] = zs_edges + 2*i;
+        std::sort(zs_order, zs_order + zs_nzoids, zs_ycmp);
+    }
+
+
+    int
+    zs_sweep::add(const Zlist *zl, bool set_b, int ix)
+    {
+        for (const Zlist *z = zl; z; z = z->next) {
+            const Zoid &Z = z->Z;
+            if (Z.yu <= Z.yl)
+                continue;
+            if (Z.xlr < Z.xll || Z.xur < Z.xul)
+                continue;
+            if (Z.xll == Z.xlr && Z.xul == Z.xur)
+                continue;
+            zs_edge *el = zs_edges + ix++;
+            zs_edge *er = zs_edges + ix++;
+            el->set(Z.xll, Z.yl, Z.xul, Z.yu, 1, set_b, er);
+            er->set(Z.xlr, Z.yl, Z.xur, Z.yu, -1, set_b, el);
+        }
+        return (ix);
+    }
+
+
+    // Return the active edge with index k.
+    //
+    zs_edge *
+    zs_sweep::select(int k) const
+    {
+        zs_edge *t = zs_root;
+        while (t) {
+            int ls = t_size(t->t_left);
+            if (k < ls)
+                t = t->t_left;
+            else if (k == ls)
+                return (t);
+            else {
+                k -= ls + 1;
+                t = t->t_right;
+            }
+        }
+        return (0);
+    }
+
+
+    // Return the index where e would be inserted in the active list,
+    // before the first edge not ordered before e at y.
+    //
+    int
+    zs_sweep::lower_rank(const zs_edge *e, int y) const
+    {
+        int r = 0;
+        zs_edge *t = zs_root;
+        while (t) {
+            if (zs_before(t, e, y)) {
+                r += t_size(t->t_left) + 1;
+                t = t->t_right;
+            }
+            else
+                t = t->t_left;
+        }
+        return (r);
+    }
+
+
+    // Return the rightmost span left edge with index less than k, or
+    // null if none.
+    //
+    zs_edge *
+    zs_sweep::last_open_before(int k) const
+    {
+        return (t_last_open(zs_root, k));
+    }
+
+
+    // Save the span with left edge el for update, once.
+    //
+    void
+    zs_sweep::add_span(zs_edge *el)
+    {
+        if (el->listed)
+            return;
+        el->listed = true;
+        zs_spans[zs_nspans++] = el;
+    }
+
+
+    // Set the top of the output zoid of the span with left edge el.
+    //
+    void
+    zs_sweep::close_span(zs_edge *el, int y)
+    {
+        Zoid &Z = el->open->Z;
+        Z.yu = y;
+        Z.xul = el->x_at(y);
+        Z.xur = mmMax(el->open_r->x_at(y), Z.xul);
+        el->open_r->open_l = 0;
+        el->open_r = 0;
+        el->open = 0;
+        t_fix_open(el);
+    }
+
+
+    // If e1 will cross e2, its right neighbor, queue the event at the
+    // first integer y at or above the crossing.  If the two are out of
+    // order at y, which happens when they become neighbors at their
+    // crossing, the event is at y, and is taken in another pass.  An
+    // update checks all neighbors in its range, so skip a crossing that
+    // is already queued.
+    //
+    void
+    zs_sweep::check_cross(zs_edge *e1, zs_edge *e2, int y)
+    {
+        if (zs_before(e2, e1, y)) {
+            zs_cross.push(y, e1, e2);
+            return;
+        }
+        if (e2->slope >= e1->slope)
+            return;
+        double yc = (e2->x0 - e1->x0 + e1->y0*e1->slope -
+            e2->y0*e2->slope)/(e1->slope - e2->slope);
+        int yx = yc < e1->y1 ? (int)ceil(yc - 1e-9) : e1->y1;
+        if (yx <= y)
+            yx = y + 1;
+        if (yx >= e1->y1 || yx >= e2->y1)
+            return;
+        if (e1->x_next == e2 && e1->x_y == yx)
+            return;
+        e1->x_next = e2;
+        e1->x_y = yx;
+        zs_cross.push(yx, e1, e2);
+    }
+
+
+    // Update active list indices a through b (b < a if empty) at y,
+    // removing dead edges, adding the ni edges in ins, and resorting. 
+    // Each change keeps both edges of a zoid within the range, or is
+    // a swap of neighbors, so the windings outside of the range don't
+    // change, and only the spans that touch the range can change.
+    //
+    void
+    zs_sweep::update(int a, int b, zs_edge **ins, int ni, int y)
+    {
+        bool s0 = false;
+        int wa = 0, wb = 0;
+        zs_edge *pl = a > 0 ? select(a - 1) : 0;
+        if (pl) {
+            s0 = pl->in;
+            wa = pl->wa;
+            wb = pl->wb;
+        }
+
+        // Take the range out of the tree.
+        zs_edge *tl, *tm, *tr;
+        t_split(zs_root, a, &tl, &tm);
+        t_split(tm, b - a + 1, &tm, &tr);
+        int nold = 0;
+        t_collect(tm, zs_old, &nold);
+        zs_edge *nx = tr;
+        while (nx && nx->t_left)
+            nx = nx->t_left;
+
+        // Save the spans that touch the range.
+        zs_nspans = 0;
+        int nt = 0;
+        for (int i = 0; i < nold; i++) {
+            zs_edge *e = zs_old[i];
+            e->seg = true;
+            if (e->open)
+                add_span(e);
+            if (e->open_l)
+                add_span(e->open_l);
+            if (e->dead)
+                e->active = false;
+            else
+                zs_tmp[nt++] = e;
+        }
+        for (int i = 0; i < ni; i++) {
+            ins[i]->active = true;
+            zs_tmp[nt++] = ins[i];
+        }
+        zs_edge *lsp = 0, *rsp = 0;
+        for (int i = 0; i < zs_nspans; i++) {
+            zs_edge *e = zs_spans[i];
+            if (!e->seg)
+                lsp = e;
+            if (!e->open_r->seg)
+                rsp = e;
+        }
+        for (int i = 0; i < nold; i++)
+            zs_old[i]->seg = false;
+
+        // Resort, recompute the windings, and put the range back.
+        std::sort(zs_tmp, zs_tmp + nt, zs_cmp(y));
+        bool hole = false;
+        for (int i = 0; i < nold; i++) {
+            if (zs_old[i]->dead)
+                zs_old[i]->t_reset();
+        }
+        tm = 0;
+        for (int i = 0; i < nt; i++) {
+            zs_edge *e = zs_tmp[i];
+            if (e->set_b)
+                wb += e->wind;
+            else
+                wa += e->wind;
+            e->wa = wa;
+            e->wb = wb;
+            e->in = inside(wa, wb);
+            if (!e->in)
+                hole = true;
+            e->t_reset();
+            tm = t_merge(tm, e);
+        }
+        zs_root = t_merge(t_merge(tl, tm), tr);
+        if (zs_root)
+            zs_root->t_up = 0;
+
+        // New neighbors may cross.
+        zs_edge *ep = pl;
+        for (int i = 0; i < nt; i++) {
+            if (ep)
+                check_cross(ep, zs_tmp[i], y);
+            ep = zs_tmp[i];
+        }
+        if (ep && nx)
+            check_cross(ep, nx, y);
+
+        if (s0 && !lsp) {
+            // A span covers the range.  This is common when the
+            // result has large areas, so avoid the search if nothing
+            // changes.
+            if (!hole) {
+                for (int i = 0; i < zs_nspans; i++)
+                    zs_spans[i]->listed = false;
+                zs_nspans = 0;
+                return;
+            }
+            lsp = last_open_before(a);
+            if (lsp) {
+                rsp = lsp;
+                add_span(lsp);
+            }
+        }
+
+        // Find the new spans.  The first span is continued from the
+        // left, and the last continues to the right.
+        int np = 0;
+        zs_edge *el = s0 ? lsp : 0;
+        bool was_in = s0;
+        for (int i = 0; i < nt; i++) {
+            zs_edge *e = zs_tmp[i];
+            if (!was_in && e->in)
+                el = e;
+            else if (was_in && !e->in && el) {
+                zs_new[np++] = el;
+                zs_new[np++] = e;
+            }
+            was_in = e->in;
+        }
+        if (was_in && el && rsp) {
+            zs_new[np++] = el;
+            zs_new[np++] = rsp->open_r;
+        }
+
+        // Close the old spans that don't match a new span, then open
+        // the new spans that don't match an old span.
+        for (int j = 0; j < np; j += 2) {
+            zs_edge *e = zs_new[j];
+            if (e->open && e->open_r == zs_new[j+1])
+                e->keep = true;
+        }
+        for (int i = 0; i < zs_nspans; i++) {
+            zs_edge *e = zs_spans[i];
+            e->listed = false;
+            if (e->keep)
+                e->keep = false;
+            else
+                close_span(e, y);
+        }
+        for (int j = 0; j < np; j += 2) {
+            zs_edge *e = zs_new[j];
+            e->keep = false;
+            if (e->open)
+                continue;
+            zs_edge *er = zs_new[j+1];
+            int xl = e->x_at(y);
+            int xr = mmMax(er->x_at(y), xl);
+            zs_out = new Zlist(xl, xr, y, xl, xr, y, zs_out);
+            e->open = zs_out;
+            e->open_r = er;
+            er->open_l = e;
+            t_fix_open(e);
+        }
+        zs_nspans = 0;
+    }
+
+
+    // Perform the sweep, returning the result.
+    //
+    Zlist *
+    zs_sweep::run() THROW_XIrt
+    {
+        int ix = 0;
+        unsigned int pass = 0;
+        while (ix < zs_nzoids || zs_tops.num() || zs_cross.num()) {
+            int y = ix < zs_nzoids ? zs_order[ix]->y0 : INT_MAX;
+            if (zs_tops.num() && zs_tops.top_y() < y)
+                y = zs_tops.top_y();
+            if (zs_cross.num() && zs_cross.top_y() < y)
+                y = zs_cross.top_y();
+
+            // Find the ranges of the active list that change, in
+            // present indices.  There is at most one range per zoid
+            // top or bottom, and one per active edge taken as the left
+            // of a crossing, which bounds zs_rngs.
+            pass++;
+            int nr = 0;
+            while (zs_tops.num() && zs_tops.top_y() == y) {
+                zs_event ev = zs_tops.pop();
+                ev.e1->dead = true;
+                ev.e1->mate->dead = true;
+                if (!ev.e1->active || !ev.e1->mate->active)
+                    continue;
+                int i1 = t_rank(ev.e1);
+                int i2 = t_rank(ev.e1->mate);
+                zs_range &r = zs_rngs[nr++];
+                r.a = mmMin(i1, i2);
+                r.b = mmMax(i1, i2);
+                r.nins = 0;
+            }
+            while (zs_cross.num() && zs_cross.top_y() == y) {
+                zs_event ev = zs_cross.pop();
+                if (!ev.e1->active || !ev.e2->active)
+                    continue;
+                if (ev.e1->dead || ev.e2->dead)
+                    continue;
+                if (ev.e1->x_pass == pass)
+                    continue;
+                if (t_next(ev.e1) != ev.e2)
+                    continue;
+                int i = t_rank(ev.e1);
+                ev.e1->x_pass = pass;
+                zs_range &r = zs_rngs[nr++];
+                r.a = i;
+                r.b = i + 1;
+                r.nins = 0;
+            }
+            int ni = 0;
+            while (ix < zs_nzoids && zs_order[ix]->y0 == y) {
+                zs_edge *el = zs_order[ix++];
+                zs_tops.push(el->y1, el, 0);
+                zs_range &r = zs_rngs[nr++];
+                r.a = lower_rank(el, y);
+                r.b = mmMax(lower_rank(el->mate, y), r.a) - 1;
+                r.ins = ni;
+                r.nins = 2;
+                zs_ins[ni++] = el;
+                zs_ins[ni++] = el->mate;
+            }
+
+            // Merge overlapping or adjacent ranges, and update each
+            // from the right so that indices remain valid.
+            std::sort(zs_rngs, zs_rngs + nr, zs_rcmp);
+            int nm = 0, ng = 0;
+            for (int i = 0; i < nr; i++) {
+                zs_range &r = zs_rngs[i];
+                if (nm && r.a <= zs_rngs[nm-1].b + 1) {
+                    zs_range &m = zs_rngs[nm-1];
+                    if (r.b > m.b)
+                        m.b = r.b;
+                    for (int j = 0; j < r.nins; j++)
+                        zs_gins[ng++] = zs_ins[r.ins + j];
+                    m.nins += r.nins;
+                    continue;
+                }
+                int nins = r.nins;
+                int ins = r.ins;
+                zs_range &m = zs_rngs[nm++];
+                m.a = r.a;
+                m.b = r.b;
+                m.ins = ng;
+                m.nins = nins;
+                for (int j = 0; j < nins; j++)
+                    zs_gins[ng++] = zs_ins[ins + j];
+            }
+            for (int i = nm - 1; i >= 0; i--) {
+                zs_range &m = zs_rngs[i];
+                update(m.a, m.b, zs_gins + m.ins, m.nins, y);
+            }
+
+            if (!(pass & 0x3ff) && checkInterrupt())
+                throw (XIintr);
+        }
+
+        // Remove degenerate zoids.
+        Zlist *z0 = zs_out;
+        zs_out = 0;
+        Zlist *zp = 0, *zn;
+        for (Zlist *z = z0; z; z = zn) {
+            zn = z->next;
+            if (z->Z.is_bad()) {
+                if (zp)
+                    zp->next = zn;
+                else
+                    z0 = zn;
+                delete z;
+                continue;
+            }
+            zp = z;
+        }
+        return (z0);
+    }
+}
+
+
+// Static function.
+// Return a new list containing the result of the operation on the
+// two lists, which are not changed.  The second list is ignored for
+// the "self" operations.  On exception, nothing is allocated.
+//
+Zlist *
+Zlist::sweep(const Zlist *zla, const Zlist *zlb, ZSop op) THROW_XIrt
+{
+    TimeDbgAccum ac("zl_sweep");
+
+    zs_sweep sw(op);
+    sw.setup(zla, zlb);
+    return (sw.run());
+}
+
@@ -0,0 +1,184 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+
+//
+// Benchmark of the R-tree bulk load, build with "make rtbench". 
+// The same random boxes are put into one tree by incremental
+// insertion, and into another in deferred mode, which builds the
+// tree with RTree::load.  Random areas are then searched in both
+// trees.  The search results must agree, and the times are printed.
+//
+// Usage:  rtbench [objects [searches [seed]]]
+//
+
+#include "cd.h"
+#include "geo_rtree.h"
+#include "geo_memmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+
+// The tree is linked with the memory manager and without the rest of
+// the geometry and cd libraries, and these are all that it needs from
+// them.
+//
+void
+mm_err_hook(const char *s, const char *type_name)
+{
+    fprintf(stderr, "%s: %s\n", type_name ? type_name : "MMGR", s);
+}
+
+void
+Zoid::show() const
+{
+}
+
+
+namespace {
+    // A leaf element, with a bounding box only.
+    //
+    struct rt_box : public RTelem
+    {
+        rt_box(int l, int b, int r, int t)
+            {
+                e_BB = BBox(l, b, r, t);
+                e_type = 'z';
+            }
+    };
+
+
+    // Return a box with lower left corner in a square area of side
+    // sz.
+    //
+    BBox
+    random_box(int sz)
+    {
+        int l = rand() % sz;
+        int b = rand() % sz;
+        return (BBox(l, b, l + 1 + rand() % 50, b + 1 + rand() % 50));
+    }
+
+
+    double
+    seconds()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return (tv.tv_sec + 1e-6*tv.tv_usec);
+    }
+
+
+    // Return the total number of elements found in the areas.
+    //
+    unsigned int
+    search(const RTree *tree, const BBox *areas, int n)
+    {
+        unsigned int cnt = 0;
+        for (int i = 0; i < n; i++) {
+            RTgen gen;
+            gen.init(tree, &areas[i]);
+            while (gen.next_element())
+                cnt++;
+        }
+        return (cnt);
+    }
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int nobj = argc > 1 ? atoi(argv[1]) : 200000;
+    int nsrch = argc > 2 ? atoi(argv[2]) : 2000;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    if (nobj < 1 || nsrch < 1) {
+        fprintf(stderr, "usage: rtbench [objects [searches [seed]]]\n");
+        return (1);
+    }
+    srand(seed);
+    new cGEOmmgr;
+
+    // About one box covers each point on average.
+    int sz = 25*(int)sqrt((double)nobj);
+    BBox *boxes = new BBox[nobj];
+    for (int i = 0; i < nobj; i++)
+        boxes[i] = random_box(sz);
+    BBox *areas = new BBox[nsrch];
+    for (int i = 0; i < nsrch; i++) {
+        areas[i] = random_box(sz);
+        areas[i].bloat(100);
+    }
+
+    double t0 = seconds();
+    RTree tinc;
+    for (int i = 0; i < nobj; i++) {
+        const BBox &BB = boxes[i];
+        tinc.insert(new rt_box(BB.left, BB.bottom, BB.right, BB.top));
+    }
+    double t1 = seconds();
+    RTree tload;
+    tload.set_deferred();
+    for (int i = 0; i < nobj; i++) {
+        const BBox &BB = boxes[i];
+        tload.insert(new rt_box(BB.left, BB.bottom, BB.right, BB.top));
+    }
+    tload.unset_deferred();
+    double t2 = seconds();
+    unsigned int ninc = search(&tinc, areas, nsrch);
+    double t3 = seconds();
+    unsigned int nload = search(&tload, areas, nsrch);
+    double t4 = seconds();
+
+    printf("objects %d, searches %d, found %u\n", nobj, nsrch, ninc);
+    printf("insert  build %.4f sec, search %.4f sec\n", t1 - t0, t3 - t2);
+    printf("load    build %.4f sec, search %.4f sec\n", t2 - t1, t4 - t3);
+    tinc.clear();
+    tload.clear();
+    delete [] boxes;
+    delete [] areas;
+    if (nload != ninc) {
+        printf("mismatch, load found %u\n", nload);
+        return (1);
+    }
+    return (0);
+}
@@ -0,0 +1,159 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+
+//
+// Benchmark of the batched zoid extent tests, build with "make
+// zbbench".  Random zoids are tested against a random list, with
+// the plain Zlist::intersect loop and with a Zbatch of the list.
+// The two must agree, and the time of each is printed.
+//
+// Usage:  zbbench [list size [iterations [seed]]]
+//
+
+#include "cd.h"
+#include "geo_zlist.h"
+#include "geo_zbatch.h"
+#include "geo_memmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+
+// The batch and zoid clipping functions are linked with the memory
+// manager and without the rest of the geometry and cd libraries, and
+// these are all that they need from them.  The timer is never
+// started, so there is no interrupt check.
+//
+cCD *cCD::instancePtr = 0;
+uint64_t CDcheckTime = 0;
+int CDphysResolution = 1000;
+const int CDinfinity = 1000000000;
+const BBox CDnullBB(CDinfinity, CDinfinity, -CDinfinity, -CDinfinity);
+
+void
+mm_err_hook(const char *s, const char *type_name)
+{
+    fprintf(stderr, "%s: %s\n", type_name ? type_name : "MMGR", s);
+}
+
+void
+Zoid::show() const
+{
+}
+
+
+namespace {
+    // Return a list of n random zoids in a square area of side sz.
+    //
+    Zlist *
+    random_zoids(int n, int sz)
+    {
+        Zlist *z0 = 0;
+        for (int i = 0; i < n; i++) {
+            int yl = rand() % sz;
+            int h = 1 + rand() % 50;
+            int x = rand() % sz;
+            int w = 1 + rand() % 50;
+            int dl = (rand() % 3 - 1)*h;
+            int dr = (rand() % 3 - 1)*h;
+            if (w + dr - dl < 0)
+                dr = dl;
+            z0 = new Zlist(x, x + w, yl, x + dl, x + w + dr, yl + h, z0);
+        }
+        return (z0);
+    }
+
+
+    double
+    seconds()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return (tv.tv_sec + 1e-6*tv.tv_usec);
+    }
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int nzl = argc > 1 ? atoi(argv[1]) : 1000;
+    int iters = argc > 2 ? atoi(argv[2]) : 20000;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    if (nzl < 1 || iters < 1) {
+        fprintf(stderr, "usage: zbbench [list size [iterations [seed]]]\n");
+        return (1);
+    }
+    srand(seed);
+    new cGEOmmgr;
+
+    // The list is sparse, so that most tests miss.
+    int sz = 100*nzl;
+    Zlist *zl = random_zoids(nzl, sz);
+    Zlist *zt = random_zoids(iters, sz);
+
+    double t0 = seconds();
+    int nplain = 0;
+    for (Zlist *z = zt; z; z = z->next) {
+        if (Zlist::intersect(zl, &z->Z, false))
+            nplain++;
+    }
+    double t1 = seconds();
+    Zbatch zb(zl);
+    int nbatch = 0;
+    for (Zlist *z = zt; z; z = z->next) {
+        if (zb.intersect(&z->Z, false))
+            nbatch++;
+    }
+    double t2 = seconds();
+
+    printf("list %d, tests %d, hits %d\n", nzl, iters, nplain);
+    printf("plain   %.4f sec\n", t1 - t0);
+    printf("batched %.4f sec\n", t2 - t1);
+    Zlist::destroy(zl);
+    Zlist::destroy(zt);
+    if (nbatch != nplain) {
+        printf("mismatch, batched hits %d\n", nbatch);
+        return (1);
+    }
+    return (0);
+}
+
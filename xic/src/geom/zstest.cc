@@ -0,0 +1,394 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+//
+// Randomized test of Zlist::sweep, build with "make zstest".  The
+// operands are random sets of overlapping zoids, half of them with
+// 45-degree sides, and the result of each operation is
+// compared with the coverage of the operands at sample points on a
+// grid offset from the integer coordinates.  Along non-Manhattan
+// edges the result may differ by rounding, so there a sample that
+// differs, or is covered by more than one result zoid, is an error
+// only if no operand edge is near.  Then the Zlist operations are
+// timed with the Ylist functions and with the sweep engine, on
+// larger random lists.
+//
+// Usage:  zstest [iterations [seed [timing list size]]]
+//
+
+#include "cd.h"
+#include "geo_zlist.h"
+#include "geo_memmgr.h"
+#include "cd_types.h"
+#include "cd_chkintr.h"
+#include "cd_ldb.h"
+#include "miscutil/timedbg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+
+// The geometry library is linked without the cd library, and these
+// are all that it needs from it.  Only the variables are used here,
+// the functions are reached from the database interfaces, which are
+// never called.  The timer is never started, so there is no
+// interrupt check.
+//
+cCD *cCD::instancePtr = 0;
+cCDldb *cCDldb::instancePtr = 0;
+uint64_t CDcheckTime = 0;
+int CDphysResolution = 1000;
+const int CDinfinity = 1000000000;
+const BBox CDnullBB(CDinfinity, CDinfinity, -CDinfinity, -CDinfinity);
+
+void
+mm_err_hook(const char *s, const char *type_name)
+{
+    fprintf(stderr, "%s: %s\n", type_name ? type_name : "MMGR", s);
+}
+
+void *CDdb::operator new(size_t sz)     { return (::operator new(sz)); }
+void *CDo::operator new(size_t sz)      { return (::operator new(sz)); }
+void *CDpo::operator new(size_t sz)     { return (::operator new(sz)); }
+void *CDol::operator new(size_t sz)     { return (::operator new(sz)); }
+void CDo::computeBB()                   { }
+bool CDdb::db_set_deferred(CDl*)        { return (false); }
+bool CDdb::db_insert_deferred(const CDl*) { return (false); }
+bool CDs::insert(CDo*)                  { return (false); }
+bool CDs::mergeBoxOrPoly(CDo*, bool)    { return (false); }
+void CDs::checkCoinc(const CDl*)        { }
+CDerrType CDs::makeBox(CDl*, const BBox*, CDo**, bool)
+                                        { return (CDfailed); }
+CDerrType CDs::makePolygon(CDl*, Poly*, CDpo**, int*, bool)
+                                        { return (CDfailed); }
+CDerrType CDs::addToDb(PolyList*, CDl*, bool, CDol**, const cTfmStack*,
+    bool)                               { return (CDfailed); }
+sPF::sPF(const CDs*, const BBox*, const CDl*, int) { }
+sPF::~sPF()                             { }
+CDo *sPF::next(bool, bool)              { return (0); }
+void sTT::rotate(int, int)              { }
+void sTT::path(int, Point*, const Point*) const { }
+SymTab::SymTab(bool, bool, int)         { }
+SymTab::~SymTab()                       { }
+bool SymTab::add(uintptr_t, const void*, bool) { return (false); }
+SymTabEnt *SymTab::get_ent_prv(uintptr_t) { return (0); }
+SymTabGen::SymTabGen(SymTab*, bool)     { }
+SymTabEnt *SymTabGen::next()            { return (0); }
+void cCDldb::on_null_ptr()              { }
+CDl *cCDldb::findLayer(const char*, DisplayMode) { return (0); }
+CDl *cCDldb::addNewLayer(const char*, DisplayMode, CDLtype, int, bool)
+                                        { return (0); }
+
+
+namespace {
+    const char *opnames[] =
+        { "or", "and", "andnot", "xor", "self_and", "self_andnot" };
+
+    // Return the number of zoids in the list that cover x,y.
+    //
+    int
+    cover(const Zlist *zl, double x, double y)
+    {
+        int cnt = 0;
+        for (const Zlist *z = zl; z; z = z->next) {
+            const Zoid &Z = z->Z;
+            if (y <= Z.yl || y >= Z.yu)
+                continue;
+            double t = (y - Z.yl)/(Z.yu - Z.yl);
+            double xl = Z.xll + t*(Z.xul - Z.xll);
+            double xr = Z.xlr + t*(Z.xur - Z.xlr);
+            if (x > xl && x < xr)
+                cnt++;
+        }
+        return (cnt);
+    }
+
+
+    bool
+    want(ZSop op, const Zlist *za, const Zlist *zb, double x, double y)
+    {
+        int a = cover(za, x, y);
+        int b = cover(zb, x, y);
+        switch (op) {
+        case ZSor:
+            return (a || b);
+        case ZSand:
+            return (a && b);
+        case ZSandnot:
+            return (a && !b);
+        case ZSxor:
+            return ((a != 0) != (b != 0));
+        case ZSself_and:
+            return (a > 1);
+        case ZSself_andnot:
+            return (a == 1);
+        }
+        return (false);
+    }
+
+
+    // Return a list of n random zoids with lower left corners in an
+    // sz x sz area, Manhattan or with sides of slope 0, 1, or -1 in
+    // units of height.
+    //
+    Zlist *
+    random_zoids(int n, bool manh, int sz)
+    {
+        Zlist *z0 = 0;
+        for (int i = 0; i < n; i++) {
+            int yl = rand() % sz;
+            int h = 1 + rand() % 20;
+            int x = rand() % sz;
+            int w = 1 + rand() % 20;
+            int dl = manh ? 0 : (rand() % 3 - 1)*h;
+            int dr = manh ? 0 : (rand() % 3 - 1)*h;
+            if (w + dr - dl < 0)
+                dr = dl;
+            z0 = new Zlist(x, x + w, yl, x + dl, x + w + dr, yl + h, z0);
+        }
+        return (z0);
+    }
+
+
+    // Return the distance from x,y to the segment x1,y1 - x2,y2.
+    //
+    double
+    seg_dist(double x, double y, double x1, double y1, double x2, double y2)
+    {
+        double dx = x2 - x1;
+        double dy = y2 - y1;
+        double d2 = dx*dx + dy*dy;
+        double t = d2 > 0.0 ? ((x - x1)*dx + (y - y1)*dy)/d2 : 0.0;
+        if (t < 0.0)
+            t = 0.0;
+        else if (t > 1.0)
+            t = 1.0;
+        dx = x1 + t*dx - x;
+        dy = y1 + t*dy - y;
+        return (sqrt(dx*dx + dy*dy));
+    }
+
+
+    // Return true if x,y is within d of an edge of a zoid in the list.
+    //
+    bool
+    near_edge(const Zlist *zl, double x, double y, double d)
+    {
+        for (const Zlist *z = zl; z; z = z->next) {
+            const Zoid &Z = z->Z;
+            if (seg_dist(x, y, Z.xll, Z.yl, Z.xul, Z.yu) < d ||
+                    seg_dist(x, y, Z.xlr, Z.yl, Z.xur, Z.yu) < d ||
+                    seg_dist(x, y, Z.xll, Z.yl, Z.xlr, Z.yl) < d ||
+                    seg_dist(x, y, Z.xul, Z.yu, Z.xur, Z.yu) < d)
+                return (true);
+        }
+        return (false);
+    }
+
+
+    // Return crossing zoid pairs above wide rectangles.  Each
+    // rectangle bottom and top once queued the crossings again.
+    //
+    Zlist *
+    crossing_zoids()
+    {
+        Zlist *z0 = 0;
+        for (int i = 0; i < 3; i++) {
+            int x = 50*i - 45;
+            z0 = new Zlist(x, x + 5, 0, x + 20, x + 25, 20, z0);
+            z0 = new Zlist(x + 20, x + 25, 0, x, x + 5, 20, z0);
+        }
+        for (int i = 0; i < 3; i++)
+            z0 = new Zlist(-50, 110, i + 1, -50, 110, i + 4, z0);
+        return (z0);
+    }
+
+
+    // Check the result, return the number of bad samples.  Along
+    // non-Manhattan edges, crossings are rounded to integer y and
+    // positions to integer x, so a difference or an overlap of result
+    // zoids within 1.5 of an operand edge is allowed.
+    //
+    int
+    check(ZSop op, const Zlist *za, const Zlist *zb, const Zlist *zr,
+        bool manh)
+    {
+        if (op == ZSself_and || op == ZSself_andnot)
+            zb = 0;
+        int nbad = 0;
+        for (double y = -5.37; y < 70.0; y += 0.5) {
+            for (double x = -50.13; x < 110.0; x += 0.5) {
+                int c = cover(zr, x, y);
+                if (c == 1 || c == 0) {
+                    if ((c == 1) == want(op, za, zb, x, y))
+                        continue;
+                }
+                if (!manh && (near_edge(za, x, y, 1.5) ||
+                        near_edge(zb, x, y, 1.5)))
+                    continue;
+                nbad++;
+            }
+        }
+        return (nbad);
+    }
+
+
+    double
+    seconds()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return (tv.tv_sec + 1e-6*tv.tv_usec);
+    }
+
+
+    // Time the Zlist operations on copies of the lists in the mode,
+    // return the total.
+    //
+    double
+    time_ops(const Zlist *za, const Zlist *zb, ZSmode mode)
+    {
+        GEO()->setZlSweepMode(mode);
+        double tt = 0.0;
+        for (int op = ZSor; op <= ZSself_andnot; op++) {
+            Zlist *z1 = Zlist::copy(za);
+            Zlist *z2 = Zlist::copy(zb);
+            double t0 = seconds();
+            XIrt ret = XIok;
+            switch (op) {
+            case ZSor:
+                ret = Zlist::zl_or(&z1, z2);
+                break;
+            case ZSand:
+                ret = Zlist::zl_and(&z1, z2);
+                break;
+            case ZSandnot:
+                ret = Zlist::zl_andnot(&z1, z2);
+                break;
+            case ZSxor:
+                ret = Zlist::zl_xor(&z1, z2);
+                break;
+            case ZSself_and:
+                Zlist::destroy(z2);
+                ret = Zlist::zl_and(&z1);
+                break;
+            case ZSself_andnot:
+                Zlist::destroy(z2);
+                ret = Zlist::zl_andnot(&z1);
+                break;
+            }
+            double dt = seconds() - t0;
+            printf("  %-12s %-6s %.4f sec\n", opnames[op],
+                mode == ZSon ? "sweep" : "Ylist", dt);
+            if (ret != XIok)
+                printf("  %s failed\n", opnames[op]);
+            Zlist::destroy(z1);
+            tt += dt;
+        }
+        GEO()->setZlSweepMode(ZSoff);
+        return (tt);
+    }
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int iters = argc > 1 ? atoi(argv[1]) : 400;
+    int seed = argc > 2 ? atoi(argv[2]) : 1;
+    int ntime = argc > 3 ? atoi(argv[3]) : 2000;
+    srand(seed);
+    new cTimer;
+    new cTimeDbg;
+    new cGEO;
+
+    int nfail = 0;
+    Zlist *zc = crossing_zoids();
+    for (int op = ZSor; op <= ZSself_andnot; op++) {
+        Zlist *zr = Zlist::sweep(zc, 0, (ZSop)op);
+        int nbad = check((ZSop)op, zc, 0, zr, false);
+        if (nbad) {
+            printf("crossings, %s: %d bad samples\n", opnames[op], nbad);
+            nfail++;
+        }
+        Zlist::destroy(zr);
+    }
+    Zlist::destroy(zc);
+
+    for (int it = 0; it < iters; it++) {
+        bool manh = (it & 1);
+        Zlist *za = random_zoids(1 + rand() % 12, manh, 40);
+        Zlist *zb = random_zoids(1 + rand() % 12, manh, 40);
+        for (int op = ZSor; op <= ZSself_andnot; op++) {
+            Zlist *zr = Zlist::sweep(za, zb, (ZSop)op);
+            int nbad = check((ZSop)op, za, zb, zr, manh);
+            if (nbad) {
+                printf("iteration %d, %s %s: %d bad samples\n", it,
+                    manh ? "Manhattan" : "non-Manhattan", opnames[op],
+                    nbad);
+                nfail++;
+            }
+            Zlist::destroy(zr);
+        }
+        Zlist::destroy(za);
+        Zlist::destroy(zb);
+    }
+    printf("%d of %d tests failed\n", nfail, 6*iters + 6);
+
+    // About two zoids cover each point on average.
+    if (ntime > 0) {
+        int sz = (int)sqrt(50.0*ntime);
+        for (int m = 1; m >= 0; m--) {
+            Zlist *za = random_zoids(ntime, m, sz);
+            Zlist *zb = random_zoids(ntime, m, sz);
+            printf("timing, %d + %d %s zoids\n", ntime, ntime,
+                m ? "Manhattan" : "non-Manhattan");
+            double ty = time_ops(za, zb, ZSoff);
+            double ts = time_ops(za, zb, ZSon);
+            printf("  total        Ylist  %.4f sec\n", ty);
+            printf("  total        sweep  %.4f sec\n", ts);
+            Zlist::destroy(za);
+            Zlist::destroy(zb);
+        }
+    }
+    return (nfail != 0);
+}
+
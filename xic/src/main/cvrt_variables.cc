@@ -939,6 +939,26 @@ namespace {
         CDvdb()->registerPostFunc(postset);
         return (true);
     }
+
+    bool
+    evOasWriteThreads(const char *vstring, bool set)
+    {
+        if (set) {
+            int i;
+            if (str_to_int(&i, vstring) && i >= 0 && i <= OAS_MAX_THREADS)
+                FIO()->SetOasWriteThreads(i);
+            else {
+                Log()->ErrorLogV(mh::Variables,
+                    "Incorrect OasWriteThreads: requires integer 0-%d.",
+                    OAS_MAX_THREADS);
+                return (false);
+            }
+        }
+        else
+            FIO()->SetOasWriteThreads(0);
+        CDvdb()->registerPostFunc(postset);
+        return (true);
+    }
 }
 
 
@@ -1060,5 +1080,6 @@ cConvert::setupVariables()
     vsetup(VA_OasWriteNoGCDcheck,       B,  evOasWriteNoGCDcheck);
     vsetup(VA_OasWriteUseFastSort,      B,  evOasWriteUseFastSort);
     vsetup(VA_OasWritePrptyMask,        S,  evOasWritePrptyMask);
+    vsetup(VA_OasWriteThreads,          S,  evOasWriteThreads);
 }
 
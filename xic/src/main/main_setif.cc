@@ -84,7 +84,10 @@ namespace {
         }
         else {
             sdesc->reflectBadExtract();
-            sdesc->unsetConnected();
+            // If possible, the grouping is patched locally before
+            // use, otherwise everything is regrouped.
+            if (!ExtIf()->updateGroups(sdesc, odesc, false))
+                sdesc->unsetConnected();
             if (odesc->type() == CDINSTANCE ||
                     !(*sdesc->BB() > odesc->oBB()))
                 sdesc->reflectBadGroundPlane();
@@ -149,9 +152,12 @@ namespace {
                 cbin.phys()->reflectBadExtract();
         }
         else {
-            ExtIf()->clearGroups(sdesc);
+            bool keep = ExtIf()->updateGroups(sdesc, odesc, true);
+            if (!keep)
+                ExtIf()->clearGroups(sdesc);
             sdesc->reflectBadExtract();
-            sdesc->unsetConnected();
+            if (!keep)
+                sdesc->unsetConnected();
             if (odesc->type() == CDINSTANCE ||
                     !(*sdesc->BB() > odesc->oBB()))
                 sdesc->reflectBadGroundPlane();
@@ -869,6 +869,7 @@ cMain::SetupVariables()
     vsetup(VA_PCellKeepSubMasters, B,   0);
     vsetup(VA_PCellListSubMasters, B,   0);
     vsetup(VA_PCellScriptPath,     0,   0);
+    vsetup(VA_PCellCacheDir,       0,   0);
     vsetup(VA_PCellShowAllWarnings,B,   0);
 
     // Standard Vias
@@ -45,6 +45,7 @@
 #include "dsp_tkif.h"
 #include "dsp_inlines.h"
 #include "miscutil/miscutil.h"
+#include "miscutil/lstring.h"
 #ifdef HAVE_LOCAL_ALLOCATOR
 #include "malloc/local_malloc.h"
 #else
@@ -357,6 +358,68 @@ namespace {
         PL()->ShowPrompt("Allocation monitor not available.");
 #endif
     }
+
+
+    void
+    monsample(const char *s)
+    {
+#ifdef HAVE_LOCAL_ALLOCATOR
+        size_t intvl = 0;
+        if (*s)
+            intvl = strtoul(s, 0, 10);
+        if (Memory()->mon_prof_start(intvl))
+            PL()->ShowPrompt("Sampling heap profiler started.");
+        else
+            PL()->ShowPrompt(
+                "Profiler not started, allocation monitor active?");
+#else
+        (void)s;
+        PL()->ShowPrompt("Allocation monitor not available.");
+#endif
+    }
+
+
+    void
+    monprofile(const char *s)
+    {
+#ifdef HAVE_LOCAL_ALLOCATOR
+        // Arguments: [filename] [pprof]
+        char *fname = lstring::getqtok(&s);
+        char *tok = lstring::gettok(&s);
+        bool pprof = tok && lstring::cieq(tok, "pprof");
+        delete [] tok;
+        if (Memory()->mon_prof_dump(fname ? fname : "mon_prof.out", pprof))
+            PL()->ShowPromptV("Heap profile in file \"%s\".",
+                fname ? fname : "mon_prof.out");
+        else
+            PL()->ShowPrompt("Profile dump failed, profiler never started?");
+        delete [] fname;
+#else
+        (void)s;
+        PL()->ShowPrompt("Allocation monitor not available.");
+#endif
+    }
+
+
+    void
+    monthreads(const char *s)
+    {
+#ifdef HAVE_LOCAL_ALLOCATOR
+        // Arguments: [filename]
+        char *fname = lstring::getqtok(&s);
+        const char *fn = fname ? fname : "mon_threads.out";
+        if (!Memory()->tcache_active())
+            PL()->ShowPrompt("Thread cache is not in use.");
+        else if (Memory()->mon_thread_dump(fn))
+            PL()->ShowPromptV("Thread statistics in file \"%s\".", fn);
+        else
+            PL()->ShowPrompt("Thread statistics dump failed.");
+        delete [] fname;
+#else
+        (void)s;
+        PL()->ShowPrompt("Allocation monitor not available.");
+#endif
+    }
 }
 
 
@@ -372,5 +435,8 @@ cMain::setupMemoryBangCmds()
     RegisterBangCmd("monstart", &monstart);
     RegisterBangCmd("monstop", &monstop);
     RegisterBangCmd("monstatus", &monstatus);
+    RegisterBangCmd("monsample", &monsample);
+    RegisterBangCmd("monprofile", &monprofile);
+    RegisterBangCmd("monthreads", &monthreads);
 }
 
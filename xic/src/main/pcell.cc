@@ -672,14 +672,24 @@ cPCellDb::openSubMaster(const CDs *sdsup, const char *params, CDs **sdret)
             return (OIerror);
         }
         if (sdsub) {
-            sdsup->cloneCell(sdsub);
-            sdsub->prptyRemove(XICP_PC_PARAMS);
-            sdsub->prptyAdd(XICP_PC_PARAMS, params);
-            if (!evalScript(sdsub, Tstring(sdsup->cellname()))) {
-                Errs()->add_error("Error: pcell evaluation failed.");
-                delete sdsub;
-                return (OIerror);
+            // Use the saved sub-master from the cache if possible,
+            // otherwise evaluate and save.
+            char *key = cacheKey(sdsup, params);
+            if (!readCache(key, sdsub, Tstring(sdsup->cellname()),
+                    params)) {
+                sdsup->cloneCell(sdsub);
+                sdsub->prptyRemove(XICP_PC_PARAMS);
+                sdsub->prptyAdd(XICP_PC_PARAMS, params);
+                if (!evalScript(sdsub, Tstring(sdsup->cellname()))) {
+                    Errs()->add_error("Error: pcell evaluation failed.");
+                    delete [] key;
+                    delete sdsub;
+                    return (OIerror);
+                }
+                if (key)
+                    writeCache(key, sdsub);
             }
+            delete [] key;
         }
     }
     else
@@ -774,12 +784,19 @@ cPCellDb::openSubMaster(const char *nmstr, const char *prpstr, CDs **psd,
             CDcdb()->linkCell(sdesc);
             delete [] newcname;
         }
-        sdsup->cloneCell(sdesc);
-        sdesc->prptyAdd(XICP_PC_PARAMS, prpstr);
-        if (!evalScript(sdesc, Tstring(sdsup->cellname()))) {
-            Errs()->add_error("openSubMaster: pcell evaluation failed.");
-            return (false);
+        char *key = cacheKey(sdsup, prpstr);
+        if (!readCache(key, sdesc, Tstring(sdsup->cellname()), prpstr)) {
+            sdsup->cloneCell(sdesc);
+            sdesc->prptyAdd(XICP_PC_PARAMS, prpstr);
+            if (!evalScript(sdesc, Tstring(sdsup->cellname()))) {
+                Errs()->add_error("openSubMaster: pcell evaluation failed.");
+                delete [] key;
+                return (false);
+            }
+            if (key)
+                writeCache(key, sdesc);
         }
+        delete [] key;
         if (psd)
             *psd = sdesc;
     }
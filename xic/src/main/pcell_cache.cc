@@ -0,0 +1,802 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "main.h"
+#include "pcell.h"
+#include "pcell_params.h"
+#include "cd_propnum.h"
+#include "cd_lgen.h"
+#include "cd_hypertext.h"
+#include "fio.h"
+#include "si_parsenode.h"
+#include "si_parser.h"
+#include "si_interp.h"
+#include "main_variables.h"
+#include "tech.h"
+#include "miscutil/pathlist.h"
+#include "miscutil/filestat.h"
+#include "miscutil/encode.h"
+#include <unistd.h>
+
+
+//-----------------------------------------------------------------------------
+// PCell Sub-Master Cache
+//
+// Evaluating a pcell script can be slow, and a design may contain
+// many thousands of sub-masters, which are re-created from the
+// scripts each time the design is opened.  If the PCellCacheDir
+// variable names a directory, evaluated physical sub-masters are
+// saved there, and are used in place of evaluation when the same
+// sub-master is needed again.
+//
+// A cache file name is an MD5 digest computed from the super-master
+// name, the script text (and the script file content if @READ is
+// used), the default parameters, the canonical parameter string of
+// the sub-master, the database resolution, and the physical layer
+// definitions from the technology.  The text of scripts run with
+// Exec("name") is included as well.  Changing any of these produces
+// a different key, so stale entries are never used, but they are
+// never removed either.
+//
+// Only native scripts are cached.  A script that calls a function
+// that it doesn't define, which may come from a library or another
+// script, or that runs a script whose name is not a literal string,
+// has dependencies that can't be tracked, and is always evaluated.
+//
+// Only physical sub-masters that contain boxes, polygons, wires, and
+// labels are cached.  Sub-masters with instances depend on other
+// cells, and are always evaluated.
+//
+// File format.  Numbers are decimal text, strings are given as a
+// length and the text on the following line.
+//
+//   XicPCellCache 1
+//   P value len\ntext    cell property
+//   L len\nname          layer for subsequent objects
+//   B l b r t            box
+//   Y n x y ...          polygon
+//   W attr n x y ...     wire
+//   T x y w h xf len\ntext label
+//   p value len\ntext    property of the previous object
+//   E                    end of data
+
+#define PCC_MAGIC   "XicPCellCache 1"
+
+
+namespace {
+    // Return the expanded cache directory path, or null if the
+    // directory is not set or doesn't exist.
+    //
+    char *pcc_cache_dir()
+    {
+        const char *dir = CDvdb()->getVariable(VA_PCellCacheDir);
+        if (!dir || !*dir)
+            return (0);
+        char *xdir = pathlist::expand_path(dir, false, true);
+        if (!filestat::is_directory(xdir)) {
+            delete [] xdir;
+            return (0);
+        }
+        return (xdir);
+    }
+
+
+    // Read a string written as "len\ntext".  The return is null on
+    // error, including a length longer than the rest of the file of
+    // size fsize.
+    //
+    char *pcc_get_string(FILE *fp, long fsize)
+    {
+        int len;
+        if (fscanf(fp, "%d", &len) != 1 || len < 0)
+            return (0);
+        if (getc(fp) != '\n')
+            return (0);
+        if (len > fsize - ftell(fp))
+            return (0);
+        char *s = new char[len + 1];
+        if (fread(s, 1, len, fp) != (size_t)len) {
+            delete [] s;
+            return (0);
+        }
+        s[len] = 0;
+        return (s);
+    }
+
+    void pcc_put_string(FILE *fp, const char *s)
+    {
+        if (!s)
+            s = "";
+        fprintf(fp, "%d\n", (int)strlen(s));
+        fputs(s, fp);
+        putc('\n', fp);
+    }
+
+    // Read a point list written as "n x y ...".  Each point takes at
+    // least four bytes, which bounds n by the rest of the file of size
+    // fsize.
+    //
+    bool pcc_get_points(FILE *fp, long fsize, int *pn, Point **ppts)
+    {
+        int n;
+        if (fscanf(fp, "%d", &n) != 1 || n < 1)
+            return (false);
+        if (n > (fsize - ftell(fp))/4)
+            return (false);
+        Point *pts = new Point[n];
+        for (int i = 0; i < n; i++) {
+            if (fscanf(fp, "%d %d", &pts[i].x, &pts[i].y) != 2) {
+                delete [] pts;
+                return (false);
+            }
+        }
+        *pn = n;
+        *ppts = pts;
+        return (true);
+    }
+
+    void pcc_put_points(FILE *fp, const Point *pts, int n)
+    {
+        fprintf(fp, " %d", n);
+        for (int i = 0; i < n; i++)
+            fprintf(fp, " %d %d", pts[i].x, pts[i].y);
+        putc('\n', fp);
+    }
+
+    // Property from the cache file.
+    struct pcc_prp
+    {
+        pcc_prp(int v, char *s, pcc_prp *n)
+            {
+                next = n;
+                string = s;
+                value = v;
+            }
+
+        ~pcc_prp()
+            {
+                delete [] string;
+            }
+
+        static void destroy(pcc_prp *p)
+            {
+                while (p) {
+                    pcc_prp *px = p;
+                    p = p->next;
+                    delete px;
+                }
+            }
+
+        pcc_prp *next;
+        char *string;
+        int value;
+    };
+
+    // Object from the cache file.  The file is completely read
+    // before anything is added to the cell, so that a bad file
+    // doesn't leave a partial sub-master.
+    //
+    struct pcc_obj
+    {
+        pcc_obj(CDl *ld, int t)
+            {
+                next = 0;
+                ldesc = ld;
+                prps = 0;
+                points = 0;
+                text = 0;
+                numpts = 0;
+                attr = 0;
+                type = t;
+            }
+
+        ~pcc_obj()
+            {
+                delete [] points;
+                delete [] text;
+                pcc_prp::destroy(prps);
+            }
+
+        static void destroy(pcc_obj *o)
+            {
+                while (o) {
+                    pcc_obj *ox = o;
+                    o = o->next;
+                    delete ox;
+                }
+            }
+
+        pcc_obj *next;
+        CDl *ldesc;
+        pcc_prp *prps;
+        Point *points;
+        char *text;
+        BBox BB;
+        Label label;
+        int numpts;
+        unsigned int attr;
+        int type;
+    };
+}
+
+
+namespace {
+    // Read the remaining text from sfp into lstr.
+    //
+    void pcc_read(SIfile *sfp, sLstr &lstr)
+    {
+        int c;
+        while ((c = sfp->sif_getc()) != EOF)
+            lstr.add_c(c);
+    }
+
+
+    // Add the database resolution and the physical layer definitions
+    // to the key.  The script may create objects on any layer, and
+    // the layer properties and resolution affect what it creates.
+    //
+    void pcc_hash_tech(MD5cx &context)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%d", CDphysResolution);
+        context.update((const unsigned char*)buf, strlen(buf) + 1);
+
+        sLstr lstr;
+        int nused = CDldb()->layersUsed(Physical);
+        for (int i = 1; i < nused; i++)
+            Tech()->PrintLayerBlock(0, &lstr, false,
+                CDldb()->layer(i, Physical), Physical);
+        const char *s = lstr.string() ? lstr.string() : "";
+        context.update((const unsigned char*)s, strlen(s) + 1);
+    }
+
+
+    inline bool pcc_idchar(int c)
+    {
+        return (isalnum(c) || c == '_' || c == '$');
+    }
+
+
+    // Add the text of scripts called with Exec from text to the key,
+    // recursively.  Return false if the script has dependencies that
+    // can't be tracked:  a call of a function not defined in the text
+    // that is a user function, or an Exec whose argument is not a
+    // literal string or names a script that can't be opened.
+    //
+    bool pcc_hash_deps(MD5cx &context, const char *text, int depth)
+    {
+        if (depth > 8)
+            return (false);
+        SymTab *ftab = SI()->GetFuncTab();
+
+        // Names of functions defined in text.
+        SymTab deftab(true, false);
+        const char *t = text;
+        while (*t) {
+            if (*t == '"') {
+                for (t++; *t && *t != '"'; t++) {
+                    if (*t == '\\' && t[1])
+                        t++;
+                }
+                if (*t)
+                    t++;
+                continue;
+            }
+            if (!pcc_idchar(*t) || (t > text && pcc_idchar(t[-1]))) {
+                t++;
+                continue;
+            }
+            const char *s = t;
+            while (pcc_idchar(*t))
+                t++;
+            if (t - s == 8 && !strncmp(s, "function", 8)) {
+                while (isspace(*t))
+                    t++;
+                s = t;
+                while (pcc_idchar(*t))
+                    t++;
+                if (t > s) {
+                    char *nm = new char[t - s + 1];
+                    strncpy(nm, s, t - s);
+                    nm[t - s] = 0;
+                    if (SymTab::get(&deftab, nm) == ST_NIL)
+                        deftab.add(nm, 0, false);
+                    else
+                        delete [] nm;
+                }
+            }
+        }
+
+        t = text;
+        while (*t) {
+            if (*t == '"') {
+                for (t++; *t && *t != '"'; t++) {
+                    if (*t == '\\' && t[1])
+                        t++;
+                }
+                if (*t)
+                    t++;
+                continue;
+            }
+            if (!pcc_idchar(*t) || (t > text && pcc_idchar(t[-1]))) {
+                t++;
+                continue;
+            }
+            const char *s = t;
+            while (pcc_idchar(*t))
+                t++;
+            int len = t - s;
+            const char *e = t;
+            while (isspace(*e))
+                e++;
+            if (*e != '(')
+                continue;
+            char nm[256];
+            if (len >= (int)sizeof(nm))
+                continue;
+            strncpy(nm, s, len);
+            nm[len] = 0;
+
+            if (!strcmp(nm, "Exec")) {
+                e++;
+                while (isspace(*e))
+                    e++;
+                if (*e != '"')
+                    return (false);
+                e++;
+                const char *n = e;
+                while (*e && *e != '"')
+                    e++;
+                if (*e != '"' || e == n)
+                    return (false);
+                char *sname = new char[e - n + 1];
+                strncpy(sname, n, e - n);
+                sname[e - n] = 0;
+                SIfile *sfp;
+                stringlist *wl;
+                XM()->OpenScript(sname, &sfp, &wl);
+                delete [] sname;
+                sLstr lstr;
+                if (sfp) {
+                    pcc_read(sfp, lstr);
+                    delete sfp;
+                }
+                else if (wl) {
+                    // Saved tech script, don't free.
+                    for (stringlist *sl = wl; sl; sl = sl->next) {
+                        lstr.add(sl->string);
+                        lstr.add_c('\n');
+                    }
+                }
+                else
+                    return (false);
+                const char *str = lstr.string() ? lstr.string() : "";
+                context.update((const unsigned char*)str, strlen(str) + 1);
+                if (!pcc_hash_deps(context, str, depth + 1))
+                    return (false);
+                continue;
+            }
+            if (ftab && SymTab::get(ftab, nm) != ST_NIL &&
+                    SymTab::get(&deftab, nm) == ST_NIL)
+                return (false);
+        }
+        return (true);
+    }
+}
+
+
+// Return the cache key for the sub-master of sdsup with the given
+// parameter string, or null if caching is not enabled or does not
+// apply.  The return should be freed by the caller.
+//
+char *
+cPCellDb::cacheKey(const CDs *sdsup, const char *params)
+{
+    if (!sdsup || sdsup->isElectrical() || sdsup->pcType() != CDpcXic)
+        return (0);
+    char *xdir = pcc_cache_dir();
+    if (!xdir)
+        return (0);
+    delete [] xdir;
+    CDp *pscr = sdsup->prpty(XICP_PC_SCRIPT);
+    CDp *pdef = sdsup->prpty(XICP_PC_PARAMS);
+    if (!pscr || !pdef)
+        return (0);
+
+    // The parameters are put in the canonical order and form of the
+    // defaults, so that equivalent strings give the same key.
+    char *cprms;
+    if (!formatParams(params, &cprms, pdef->string())) {
+        Errs()->get_error();
+        return (0);
+    }
+
+    MD5cx context;
+    const char *nm = Tstring(sdsup->cellname());
+    context.update((const unsigned char*)nm, strlen(nm) + 1);
+    const char *s = pscr->string() ? pscr->string() : "";
+    context.update((const unsigned char*)s, strlen(s) + 1);
+    s = pdef->string() ? pdef->string() : "";
+    context.update((const unsigned char*)s, strlen(s) + 1);
+    context.update((const unsigned char*)cprms, strlen(cprms) + 1);
+    delete [] cprms;
+
+    // If the script is read from a file, the file content is part of
+    // the key.
+    SIfile *sfp;
+    char *scr;
+    PClangType lang;
+    if (!openScript(sdsup, &sfp, &scr, &lang)) {
+        Errs()->get_error();
+        return (0);
+    }
+    sLstr lstr;
+    if (sfp) {
+        pcc_read(sfp, lstr);
+        delete sfp;
+        s = lstr.string() ? lstr.string() : "";
+        context.update((const unsigned char*)s, strlen(s));
+    }
+    else
+        lstr.add(scr);
+    delete [] scr;
+    if (lang != PCnative)
+        return (0);
+    s = lstr.string() ? lstr.string() : "";
+    if (!pcc_hash_deps(context, s, 0))
+        return (0);
+    pcc_hash_tech(context);
+
+    unsigned char digest[16];
+    context.final(digest);
+    char tbf[4];
+    sLstr kstr;
+    for (int i = 0; i < 16; i++) {
+        snprintf(tbf, sizeof(tbf), "%02x", digest[i]);
+        kstr.add(tbf);
+    }
+    return (kstr.string_trim());
+}
+
+
+namespace {
+    // Return the path to the cache file for key, or null if the
+    // cache directory is not set or doesn't exist.
+    //
+    char *pcc_path(const char *key)
+    {
+        if (!key)
+            return (0);
+        char *xdir = pcc_cache_dir();
+        if (!xdir)
+            return (0);
+        char *path = pathlist::mk_path(xdir, key);
+        delete [] xdir;
+        char *p = new char[strlen(path) + 5];
+        sprintf(p, "%s.xpc", path);
+        delete [] path;
+        return (p);
+    }
+}
+
+
+// Fill in the sub-master sdesc from the cache file for key, if
+// there is one.  The sdesc should be empty.  On success, sdesc is
+// set up as it would be by evalScript, with params as the parameter
+// property and pcname as the pcell name property, and true is
+// returned.  If false is returned, sdesc is unchanged.
+//
+bool
+cPCellDb::readCache(const char *key, CDs *sdesc, const char *pcname,
+    const char *params)
+{
+    if (!sdesc)
+        return (false);
+    char *path = pcc_path(key);
+    if (!path)
+        return (false);
+    FILE *fp = fopen(path, "rb");
+    delete [] path;
+    if (!fp)
+        return (false);
+
+    // The file may be corrupt, lengths read from it are checked
+    // against the file size before allocating.
+    fseek(fp, 0, SEEK_END);
+    long fsize = ftell(fp);
+    rewind(fp);
+
+    char tbf[64];
+    if (!fgets(tbf, sizeof(tbf), fp) || strncmp(tbf, PCC_MAGIC,
+            strlen(PCC_MAGIC))) {
+        fclose(fp);
+        return (false);
+    }
+
+    pcc_prp *cprps = 0;
+    pcc_obj *o0 = 0, *oe = 0;
+    CDl *ld = 0;
+    bool ok = false;
+    for (;;) {
+        char c;
+        if (fscanf(fp, " %c", &c) != 1)
+            break;
+        if (c == 'E') {
+            ok = true;
+            break;
+        }
+        if (c == 'P' || c == 'p') {
+            int v;
+            if (fscanf(fp, "%d", &v) != 1)
+                break;
+            char *s = pcc_get_string(fp, fsize);
+            if (!s)
+                break;
+            if (c == 'P')
+                cprps = new pcc_prp(v, s, cprps);
+            else if (oe)
+                oe->prps = new pcc_prp(v, s, oe->prps);
+            else {
+                delete [] s;
+                break;
+            }
+            continue;
+        }
+        if (c == 'L') {
+            char *s = pcc_get_string(fp, fsize);
+            if (!s)
+                break;
+            // The layer must exist, the cached sub-master is not
+            // used otherwise.
+            ld = CDldb()->findLayer(s, Physical);
+            delete [] s;
+            if (!ld)
+                break;
+            continue;
+        }
+        if (!ld)
+            break;
+        pcc_obj *o = 0;
+        if (c == 'B') {
+            o = new pcc_obj(ld, CDBOX);
+            if (fscanf(fp, "%d %d %d %d", &o->BB.left, &o->BB.bottom,
+                    &o->BB.right, &o->BB.top) != 4) {
+                delete o;
+                break;
+            }
+        }
+        else if (c == 'Y') {
+            o = new pcc_obj(ld, CDPOLYGON);
+            if (!pcc_get_points(fp, fsize, &o->numpts, &o->points)) {
+                delete o;
+                break;
+            }
+        }
+        else if (c == 'W') {
+            o = new pcc_obj(ld, CDWIRE);
+            if (fscanf(fp, "%u", &o->attr) != 1 ||
+                    !pcc_get_points(fp, fsize, &o->numpts, &o->points)) {
+                delete o;
+                break;
+            }
+        }
+        else if (c == 'T') {
+            o = new pcc_obj(ld, CDLABEL);
+            if (fscanf(fp, "%d %d %d %d %d", &o->label.x, &o->label.y,
+                    &o->label.width, &o->label.height,
+                    &o->label.xform) != 5 ||
+                    !(o->text = pcc_get_string(fp, fsize))) {
+                delete o;
+                break;
+            }
+        }
+        else
+            break;
+        if (!o0)
+            o0 = oe = o;
+        else {
+            oe->next = o;
+            oe = o;
+        }
+    }
+    fclose(fp);
+    if (!ok) {
+        pcc_prp::destroy(cprps);
+        pcc_obj::destroy(o0);
+        return (false);
+    }
+
+    // Install everything into sdesc.  As in evalScript, suppress the
+    // coincident object warnings.
+
+    cCD::DupCheck tmp_dupchk = CD()->DupCheckMode();
+    if (!FIO()->IsShowAllPCellWarnings())
+        CD()->SetDupCheckMode(cCD::DupNoTest);
+
+    for (pcc_prp *p = cprps; p; p = p->next)
+        sdesc->prptyAdd(p->value, p->string);
+    pcc_prp::destroy(cprps);
+    sdesc->prptyRemove(XICP_PC_PARAMS);
+    sdesc->prptyAdd(XICP_PC_PARAMS, params);
+    sdesc->prptyRemove(XICP_PC);
+    sdesc->prptyAdd(XICP_PC, pcname);
+
+    for (pcc_obj *o = o0; o; o = o->next) {
+        CDo *newo = 0;
+        if (o->type == CDBOX)
+            sdesc->makeBox(o->ldesc, &o->BB, &newo);
+        else if (o->type == CDPOLYGON) {
+            Poly poly(o->numpts, o->points);
+            o->points = 0;
+            CDpo *newp;
+            if (sdesc->makePolygon(o->ldesc, &poly, &newp) == CDok)
+                newo = newp;
+        }
+        else if (o->type == CDWIRE) {
+            Wire wire(o->numpts, o->points, o->attr);
+            o->points = 0;
+            CDw *neww;
+            if (sdesc->makeWire(o->ldesc, &wire, &neww) == CDok)
+                newo = neww;
+        }
+        else if (o->type == CDLABEL) {
+            o->label.label = new hyList(sdesc, o->text, HYcvAscii);
+            CDla *newl;
+            if (sdesc->makeLabel(o->ldesc, &o->label, &newl) == CDok)
+                newo = newl;
+        }
+        if (newo) {
+            for (pcc_prp *p = o->prps; p; p = p->next)
+                newo->prptyAdd(p->value, p->string, Physical);
+        }
+    }
+    pcc_obj::destroy(o0);
+
+    CD()->SetDupCheckMode(tmp_dupchk);
+    sdesc->setPCell(true, false, false);
+    return (true);
+}
+
+
+// Save the evaluated sub-master sdesc in the cache under key.  The
+// file is written under a temporary name and renamed, so that a
+// partial file is never seen by readCache.  Return true if the file
+// was written.
+//
+bool
+cPCellDb::writeCache(const char *key, const CDs *sdesc)
+{
+    if (!sdesc || sdesc->isElectrical())
+        return (false);
+
+    // Sub-masters with instances are not cached.
+    CDm_gen mgen(sdesc, GEN_MASTERS);
+    if (mgen.m_first())
+        return (false);
+
+    char *path = pcc_path(key);
+    if (!path)
+        return (false);
+    char *tpath = new char[strlen(path) + 16];
+    sprintf(tpath, "%s.%d", path, (int)getpid());
+    FILE *fp = fopen(tpath, "wb");
+    if (!fp) {
+        delete [] tpath;
+        delete [] path;
+        return (false);
+    }
+
+    fprintf(fp, "%s\n", PCC_MAGIC);
+    for (CDp *pd = sdesc->prptyList(); pd; pd = pd->next_prp()) {
+        // These are supplied when read.
+        if (pd->value() == XICP_PC_PARAMS || pd->value() == XICP_PC)
+            continue;
+        char *s;
+        if (!pd->string(&s))
+            continue;
+        fprintf(fp, "P %d ", pd->value());
+        pcc_put_string(fp, s);
+        delete [] s;
+    }
+
+    bool ok = true;
+    CDl *ld;
+    CDsLgen lgen(sdesc);
+    while (ok && (ld = lgen.next()) != 0) {
+        CDg gdesc;
+        gdesc.init_gen(sdesc, ld);
+        CDo *odesc;
+        bool first = true;
+        while ((odesc = gdesc.next()) != 0) {
+            if (!odesc->is_normal())
+                continue;
+            if (first) {
+                fputs("L ", fp);
+                pcc_put_string(fp, ld->name());
+                first = false;
+            }
+            if (odesc->type() == CDBOX) {
+                const BBox &BB = odesc->oBB();
+                fprintf(fp, "B %d %d %d %d\n", BB.left, BB.bottom,
+                    BB.right, BB.top);
+            }
+            else if (odesc->type() == CDPOLYGON) {
+                const CDpo *po = (const CDpo*)odesc;
+                fputs("Y", fp);
+                pcc_put_points(fp, po->points(), po->numpts());
+            }
+            else if (odesc->type() == CDWIRE) {
+                const CDw *w = (const CDw*)odesc;
+                fprintf(fp, "W %u", w->attributes());
+                pcc_put_points(fp, w->points(), w->numpts());
+            }
+            else if (odesc->type() == CDLABEL) {
+                const CDla *la = (const CDla*)odesc;
+                char *s = hyList::string(la->label(), HYcvAscii, true);
+                fprintf(fp, "T %d %d %d %d %d ", la->xpos(), la->ypos(),
+                    la->width(), la->height(), la->xform());
+                pcc_put_string(fp, s);
+                delete [] s;
+            }
+            else {
+                ok = false;
+                break;
+            }
+            for (CDp *pd = odesc->prpty_list(); pd; pd = pd->next_prp()) {
+                char *s;
+                if (!pd->string(&s))
+                    continue;
+                fprintf(fp, "p %d ", pd->value());
+                pcc_put_string(fp, s);
+                delete [] s;
+            }
+        }
+    }
+    fputs("E\n", fp);
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok || rename(tpath, path) != 0) {
+        unlink(tpath);
+        ok = false;
+    }
+    delete [] tpath;
+    delete [] path;
+    return (ok);
+}
@@ -409,6 +409,13 @@ namespace {
 #ifdef SIGIO
         else if (sig == SIGIO)
             return;
+#endif
+#if defined(SIGUSR2) && defined(HAVE_LOCAL_ALLOCATOR)
+        else if (sig == SIGUSR2 && Memory()->mon_prof_active()) {
+            // Dump a heap profile from the sampling profiler.
+            Memory()->mon_prof_request();
+            return;
+        }
 #endif
         else {
             if (XM()->RunMode() == ModeBackground) {
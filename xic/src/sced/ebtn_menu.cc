@@ -489,31 +489,51 @@ ebtn_menu::M_SpiceCmd(CmdDesc *cmd)
             // databuf[0]      'o'
             // databuf[1]      'k'
             // databuf[2]      'd'  (datatype double, other types may be
-            //                       added in future)
+            //                       added in future), or 'n', double
+            //                       in native byte order
             // databuf[3]      'r' or 'c' (real or complex)
             // databuf[4-7]    array size, network byte order
+            //                   (native byte order if 'n')
             // ...             array of data values, network byte order
+            //                   (native byte order if 'n')
+            //
+            // The 'n' form is returned from a local WRspice through
+            // shared memory.
 
             printf("\n");
-            if (databuf[0] != 'o' || databuf[1] != 'k' || databuf[2] != 'd') {
+            bool native = (databuf[2] == 'n');
+            if (databuf[0] != 'o' || databuf[1] != 'k' ||
+                    (databuf[2] != 'd' && !native)) {
                 // error (shouldn't happen)
                 delete [] databuf;
                 return;
             }
 
             // We'll just print the first 10 values of the return.
-            unsigned int size = ntohl(*(int*)(databuf+4));
+            unsigned int size = *(unsigned int*)(databuf+4);
+            if (!native)
+                size = ntohl(size);
             double *dp = (double*)(databuf + 8);
             for (unsigned int i = 0; i < size; i++) {
                 if (i == 10) {
                     printf("...\n");
                     break;
                 }
-                if (databuf[3] == 'r')      // real values
-                    printf("%d   %g\n", i, net_byte_reorder(dp[i]));
-                else if (databuf[3] == 'c') //complex values
-                    printf("%d   %g,%g\n", i, net_byte_reorder(dp[2*i]),
-                        net_byte_reorder(dp[2*i + 1]));
+                if (databuf[3] == 'r') {    // real values
+                    double d = dp[i];
+                    if (!native)
+                        d = net_byte_reorder(d);
+                    printf("%d   %g\n", i, d);
+                }
+                else if (databuf[3] == 'c') { //complex values
+                    double dr = dp[2*i];
+                    double di = dp[2*i + 1];
+                    if (!native) {
+                        dr = net_byte_reorder(dr);
+                        di = net_byte_reorder(di);
+                    }
+                    printf("%d   %g,%g\n", i, dr, di);
+                }
                 else
                     // wacky error, can't happen
                     break;
@@ -105,6 +105,7 @@
 #include <sys/file.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <time.h>
 #endif
 
@@ -153,6 +154,12 @@ cSpiceIPC::InitSpice()
         CloseSpice();
 
     ipc_level = 1;
+
+    // Nothing buffered from an earlier connection can be read from
+    // the new one, and shared memory use is set by the ping reply.
+    ipc_rbuf_cnt = 0;
+    ipc_rbuf_ptr = 0;
+    ipc_shm_ok = false;
 #ifdef SIGPIPE
     ipc_sigpipe_back = signal(SIGPIPE, SIG_IGN);
 #endif
@@ -399,11 +406,19 @@ cSpiceIPC::RunSpice(CmdDesc *cmd)
     //     mode arg is given, "ok<catchar>" if not.
     //
     // The argument(s) to ping have the following syntax:
-    //   [-sc<catchar>][ ][-sm<mode>] 
+    //   [-sc<catchar>][ ][-sm<mode>][ ][-sh]
     // where <mode> is a digit character ('0' plus the enum value).
+    // The -sh is a query for shared memory support, sent only if
+    // WRspice is running on the local machine.  A WRspice that
+    // supports this appends 's' to the return, earlier releases
+    // ignore it.
 
-    snprintf(tbuf, sizeof(tbuf), "ping -sc%c-sm%c", CD()->GetSubcCatchar(),
-        '0' + CD()->GetSubcCatmode());
+    bool local = !(ipc_spice_host && *ipc_spice_host);
+#ifdef WIN32
+    local = false;
+#endif
+    snprintf(tbuf, sizeof(tbuf), "ping -sc%c-sm%c%s", CD()->GetSubcCatchar(),
+        '0' + CD()->GetSubcCatmode(), local ? "-sh" : "");
     char *tbf = send_to_spice(tbuf, 10);
     if (!tbf) {
         PL()->ShowPrompt(msg);
@@ -435,6 +450,7 @@ cSpiceIPC::RunSpice(CmdDesc *cmd)
                 CDvdb()->setVariable(VA_SpiceSubcCatmode, "wrspice");
             else
                 CDvdb()->setVariable(VA_SpiceSubcCatmode, "spice3");
+            ipc_shm_ok = (local && tbf[4] == 's');
         }
     }
     else {
@@ -711,6 +727,17 @@ cSpiceIPC::DoCmd(const char *cmd, char **retbuf, char **outbuf,
         // buffer becomes full, so we need to read stdout before
         // reading the message return.
 
+        // A local WRspice that supports it will return eval data
+        // through shared memory.
+        sLstr shmlstr;
+        if (ipc_shm_ok && databuf && lstring::match("eval", cmd)) {
+            const char *t = cmd;
+            lstring::advtok(&t);
+            shmlstr.add("evalshm ");
+            shmlstr.add(t);
+            cmd = shmlstr.string();
+        }
+
         if (!write_msg(cmd, ipc_msg_skt)) {
             if (retbuf)
                 *retbuf = lstring::copy("Connection broken, write failed.");
@@ -1166,6 +1193,10 @@ cSpiceIPC::ctor_init()
     ipc_no_toolbar = false;
     ipc_msg_pgid = 0;
     ipc_stdout_pgid = 0;
+
+    ipc_rbuf_cnt = 0;
+    ipc_rbuf_ptr = 0;
+    ipc_shm_ok = false;
 }
 
 
@@ -1777,7 +1808,8 @@ cSpiceIPC::runnit(const char *what)
     timeval to;
     to.tv_sec = 0;
     to.tv_usec = 0;
-    int i = select(ipc_msg_skt+1, &readfds, 0, 0, &to);
+    int i = read_pending(ipc_msg_skt) ? 1 :
+        select(ipc_msg_skt+1, &readfds, 0, 0, &to);
     if (i > 0) {
         if (!complete_spice()) {
             SCD()->PopUpSim(SpError);
@@ -1839,6 +1871,8 @@ cSpiceIPC::isready(int fd, int timeout_ms, bool silent)
 {
     if (fd < 0)
         return (false);
+    if (read_pending(fd))
+        return (true);
     bool waitmode = false;
     if (timeout_ms <= 0) {
         waitmode = true;  // block forever.
@@ -1903,6 +1937,136 @@ cSpiceIPC::isready(int fd, int timeout_ms, bool silent)
 }
 
 
+// Read a byte from fd into c.  The message socket is read through a
+// buffer, WRspice replies are read in one recv call rather than a
+// call per byte.  This is safe since WRspice never sends anything
+// that wasn't requested.  The return is as for recv.
+//
+int
+cSpiceIPC::read_byte(int fd, char *c)
+{
+    if (fd != ipc_msg_skt)
+        return (recv(fd, c, 1, 0));
+    if (ipc_rbuf_ptr >= ipc_rbuf_cnt) {
+        int i = recv(fd, ipc_rbuf, sizeof(ipc_rbuf), 0);
+        if (i <= 0)
+            return (i);
+        ipc_rbuf_cnt = i;
+        ipc_rbuf_ptr = 0;
+    }
+    *c = ipc_rbuf[ipc_rbuf_ptr++];
+    return (1);
+}
+
+
+// Read nbytes from fd into buf, taking any buffered bytes first. 
+// Return nbytes on success, 0 on EOF, or -1 on error.
+//
+int
+cSpiceIPC::read_bytes(int fd, char *buf, int nbytes)
+{
+    int nr = 0;
+    if (read_pending(fd)) {
+        nr = ipc_rbuf_cnt - ipc_rbuf_ptr;
+        if (nr > nbytes)
+            nr = nbytes;
+        memcpy(buf, ipc_rbuf + ipc_rbuf_ptr, nr);
+        ipc_rbuf_ptr += nr;
+    }
+    while (nr < nbytes) {
+        int i = recv(fd, buf + nr, nbytes - nr, 0);
+        if (i <= 0) {
+            if (i < 0 && errno == EINTR)
+                continue;
+            return (i);
+        }
+        nr += i;
+    }
+    return (nr);
+}
+
+
+// Return true if bytes from fd are buffered but not consumed.  The
+// socket may not select as readable in this case.
+//
+bool
+cSpiceIPC::read_pending(int fd)
+{
+    return (fd >= 0 && fd == ipc_msg_skt && ipc_rbuf_ptr < ipc_rbuf_cnt);
+}
+
+
+// Handle the binary data that follow certain messages.  If msg is
+// "data numbytes", the data are read from fd.  If msg is "shm name
+// numbytes", the data are in the named shared memory segment, which
+// is unlinked after reading.  If databuf is not null, the data block
+// is returned, otherwise it is discarded.  Return false if the
+// connection is broken.
+//
+bool
+cSpiceIPC::read_data(int fd, const char *msg, unsigned char **databuf)
+{
+    if (lstring::match("data", msg)) {
+        // If the message is "data numbytes", binary data will follow.
+        int nbytes = atoi(msg + 5);
+        if (nbytes > 0) {
+            unsigned char *dbuf = new unsigned char[nbytes];
+            int i = read_bytes(fd, (char*)dbuf, nbytes);
+            if (i <= 0) {
+                if (i < 0)
+                    Errs()->sys_error("read_data: recv");
+                Errs()->add_error("read_data: Connection broken.");
+                close_all();
+                delete [] dbuf;
+                return (false);
+            }
+            if (databuf)
+                *databuf = dbuf;
+            else
+                delete [] dbuf;
+        }
+    }
+#ifndef WIN32
+    else if (lstring::match("shm", msg)) {
+        // The message is "shm name numbytes", the data are in the
+        // shared memory segment.
+        const char *s = msg;
+        lstring::advtok(&s);
+        char *name = lstring::gettok(&s);
+        int nbytes = atoi(s);
+        if (!name || nbytes <= 0) {
+            delete [] name;
+            return (true);
+        }
+        int sfd = shm_open(name, O_RDONLY, 0);
+        if (sfd >= 0) {
+            shm_unlink(name);
+            void *addr = mmap(0, nbytes, PROT_READ, MAP_SHARED, sfd, 0);
+            close(sfd);
+            if (addr != MAP_FAILED) {
+                if (databuf) {
+                    *databuf = new unsigned char[nbytes];
+                    memcpy(*databuf, addr, nbytes);
+                }
+                munmap(addr, nbytes);
+                delete [] name;
+                return (true);
+            }
+            Errs()->sys_error("read_data: mmap");
+        }
+        else
+            Errs()->sys_error("read_data: shm_open");
+
+        // Don't use shared memory again with this connection.
+        Errs()->add_error("read_data: can't access shared memory %s.", name);
+        ipc_shm_ok = false;
+        delete [] name;
+    }
+#endif
+    return (true);
+}
+
+
 // Read a message, and return the text in bufp.  Read until a zero
 // byte, handle errors.  If timeout is 0, the operation is expected to
 // take a while, such as a simulation.  In this case, handle
@@ -1931,7 +2095,7 @@ cSpiceIPC::read_msg(int fd, int timeout, char **bufp, bool line_brk,
     char prev_char = 0;
     for (;;) {
         char c;
-        int i = recv(fd, &c, 1, 0);
+        int i = read_byte(fd, &c);
         if (i <= 0) {
             if (i < 0) {
                 if (errno == EINTR)
@@ -1970,35 +2134,7 @@ cSpiceIPC::read_msg(int fd, int timeout, char **bufp, bool line_brk,
         *bufp = t;
     }
 
-    if (lstring::match("data", lstr.string())) {
-        // If the message is "data numbytes", binary data will follow.
-        int nbytes = atoi(lstr.string() + 5);
-        if (nbytes > 0) {
-            unsigned char *dbuf = new unsigned char[nbytes];
-            unsigned char *p = dbuf;
-            while (nbytes) {
-                int i = recv(fd, (char*)p, nbytes, 0);
-                if (i <= 0) {
-                    if (i < 0) {
-                        if (errno == EINTR)
-                            continue;
-                        Errs()->sys_error("read_msg: recv");
-                    }
-                    Errs()->add_error("read_msg: Connection broken.");
-                    close_all();
-                    delete [] dbuf;
-                    return (false);
-                }
-                nbytes -= i;
-                p += i;
-            }
-            if (databuf)
-                *databuf = dbuf;
-            else
-                delete [] dbuf;
-        }
-    }
-    return (true);
+    return (read_data(fd, lstr.string(), databuf));
 }
 
 
@@ -2033,6 +2169,8 @@ cSpiceIPC::read_cmd_return(char **msgbuf,  char **outbuf,
     // check for interrupts and grab any stdout that comes along.
 
     for (;;) {
+        if (read_pending(ipc_msg_skt))
+            break;
         timeval to;
         to.tv_sec = 0;
         to.tv_usec = 100000;
@@ -2096,7 +2234,7 @@ cSpiceIPC::read_cmd_return(char **msgbuf,  char **outbuf,
     char prev_char = 0;
     for (;;) {
         char c;
-        int i = recv(ipc_msg_skt, &c, 1, 0);
+        int i = read_byte(ipc_msg_skt, &c);
         if (i <= 0) {
             if (i < 0) {
                 if (errno == EINTR)
@@ -2131,34 +2269,8 @@ cSpiceIPC::read_cmd_return(char **msgbuf,  char **outbuf,
         *msgbuf = t;
     }
 
-    if (lstring::match("data", lstr.string())) {
-        // If the message is "data numbytes", binary data will follow.
-        int nbytes = atoi(lstr.string() + 5);
-        if (nbytes > 0) {
-            unsigned char *dbuf = new unsigned char[nbytes];
-            unsigned char *p = dbuf;
-            while (nbytes) {
-                int i = recv(ipc_msg_skt, (char*)p, nbytes, 0);
-                if (i <= 0) {
-                    if (i < 0) {
-                        if (errno == EINTR)
-                            continue;
-                        Errs()->sys_error("read_cmd_return: recv");
-                    }
-                    Errs()->add_error("read_cmd_return: Connection broken.");
-                    close_all();
-                    delete [] dbuf;
-                    return (false);
-                }
-                nbytes -= i;
-                p += i;
-            }
-            if (databuf)
-                *databuf = dbuf;
-            else
-                delete [] dbuf;
-        }
-    }
+    if (!read_data(ipc_msg_skt, lstr.string(), databuf))
+        return (false);
 
     // Do a final read on the stdout, in case there is something left.
     char *tbf = read_stdout(200);
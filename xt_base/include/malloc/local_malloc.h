@@ -76,6 +76,21 @@ extern "C" void malloc_error(const char*, void*);
 
 typedef void(*mem_logfunc)(const char*, void*, long*, int);
 
+// Per-thread allocation statistics from the thread cache layer
+// (tcache.cc).  Threads that have exited are lumped together into a
+// record with a zero thread id.
+//
+struct sMemThreadStats
+{
+    unsigned long mts_thread;   // thread id, 0 for exited threads
+    size_t mts_allocs;          // allocations through the cache
+    size_t mts_frees;           // frees through the cache
+    size_t mts_hits;            // allocations satisfied from cache
+    size_t mts_refills;         // batch refills from central heap
+    size_t mts_flushes;         // batch returns to central heap
+    size_t mts_cached;          // bytes currently held in cache
+};
+
 inline struct sMemory *Memory();
 
 #ifdef __APPLE__
@@ -133,6 +148,28 @@ struct sMemory
 
     int mon_depth()                             { return (mem_mon_depth); }
 
+    // Sampling heap profiler, in monitor.cc.  This records one
+    // allocation per interval bytes allocated, on average, and can
+    // be left running in production sessions.
+    bool mon_prof_start(size_t);
+    bool mon_prof_stop();
+    bool mon_prof_dump(const char*, bool);
+    size_t mon_prof_live();
+
+    bool mon_prof_active()                      { return (mem_prof_on); }
+
+    // This is safe to call from a signal handler.  A profile is
+    // dumped to a file from the next allocation call.
+    void mon_prof_request()                     { mem_prof_req = 1; }
+
+    // Per-thread cache statistics, in monitor.cc.
+    int mon_thread_count();
+    bool mon_thread_dump(const char*);
+
+    // Thread cache layer, in tcache.cc.
+    bool tcache_active()                        { return (mem_use_tcache); }
+    int tcache_stats(sMemThreadStats*, int);
+
 private:
     void mem_init();
     void mem_error(const char*, void*, int);
@@ -162,22 +199,29 @@ public:
 #endif
 
 private:
-    void mem_mon_alloc_hook(void *v)
+    void mem_mon_alloc_hook(void *v, size_t sz)
         {
             if (mem_mon_on && v)
                 mem_mon_alloc_hook_prv(v);
+            else if (mem_prof_on && v)
+                mem_prof_alloc_hook_prv(v, sz);
         }
 
     void mem_mon_free_hook(void *v)
         {
             if (mem_mon_on && v)
                 mem_mon_free_hook_prv(v);
+            else if (mem_prof_on && v)
+                mem_prof_free_hook_prv(v);
         }
 
     // Memory monitor functions, in monitor.cc.
     void mem_mon_enable(bool);
     void mem_mon_alloc_hook_prv(void*);
     void mem_mon_free_hook_prv(void*);
+    void mem_prof_alloc_hook_prv(void*, size_t);
+    void mem_prof_free_hook_prv(void*);
+    void mem_prof_auto_dump();
 
     m_state mem_state;
     unsigned int mem_busy;
@@ -209,8 +253,13 @@ private:
     bool mem_mon_on;
     bool mem_mon_check_free;
     bool mem_use_local_malloc;
+    bool mem_use_tcache;
     struct mtable_t *mem_mon_tab;
 
+    bool mem_prof_on;
+    volatile int mem_prof_req;
+    struct mprof_t *mem_prof;
+
     long mem_stk[MEM_ERR_DEPTH];
 
     static mem_logfunc mem_logfunc_ptr;
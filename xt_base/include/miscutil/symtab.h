@@ -45,6 +45,7 @@
 #include "hashfunc.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include <pthread.h>
 
 
 //
@@ -1711,6 +1712,463 @@ private:
 };
 
 
+//-----------------------------------------------------------------------------
+// mttable_t<>:  Concurrent string-keyed table
+
+// Number of independently locked shards, power of 2.
+#define MT_SHARDS       32
+
+// Initial shard array size, power of 2.
+#define MT_INITSIZE     16
+
+// Template for a string-keyed table that can be shared by multiple
+// threads.  The elements must provide the following public method:
+//
+//    const char *tab_name();
+                            // Publicly accessible tag name, must not
+//                          // change while the element is linked.
+//
+// The elements are not owned by the table, and no next pointer is
+// used, so an element may appear in tables of both types.
+//
+// The table is split into shards, each an open-addressed array of
+// element pointers probed linearly.  Lookups take no lock:  the array
+// and slot pointers are read with acquire semantics, and a slot is
+// written with release semantics once the element is complete.
+// Writers lock the shard.  When an array becomes half full, a larger
+// one is built and published, and the old array is retired but not
+// freed, since readers may still be probing it.  Retired arrays are
+// freed by clear and the destructor, which must not be called while
+// other threads are using the table.  Elements returned from remove
+// or unlink should not be freed while other threads may be reading.
+//
+template <class T>
+struct mttable_t
+{
+    // Shard array, extended as necessary.
+    struct mtarr_t
+    {
+        mtarr_t *next;          // Retired arrays.
+        unsigned int mask;      // Array size - 1, size is power 2.
+        T *slots[1];            // Element pointers.
+    };
+
+    struct mtshard_t
+    {
+        pthread_mutex_t mtx;    // Writer lock.
+        mtarr_t *arr;           // Current array.
+        unsigned int count;     // Number of elements.
+        unsigned int used;      // Elements plus deleted slots.
+    };
+
+    mttable_t();
+    ~mttable_t();
+
+    void clear();
+    T *find(const char*);
+    T *add(const char*, T*(*)(const char*, unsigned int, void*), void*);
+    T *link(T*, bool = true);
+    T *remove(const char*);
+    T *unlink(T*);
+    unsigned int allocated();
+    unsigned int memuse();
+
+    // Return the current array of shard s, for iteration.
+    mtarr_t *array(unsigned int s)
+        {
+            if (s >= MT_SHARDS)
+                return (0);
+            return (__atomic_load_n(&mt_shards[s].arr, __ATOMIC_ACQUIRE));
+        }
+
+    static bool is_elt(const T *e)  { return (e && e != deleted()); }
+
+private:
+    static T *deleted()         { return ((T*)(uintptr_t)1); }
+
+    static unsigned int hash(const char *tag)
+        {
+            return (incr_hash_string(INCR_HASH_INIT, tag));
+        }
+
+    static unsigned int shard(unsigned int h)
+        {
+            return (number_hash(h, MT_SHARDS-1));
+        }
+
+    static T *probe(mtarr_t*, const char*, unsigned int, int* = 0);
+    void insert(mtshard_t*, T*, unsigned int);
+    void check_rehash(mtshard_t*);
+
+    mtshard_t mt_shards[MT_SHARDS];
+};
+
+
+template <class T>
+mttable_t<T>::mttable_t()
+{
+    for (unsigned int i = 0; i < MT_SHARDS; i++) {
+        pthread_mutex_init(&mt_shards[i].mtx, 0);
+        mt_shards[i].arr = 0;
+        mt_shards[i].count = 0;
+        mt_shards[i].used = 0;
+    }
+}
+
+
+template <class T>
+mttable_t<T>::~mttable_t()
+{
+    clear();
+    for (unsigned int i = 0; i < MT_SHARDS; i++)
+        pthread_mutex_destroy(&mt_shards[i].mtx);
+}
+
+
+// Empty the table and free the arrays.  The elements are not freed.
+// Not thread-safe.
+//
+template <class T> void
+mttable_t<T>::clear()
+{
+    for (unsigned int i = 0; i < MT_SHARDS; i++) {
+        mtshard_t *sh = mt_shards + i;
+        while (sh->arr) {
+            mtarr_t *a = sh->arr;
+            sh->arr = a->next;
+            free(a);
+        }
+        sh->count = 0;
+        sh->used = 0;
+    }
+}
+
+
+// Return the named element, or 0 if not found.  This does not lock.
+//
+template <class T> T *
+mttable_t<T>::find(const char *tag)
+{
+    if (!tag)
+        return (0);
+    unsigned int h = hash(tag);
+    return (probe(__atomic_load_n(&mt_shards[shard(h)].arr, __ATOMIC_ACQUIRE),
+        tag, h));
+}
+
+
+// Return the named element if found.  Otherwise, call the function
+// to create it and link the return.  The function is called with the
+// shard lock held, and is passed the name, the shard index, and arg.
+// The shard index can be used to select per-shard storage, which
+// needs no further locking.  The created element must have the given
+// name.
+//
+template <class T> T *
+mttable_t<T>::add(const char *tag, T*(*func)(const char*, unsigned int, void*),
+    void *arg)
+{
+    if (!tag || !func)
+        return (0);
+    T *e = find(tag);
+    if (e)
+        return (e);
+
+    unsigned int h = hash(tag);
+    unsigned int s = shard(h);
+    mtshard_t *sh = mt_shards + s;
+    pthread_mutex_lock(&sh->mtx);
+    e = probe(sh->arr, tag, h);
+    if (!e) {
+        e = (*func)(tag, s, arg);
+        if (e)
+            insert(sh, e, h);
+    }
+    pthread_mutex_unlock(&sh->mtx);
+    return (e);
+}
+
+
+// If check and an element of the same name is already in the table,
+// return it.  Otherwise, link in the element passed and return it.
+// Return 0 only if the passed element is 0.
+//
+template <class T> T *
+mttable_t<T>::link(T *el, bool check)
+{
+    if (!el)
+        return (0);
+    unsigned int h = hash(el->tab_name());
+    mtshard_t *sh = mt_shards + shard(h);
+    pthread_mutex_lock(&sh->mtx);
+    T *e = check ? probe(sh->arr, el->tab_name(), h) : 0;
+    if (e)
+        el = e;
+    else
+        insert(sh, el, h);
+    pthread_mutex_unlock(&sh->mtx);
+    return (el);
+}
+
+
+// If an element matches the name passed, unlink and return it,
+// otherwise return 0.
+//
+template <class T> T *
+mttable_t<T>::remove(const char *tag)
+{
+    if (!tag)
+        return (0);
+    unsigned int h = hash(tag);
+    mtshard_t *sh = mt_shards + shard(h);
+    pthread_mutex_lock(&sh->mtx);
+    int i;
+    T *e = probe(sh->arr, tag, h, &i);
+    if (e) {
+        __atomic_store_n(&sh->arr->slots[i], deleted(), __ATOMIC_RELEASE);
+        sh->count--;
+    }
+    pthread_mutex_unlock(&sh->mtx);
+    return (e);
+}
+
+
+// If the element is in the table, unlink it and return it.  If not
+// found return 0.
+//
+template <class T> T *
+mttable_t<T>::unlink(T *el)
+{
+    if (!el)
+        return (0);
+    unsigned int h = hash(el->tab_name());
+    mtshard_t *sh = mt_shards + shard(h);
+    T *e = 0;
+    pthread_mutex_lock(&sh->mtx);
+    mtarr_t *a = sh->arr;
+    if (a) {
+        for (unsigned int i = h & a->mask; a->slots[i];
+                i = (i + 1) & a->mask) {
+            if (a->slots[i] == el) {
+                __atomic_store_n(&a->slots[i], deleted(), __ATOMIC_RELEASE);
+                sh->count--;
+                e = el;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&sh->mtx);
+    return (e);
+}
+
+
+// Return the number of elements.  This is a snapshot if other
+// threads are writing.
+//
+template <class T> unsigned int
+mttable_t<T>::allocated()
+{
+    unsigned int cnt = 0;
+    for (unsigned int i = 0; i < MT_SHARDS; i++)
+        cnt += __atomic_load_n(&mt_shards[i].count, __ATOMIC_RELAXED);
+    return (cnt);
+}
+
+
+// Return heap allocation total, including retired arrays.
+//
+template <class T> unsigned int
+mttable_t<T>::memuse()
+{
+    unsigned int bytes = 0;
+    for (unsigned int i = 0; i < MT_SHARDS; i++) {
+        for (mtarr_t *a = array(i); a; a = a->next)
+            bytes += sizeof(mtarr_t) + a->mask*sizeof(T*);
+    }
+    return (bytes);
+}
+
+
+// Return the named element in a, or 0 if not found, and set the slot
+// index if pi is given.  The arrays are never full, so the probe
+// terminates.
+//
+template <class T> T *
+mttable_t<T>::probe(mtarr_t *a, const char *tag, unsigned int h, int *pi)
+{
+    if (!a)
+        return (0);
+    for (unsigned int i = h & a->mask; ; i = (i + 1) & a->mask) {
+        T *e = __atomic_load_n(&a->slots[i], __ATOMIC_ACQUIRE);
+        if (!e)
+            return (0);
+        if (e != deleted() && str_compare(tag, e->tab_name())) {
+            if (pi)
+                *pi = i;
+            return (e);
+        }
+    }
+}
+
+
+// Put the element in the first free slot.  Call with the shard
+// locked.
+//
+template <class T> void
+mttable_t<T>::insert(mtshard_t *sh, T *el, unsigned int h)
+{
+    check_rehash(sh);
+    mtarr_t *a = sh->arr;
+    unsigned int i = h & a->mask;
+    while (is_elt(a->slots[i]))
+        i = (i + 1) & a->mask;
+    if (!a->slots[i])
+        sh->used++;
+    __atomic_store_n(&a->slots[i], el, __ATOMIC_RELEASE);
+    sh->count++;
+}
+
+
+// Make sure that there is room for a new element, keeping the array
+// at most half full, counting deleted slots.  The replacement array
+// is sized for at most one quarter full, and deleted slots are
+// dropped.  Call with the shard locked.
+//
+template <class T> void
+mttable_t<T>::check_rehash(mtshard_t *sh)
+{
+    mtarr_t *a = sh->arr;
+    if (a && 2*(sh->used + 1) <= a->mask + 1)
+        return;
+
+    unsigned int size = MT_INITSIZE;
+    while (size < 4*(sh->count + 1))
+        size <<= 1;
+    mtarr_t *na = (mtarr_t*)malloc(sizeof(mtarr_t) + (size-1)*sizeof(T*));
+    na->next = a;
+    na->mask = size - 1;
+    for (unsigned int i = 0; i < size; i++)
+        na->slots[i] = 0;
+    if (a) {
+        for (unsigned int i = 0; i <= a->mask; i++) {
+            T *e = a->slots[i];
+            if (!is_elt(e))
+                continue;
+            unsigned int j = hash(e->tab_name()) & na->mask;
+            while (na->slots[j])
+                j = (j + 1) & na->mask;
+            na->slots[j] = e;
+        }
+    }
+    sh->used = sh->count;
+    __atomic_store_n(&sh->arr, na, __ATOMIC_RELEASE);
+}
+// End of mttable_t template functions.
+
+
+// Iteration through mttable_t.  This should not be used while other
+// threads are removing elements.
+//
+template <class T>
+struct mtgen_t
+{
+    mtgen_t(mttable_t<T> *t)
+        {
+            table = t;
+            array = t ? t->array(0) : 0;
+            shard = 0;
+            indx = 0;
+        }
+
+    T *next()
+        {
+            while (table) {
+                if (!array || indx > array->mask) {
+                    if (++shard >= MT_SHARDS)
+                        return (0);
+                    array = table->array(shard);
+                    indx = 0;
+                    continue;
+                }
+                T *e = __atomic_load_n(&array->slots[indx++],
+                    __ATOMIC_ACQUIRE);
+                if (mttable_t<T>::is_elt(e))
+                    return (e);
+            }
+            return (0);
+        }
+
+private:
+    mttable_t<T> *table;
+    typename mttable_t<T>::mtarr_t *array;
+    unsigned int shard;
+    unsigned int indx;
+};
+
+
+//-----------------------------------------------------------------------------
+// mtstrtab_t:  Concurrent string table
+
+// Element type for mtstrtab_t, which is the string itself.
+struct mtsl_t
+{
+    const char *tab_name()      { return ((const char*)this); }
+};
+
+// Thread-safe version of strtab_t, for interning names from multiple
+// threads.  Lookups do not lock, and new strings are allocated from a
+// per-shard pool under the shard lock.  There is no remove, since
+// other threads may be holding the returned pointers.
+//
+struct mtstrtab_t
+{
+    // Clear all entries.  Not thread-safe.
+    //
+    void clear()
+        {
+            st_tab.clear();
+            for (unsigned int i = 0; i < MT_SHARDS; i++)
+                st_bufs[i].clear();
+        }
+
+    // Return the matching entry for string, if it exists, null
+    // otherwise.
+    //
+    const char *find(const char *string)
+        {
+            return ((const char*)st_tab.find(string));
+        }
+
+    // Add string to string table if not already there, and return a
+    // pointer to the table entry.
+    //
+    const char *add(const char *string)
+        {
+            return ((const char*)st_tab.add(string, new_string, st_bufs));
+        }
+
+    inline stringlist *strings();
+
+    // Return heap allocation total.
+    unsigned int memuse()
+        {
+            unsigned int bytes = st_tab.memuse();
+            for (unsigned int i = 0; i < MT_SHARDS; i++)
+                bytes += st_bufs[i].memuse();
+            return (bytes);
+        }
+
+private:
+    static mtsl_t *new_string(const char *string, unsigned int s, void *arg)
+        {
+            return ((mtsl_t*)((stbuf_t*)arg)[s].new_string(string));
+        }
+
+    mttable_t<mtsl_t> st_tab;           // sharded hash table
+    stbuf_t     st_bufs[MT_SHARDS];     // string pools, per shard
+};
+
+
 //-----------------------------------------------------------------------------
 // Deferred inlines
 
@@ -1767,5 +2225,19 @@ cstrtab_t::strings()
     return (s0);
 }
 
-#endif
 
+// Return a list of the strings.
+//
+inline stringlist *
+mtstrtab_t::strings()
+{
+    stringlist *s0 = 0;
+    mtgen_t<mtsl_t> gen(&st_tab);
+    mtsl_t *sl;
+    while ((sl = gen.next()) != 0)
+        s0 = new stringlist(lstring::copy(sl->tab_name()), s0);
+    stringlist::sort(s0);
+    return (s0);
+}
+
+#endif
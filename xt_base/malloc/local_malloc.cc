@@ -97,6 +97,17 @@ extern "C" {
     extern void dlfree(void*);
     extern struct mallinfo dlmallinfo();
 }
+
+#if defined(__FreeBSD__) || defined(__linux)
+// tcache.cc
+namespace tcache {
+    extern bool tc_init();
+    extern void *tc_malloc(size_t);
+    extern void *tc_calloc(size_t, size_t);
+    extern void *tc_realloc(void*, size_t);
+    extern void tc_free(void*);
+}
+#endif
 #endif
 
 
@@ -170,7 +181,10 @@ sMemory::mem_init()
 #else
 
 #if defined(__FreeBSD__) || defined(__linux)
-    mem_use_local_malloc = (getenv("XT_LOCAL_MALLOC") != 0);
+    // The thread cache is a front end to the local allocator.
+    mem_use_tcache = (getenv("XT_THREAD_CACHE") != 0);
+    mem_use_local_malloc = mem_use_tcache ||
+        (getenv("XT_LOCAL_MALLOC") != 0);
 #endif
     if (mem_use_local_malloc) {
         // Use our private malloc and friends.  This may facilitate
@@ -192,6 +206,22 @@ sMemory::mem_init()
         mem_memalign_ptr = dlmemalign;
         mem_posix_memalign_ptr = dlposix_memalign;
         mem_free_ptr = dlfree;
+
+#if defined(__FreeBSD__) || defined(__linux)
+        if (mem_use_tcache) {
+            // Small blocks are served from per-thread free lists,
+            // which are refilled from and returned to the central
+            // heap in batches.
+            if (tcache::tc_init()) {
+                mem_malloc_ptr = tcache::tc_malloc;
+                mem_calloc_ptr = tcache::tc_calloc;
+                mem_realloc_ptr = tcache::tc_realloc;
+                mem_free_ptr = tcache::tc_free;
+            }
+            else
+                mem_use_tcache = false;
+        }
+#endif
     }
     else {
         // Recent glibc dlsym calls calloc, but it seems ok if calloc
@@ -238,6 +268,16 @@ sMemory::mem_init()
             mon_start(d);
             mem_mon_check_free = true;
         }
+
+        // If set, start the sampling profiler, with an optional
+        // interval in bytes.
+        s = getenv("MMON_SAMPLE");
+        if (s && !mem_mon_on) {
+            size_t n = 0;
+            if (isdigit(*s))
+                n = strtoul(s, 0, 10);
+            mon_prof_start(n);
+        }
     }
 #endif
 }
@@ -375,7 +415,7 @@ sMemory::mem_malloc(size_t size)
         return (0);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(v);
+    mem_mon_alloc_hook(v, size);
 #endif
     return (v);
 }
@@ -411,7 +451,7 @@ sMemory::mem_valloc(size_t size)
         return (0);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(v);
+    mem_mon_alloc_hook(v, size);
 #endif
     return (v);
 }
@@ -447,7 +487,7 @@ sMemory::mem_calloc(size_t n, size_t size)
         return (0);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(v);
+    mem_mon_alloc_hook(v, n*size);
 #endif
     return (v);
 }
@@ -484,7 +524,7 @@ sMemory::mem_realloc(void *p, size_t size)
 #ifdef ENABLE_MONITOR
     if (p != v) {
         mem_mon_free_hook(p);
-        mem_mon_alloc_hook(v);
+        mem_mon_alloc_hook(v, size);
     }
 #endif
     return (v);
@@ -515,7 +555,7 @@ sMemory::mem_memalign(malloc_zone_t *mz, size_t align, size_t size)
         return (0);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(v);
+    mem_mon_alloc_hook(v, size);
 #endif
     return (v);
 }
@@ -551,7 +591,7 @@ sMemory::mem_memalign(size_t align, size_t size)
         return (0);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(v);
+    mem_mon_alloc_hook(v, size);
 #endif
     return (v);
 }
@@ -583,7 +623,7 @@ sMemory::mem_posix_memalign(void **p, size_t align, size_t size)
         return (ret);
     }
 #ifdef ENABLE_MONITOR
-    mem_mon_alloc_hook(*p);
+    mem_mon_alloc_hook(*p, size);
 #endif
     return (0);
 }
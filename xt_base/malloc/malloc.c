@@ -80,6 +80,9 @@ extern struct mallinfo dlmallinfo();
 #define USE_DL_PREFIX
 
 #define PROCEED_ON_ERROR 1
+/* The application is multi-threaded, and the thread cache layer
+   (tcache.cc) shares the central heap among threads. */
+#define USE_LOCKS 1
 #define SRW_HACKS
 
 #if defined(__FreeBSD__) || defined(__linux)
@@ -42,6 +42,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
 #if defined(__arm64) || defined(__x86_64)
 #include <execinfo.h>
 #endif
@@ -62,6 +65,9 @@
 //                            with optional saved stack depth.  When this
 //                            is used, freed objects are tested against
 //                            the allocation table.
+// MMON_SAMPLE [=N]           Start the sampling profiler on application
+//                            startup, with optional sampling interval
+//                            in bytes.
 
 //-----------------------------------------------------------------------
 // Symbol table definition
@@ -214,11 +220,14 @@ mtable_t::check_rehash()
 
 // Start the memory monitor.  The depth is the number of stack
 // backtrace entries to save with each allocation record.  This
-// frees the allocation tables from any previous run.
+// frees the allocation tables from any previous run.  This will fail
+// if the sampling profiler is running.
 //
 bool
 sMemory::mon_start(int depth)
 {
+    if (mem_prof_on)
+        return (false);
     if (!mem_mon_on) {
         if (depth < 1)
             depth = 1;
@@ -337,6 +346,61 @@ sMemory::mon_dump(const char *fname)
 }
 
 
+// Return the number of per-thread statistics records available from
+// the thread cache layer, or -1 if the thread cache is not in use.
+//
+int
+sMemory::mon_thread_count()
+{
+    if (!mem_use_tcache)
+        return (-1);
+    sMemThreadStats st[64];
+    return (tcache_stats(st, 64));
+}
+
+
+// Dump the per-thread allocation statistics to file fname.  If the
+// thread cache is not in use, a message to that effect is written.
+//
+bool
+sMemory::mon_thread_dump(const char *fname)
+{
+    FILE *fp = fopen(fname, "w");
+    if (!fp)
+        return (false);
+    if (!mem_use_tcache) {
+        fprintf(fp, "Thread cache not in use.\n");
+        fclose(fp);
+        return (true);
+    }
+
+    sMemThreadStats st[64];
+    int cnt = tcache_stats(st, 64);
+    size_t tallocs = 0, thits = 0, tcached = 0;
+    fprintf(fp, "%-18s %12s %12s %12s %10s %10s %12s\n", "thread",
+        "allocs", "frees", "hits", "refills", "flushes", "cached");
+    for (int i = 0; i < cnt; i++) {
+        sMemThreadStats *s = st + i;
+        if (s->mts_thread)
+            fprintf(fp, "0x%-16lx", s->mts_thread);
+        else
+            fprintf(fp, "%-18s", "(exited)");
+        fprintf(fp, " %12lu %12lu %12lu %10lu %10lu %12lu\n",
+            (unsigned long)s->mts_allocs, (unsigned long)s->mts_frees,
+            (unsigned long)s->mts_hits, (unsigned long)s->mts_refills,
+            (unsigned long)s->mts_flushes, (unsigned long)s->mts_cached);
+        tallocs += s->mts_allocs;
+        thits += s->mts_hits;
+        tcached += s->mts_cached;
+    }
+    fprintf(fp, "Total allocations %lu, hit rate %.1f%%, cached %lu bytes.\n",
+        (unsigned long)tallocs, tallocs ? (100.0*thits)/tallocs : 0.0,
+        (unsigned long)tcached);
+    fclose(fp);
+    return (true);
+}
+
+
 void
 sMemory::mem_mon_enable(bool enable)
 {
@@ -453,6 +517,546 @@ sMemory::mem_mon_free_hook_prv(void *v)
 }
 
 
+//-----------------------------------------------------------------------
+//
+// Sampling Heap Profiler
+//
+//-----------------------------------------------------------------------
+
+// The allocation table above records every block, which is far too
+// slow for large sessions.  The profiler below records a random
+// sample of allocations, on average one per mp_interval bytes
+// allocated, along with a stack backtrace.  Samples are aggregated
+// by call site, giving live and cumulative bytes per site, from which
+// leaks in long-running sessions can be found.  The sampling is
+// unbiased: a block of size s is sampled with probability
+// 1 - exp(-s/mp_interval), and is weighted by the inverse of this
+// when estimating totals.
+//
+// Profiles are written in plain text, or in the legacy heap profile
+// format read by pprof ("heap_v2").
+
+#define MP_DEPTH        16          // saved stack depth
+#define MP_DEF_INTERVAL (512*1024)  // default sampling interval, bytes
+#define MP_SAMP_HASH    (1 << 14)   // sample table width
+#define MP_SITE_HASH    (1 << 12)   // call site table width
+#define MP_FILT_BITS    20          // free filter size, log2
+
+// Call site, aggregated samples with a given backtrace.
+//
+struct msite_t
+{
+    msite_t *next;          // link
+    unsigned long hash;     // backtrace hash
+    size_t live_cnt;        // live samples
+    size_t live_bytes;      // live sampled bytes
+    size_t alloc_cnt;       // total samples
+    size_t alloc_bytes;     // total sampled bytes
+    double est_live;        // estimated live bytes, unsampled
+    int depth;              // backtrace depth
+    void *stack[MP_DEPTH];  // backtrace
+};
+
+// Sampled allocation.
+//
+struct msamp_t
+{
+    void *key;              // memory block address
+    msamp_t *next;          // link
+    msite_t *site;          // call site
+    size_t size;            // requested size
+    double weight;          // unsampled bytes represented
+};
+
+// The profiler state.
+//
+struct mprof_t
+{
+    mprof_t(size_t);
+    ~mprof_t();
+
+    static unsigned int filt_index(void *v)
+        {
+            unsigned long k = ((unsigned long)v) >> 4;
+            return ((k * 0x9e3779b97f4a7c15UL) >> (64 - MP_FILT_BITS));
+        }
+
+    void clear();
+    void reset(size_t);
+    msite_t *find_site(void**, int);
+    void add(void*, size_t, void**, int);
+    bool remove(void*);
+    void print_text(FILE*);
+    void print_pprof(FILE*);
+
+    size_t mp_interval;                 // sampling interval, bytes
+    unsigned int mp_run;                // incremented on each reset
+    size_t mp_samples;                  // live sample count
+    double mp_est_live;                 // estimated live bytes
+    pthread_mutex_t mp_lock;
+    msamp_t *mp_samp_tab[MP_SAMP_HASH];
+    msite_t *mp_site_tab[MP_SITE_HASH];
+    // Count of live samples for each address hash.  A free call
+    // looks in the sample table only if the count is nonzero.
+    unsigned char mp_filter[1 << MP_FILT_BITS];
+};
+
+
+mprof_t::mprof_t(size_t intvl)
+{
+    mp_interval = intvl;
+    mp_run = 1;
+    mp_samples = 0;
+    mp_est_live = 0.0;
+    pthread_mutex_init(&mp_lock, 0);
+    memset(mp_samp_tab, 0, sizeof(mp_samp_tab));
+    memset(mp_site_tab, 0, sizeof(mp_site_tab));
+    memset(mp_filter, 0, sizeof(mp_filter));
+}
+
+
+mprof_t::~mprof_t()
+{
+    clear();
+    pthread_mutex_destroy(&mp_lock);
+}
+
+
+// Free the samples and call sites.
+//
+void
+mprof_t::clear()
+{
+    for (int i = 0; i < MP_SAMP_HASH; i++) {
+        msamp_t *sn;
+        for (msamp_t *sp = mp_samp_tab[i]; sp; sp = sn) {
+            sn = sp->next;
+            delete sp;
+        }
+    }
+    for (int i = 0; i < MP_SITE_HASH; i++) {
+        msite_t *sn;
+        for (msite_t *st = mp_site_tab[i]; st; st = sn) {
+            sn = st->next;
+            delete st;
+        }
+    }
+    memset(mp_samp_tab, 0, sizeof(mp_samp_tab));
+    memset(mp_site_tab, 0, sizeof(mp_site_tab));
+    memset(mp_filter, 0, sizeof(mp_filter));
+    mp_samples = 0;
+    mp_est_live = 0.0;
+}
+
+
+// Clear the data for a new run with the given interval.  The profile
+// is reset in place rather than replaced, as other threads may be in
+// add or remove, or about to be.
+//
+void
+mprof_t::reset(size_t intvl)
+{
+    pthread_mutex_lock(&mp_lock);
+    clear();
+    mp_interval = intvl;
+    mp_run++;
+    pthread_mutex_unlock(&mp_lock);
+}
+
+
+// Return the call site record for the backtrace, creating it if
+// necessary.  Call with lock held.
+//
+msite_t *
+mprof_t::find_site(void **stk, int depth)
+{
+    unsigned long h = depth;
+    for (int i = 0; i < depth; i++)
+        h = (h << 5) + (h >> 27) + (unsigned long)stk[i];
+    int j = h & (MP_SITE_HASH - 1);
+    for (msite_t *st = mp_site_tab[j]; st; st = st->next) {
+        if (st->hash == h && st->depth == depth &&
+                !memcmp(st->stack, stk, depth*sizeof(void*)))
+            return (st);
+    }
+    msite_t *st = new msite_t;
+    memset(st, 0, sizeof(msite_t));
+    st->hash = h;
+    st->depth = depth;
+    memcpy(st->stack, stk, depth*sizeof(void*));
+    st->next = mp_site_tab[j];
+    mp_site_tab[j] = st;
+    return (st);
+}
+
+
+// Record a sampled allocation.
+//
+void
+mprof_t::add(void *v, size_t sz, void **stk, int depth)
+{
+    double w = 1.0 - exp(-(double)sz/mp_interval);
+    w = (w > 0.0) ? sz/w : (double)mp_interval;
+
+    msamp_t *sp = new msamp_t;
+    sp->key = v;
+    sp->size = sz;
+    sp->weight = w;
+
+    pthread_mutex_lock(&mp_lock);
+    msite_t *st = find_site(stk, depth);
+    sp->site = st;
+    st->live_cnt++;
+    st->live_bytes += sz;
+    st->alloc_cnt++;
+    st->alloc_bytes += sz;
+    st->est_live += w;
+    mp_est_live += w;
+    mp_samples++;
+
+    int j = (((unsigned long)v) >> 4) & (MP_SAMP_HASH - 1);
+    sp->next = mp_samp_tab[j];
+    mp_samp_tab[j] = sp;
+    unsigned int f = filt_index(v);
+    if (mp_filter[f] < 255)
+        mp_filter[f]++;
+    pthread_mutex_unlock(&mp_lock);
+}
+
+
+// If v is a sampled allocation, remove it and return true.
+//
+bool
+mprof_t::remove(void *v)
+{
+    unsigned int f = filt_index(v);
+    if (!mp_filter[f])
+        return (false);
+
+    pthread_mutex_lock(&mp_lock);
+    int j = (((unsigned long)v) >> 4) & (MP_SAMP_HASH - 1);
+    msamp_t *sprv = 0;
+    msamp_t *sp = mp_samp_tab[j];
+    for ( ; sp; sp = sp->next) {
+        if (sp->key == v)
+            break;
+        sprv = sp;
+    }
+    if (!sp) {
+        pthread_mutex_unlock(&mp_lock);
+        return (false);
+    }
+    if (sprv)
+        sprv->next = sp->next;
+    else
+        mp_samp_tab[j] = sp->next;
+    // A saturated count is never decremented, the filter will pass
+    // frees for that hash from then on.
+    if (mp_filter[f] < 255)
+        mp_filter[f]--;
+
+    msite_t *st = sp->site;
+    st->live_cnt--;
+    st->live_bytes -= sp->size;
+    st->est_live -= sp->weight;
+    mp_est_live -= sp->weight;
+    mp_samples--;
+    pthread_mutex_unlock(&mp_lock);
+    delete sp;
+    return (true);
+}
+
+
+namespace {
+    // Sorting function for call sites, descending estimated live
+    // bytes.
+    //
+    int
+    scomp(const void *a, const void *b)
+    {
+        const msite_t *s1 = *(const msite_t**)a;
+        const msite_t *s2 = *(const msite_t**)b;
+        if (s1->est_live < s2->est_live)
+            return (1);
+        if (s1->est_live > s2->est_live)
+            return (-1);
+        return (0);
+    }
+}
+
+
+// Print a plain text profile, call sites with live data in order of
+// decreasing estimated live bytes.  Call with lock held.
+//
+void
+mprof_t::print_text(FILE *fp)
+{
+    int nsites = 0;
+    for (int i = 0; i < MP_SITE_HASH; i++) {
+        for (msite_t *st = mp_site_tab[i]; st; st = st->next) {
+            if (st->live_cnt)
+                nsites++;
+        }
+    }
+    fprintf(fp, "Sampled heap profile, interval %lu bytes.\n",
+        (unsigned long)mp_interval);
+    fprintf(fp, "Live samples %lu, estimated live bytes %.0f, "
+        "call sites %d.\n\n", (unsigned long)mp_samples, mp_est_live,
+        nsites);
+    if (!nsites)
+        return;
+
+    msite_t **ary = new msite_t*[nsites];
+    int cnt = 0;
+    for (int i = 0; i < MP_SITE_HASH; i++) {
+        for (msite_t *st = mp_site_tab[i]; st; st = st->next) {
+            if (st->live_cnt)
+                ary[cnt++] = st;
+        }
+    }
+    if (cnt > 1)
+        qsort(ary, cnt, sizeof(msite_t*), scomp);
+
+    for (int i = 0; i < cnt; i++) {
+        msite_t *st = ary[i];
+        fprintf(fp, "%.0f bytes (%.1f%%) live, %lu of %lu samples live\n",
+            st->est_live, mp_est_live > 0.0 ?
+            100.0*st->est_live/mp_est_live : 0.0,
+            (unsigned long)st->live_cnt, (unsigned long)st->alloc_cnt);
+#if defined(__arm64) || defined(__x86_64)
+        char **strings = backtrace_symbols(st->stack, st->depth);
+        for (int k = 0; k < st->depth; k++)
+            fprintf(fp, "    %s\n", strings ? strings[k] : "?");
+        free(strings);
+#else
+        for (int k = 0; k < st->depth; k++)
+            fprintf(fp, "    0x%lx\n", (unsigned long)st->stack[k]);
+#endif
+        fputc('\n', fp);
+    }
+    delete [] ary;
+}
+
+
+// Print a profile in the legacy pprof heap format.  The counts are
+// raw sample counts, pprof does the unsampling given the interval in
+// the header.  Call with lock held.
+//
+void
+mprof_t::print_pprof(FILE *fp)
+{
+    size_t lcnt = 0, lbytes = 0, acnt = 0, abytes = 0;
+    for (int i = 0; i < MP_SITE_HASH; i++) {
+        for (msite_t *st = mp_site_tab[i]; st; st = st->next) {
+            lcnt += st->live_cnt;
+            lbytes += st->live_bytes;
+            acnt += st->alloc_cnt;
+            abytes += st->alloc_bytes;
+        }
+    }
+    fprintf(fp, "heap profile: %lu: %lu [%lu: %lu] @ heap_v2/%lu\n",
+        (unsigned long)lcnt, (unsigned long)lbytes, (unsigned long)acnt,
+        (unsigned long)abytes, (unsigned long)mp_interval);
+    for (int i = 0; i < MP_SITE_HASH; i++) {
+        for (msite_t *st = mp_site_tab[i]; st; st = st->next) {
+            fprintf(fp, "%lu: %lu [%lu: %lu] @",
+                (unsigned long)st->live_cnt, (unsigned long)st->live_bytes,
+                (unsigned long)st->alloc_cnt, (unsigned long)st->alloc_bytes);
+            for (int k = 0; k < st->depth; k++)
+                fprintf(fp, " 0x%lx", (unsigned long)st->stack[k]);
+            fputc('\n', fp);
+        }
+    }
+
+    // pprof needs the load map to symbolize.
+    fprintf(fp, "\nMAPPED_LIBRARIES:\n");
+    FILE *mp = fopen("/proc/self/maps", "r");
+    if (mp) {
+        char buf[512];
+        while (fgets(buf, sizeof(buf), mp))
+            fputs(buf, fp);
+        fclose(mp);
+    }
+}
+// End of profiler definitions
+
+
+namespace {
+    // Per-thread profiler state.  The countdown is the number of
+    // bytes to allocate before the next sample, it is valid for the
+    // profiler run mp_thr_run.  The busy flag prevents recursion, as
+    // the profiler itself allocates.
+
+    __thread long mp_countdown;
+    __thread unsigned int mp_thr_run;
+    __thread unsigned long mp_rand;
+    __thread bool mp_busy;
+
+    // Return the number of bytes to the next sample, exponentially
+    // distributed with mean intvl.
+    //
+    long
+    mp_next_sample(size_t intvl)
+    {
+        if (!mp_rand)
+            mp_rand = ((unsigned long)pthread_self()) ^ 0x2545f4914f6cdd1dUL;
+        // xorshift64
+        mp_rand ^= mp_rand << 13;
+        mp_rand ^= mp_rand >> 7;
+        mp_rand ^= mp_rand << 17;
+        double u = ((mp_rand >> 11) + 0.5)/(double)(1UL << 53);
+        return ((long)(-log(u)*intvl) + 1);
+    }
+
+    int mp_dump_seq;
+}
+
+
+// Start the sampling profiler, intvl is the mean number of bytes
+// allocated per sample, 0 gives the default.  This clears data from
+// any previous run.  The allocation table monitor and the profiler
+// are exclusive.
+//
+bool
+sMemory::mon_prof_start(size_t intvl)
+{
+    if (mem_mon_on)
+        return (false);
+    if (!mem_prof_on) {
+        if (!intvl)
+            intvl = MP_DEF_INTERVAL;
+        mp_busy = true;
+        if (mem_prof)
+            mem_prof->reset(intvl);
+        else
+            mem_prof = new mprof_t(intvl);
+        mp_busy = false;
+        mem_prof_req = 0;
+        mem_prof_on = true;
+    }
+    return (true);
+}
+
+
+// Stop sampling.  The data are retained until the next start, and
+// can be dumped.
+//
+bool
+sMemory::mon_prof_stop()
+{
+    if (!mem_prof_on)
+        return (false);
+    mem_prof_on = false;
+    return (true);
+}
+
+
+// Dump the profile to fname, in pprof format if the boolean is set,
+// plain text otherwise.
+//
+bool
+sMemory::mon_prof_dump(const char *fname, bool pprof)
+{
+    if (!mem_prof)
+        return (false);
+    bool tbusy = mp_busy;
+    mp_busy = true;
+    FILE *fp = fopen(fname, "w");
+    if (fp) {
+        pthread_mutex_lock(&mem_prof->mp_lock);
+        if (pprof)
+            mem_prof->print_pprof(fp);
+        else
+            mem_prof->print_text(fp);
+        pthread_mutex_unlock(&mem_prof->mp_lock);
+        fclose(fp);
+    }
+    mp_busy = tbusy;
+    return (fp ? true : false);
+}
+
+
+// Return the estimated live heap bytes, as seen by the profiler.
+//
+size_t
+sMemory::mon_prof_live()
+{
+    if (!mem_prof)
+        return (0);
+    double d = mem_prof->mp_est_live;
+    return (d > 0.0 ? (size_t)d : 0);
+}
+
+
+// Dump the profile in response to mon_prof_request, to a file named
+// mon_prof.<pid>.<seq>.heap in the current directory.
+//
+void
+sMemory::mem_prof_auto_dump()
+{
+    mem_prof_req = 0;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "mon_prof.%d.%d.heap", (int)getpid(),
+        mp_dump_seq++);
+    if (mon_prof_dump(buf, true))
+        fprintf(stderr, "MMON: heap profile written to %s.\n", buf);
+}
+
+
+// Private work function, called for every allocation when the
+// profiler is active, so keep the common path short.
+//
+void
+sMemory::mem_prof_alloc_hook_prv(void *v, size_t sz)
+{
+    if (mp_busy)
+        return;
+    mprof_t *mp = mem_prof;
+    if (mp_thr_run != mp->mp_run) {
+        // First allocation in this thread since the profiler was
+        // started, start the countdown here so that the first
+        // allocation isn't always sampled.
+        mp_thr_run = mp->mp_run;
+        mp_countdown = mp_next_sample(mp->mp_interval);
+    }
+    mp_countdown -= sz;
+    if (mp_countdown > 0 && !mem_prof_req)
+        return;
+
+    mp_busy = true;
+    if (mem_prof_req)
+        mem_prof_auto_dump();
+    if (mp_countdown <= 0) {
+        mp_countdown = mp_next_sample(mp->mp_interval);
+#if defined(__arm64) || defined(__x86_64)
+        void *vtmp[MP_DEPTH + 1];
+        int i = backtrace(vtmp, MP_DEPTH + 1) - 1;
+        if (i < 0)
+            i = 0;
+        mp->add(v, sz, vtmp + 1, i);
+#else
+        void *vtmp[1];
+        vtmp[0] = __builtin_return_address(0);
+        mp->add(v, sz, vtmp, 1);
+#endif
+    }
+    mp_busy = false;
+}
+
+
+// Private work function.
+//
+void
+sMemory::mem_prof_free_hook_prv(void *v)
+{
+    if (mp_busy)
+        return;
+    mp_busy = true;
+    mem_prof->remove(v);
+    mp_busy = false;
+}
+
+
 #ifdef CPP_ONLY
 
 void *
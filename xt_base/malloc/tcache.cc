@@ -0,0 +1,351 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Memory Allocator Package                                               *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "local_malloc.h"
+
+
+//-----------------------------------------------------------------------
+//
+// Thread Cache Layer
+//
+//-----------------------------------------------------------------------
+
+// environment
+// XT_THREAD_CACHE            Use the local allocator, with a per-thread
+//                            cache in front of the central heap.
+
+// The local allocator (malloc.c) has a single arena protected by a
+// single lock.  When many threads are allocating and freeing small
+// blocks, they contend for that lock.  Here, each thread keeps free
+// lists of small blocks, by size class.  Blocks are obtained from
+// the central heap in batches, and returned in batches when a free
+// list grows too long, so that the central lock is taken once per
+// batch rather than once per call.
+//
+// Cached blocks are never released as far as the central heap is
+// concerned, so that dlmalloc_usable_size can be used to find the
+// size class of any block being freed, without a header.  A block is
+// placed in the largest class that it can satisfy, so blocks from
+// any source (including memalign) can be cached.
+
+#if defined(__FreeBSD__) || defined(__linux)
+
+extern "C" {
+    // malloc.c
+    extern void *dlmalloc(size_t);
+    extern void *dlcalloc(size_t, size_t);
+    extern void *dlrealloc(void*, size_t);
+    extern void dlfree(void*);
+    extern void **dlindependent_comalloc(size_t, size_t*, void**);
+    extern size_t dlbulk_free(void**, size_t);
+    extern size_t dlmalloc_usable_size(void*);
+}
+
+#define TC_GRAIN        16      // size class spacing
+#define TC_NCLASSES     32      // number of size classes
+#define TC_MAXSIZE      (TC_GRAIN*TC_NCLASSES)
+#define TC_BATCH        16      // blocks per refill
+#define TC_MAXCOUNT     64      // free list length that triggers flush
+
+namespace {
+    // Per-thread cache, allocated from the central heap.
+    //
+    struct tcache_t
+    {
+        void *tc_lists[TC_NCLASSES + 1];        // free lists, by class
+        unsigned int tc_counts[TC_NCLASSES + 1];// list lengths
+        tcache_t *tc_next;                      // registry link
+        unsigned long tc_thread;                // pthread_self()
+        size_t tc_allocs;
+        size_t tc_frees;
+        size_t tc_hits;
+        size_t tc_refills;
+        size_t tc_flushes;
+        size_t tc_cached;
+    };
+
+    pthread_key_t tc_key;
+    pthread_mutex_t tc_lock = PTHREAD_MUTEX_INITIALIZER;
+    tcache_t *tc_list;          // caches of live threads
+    tcache_t tc_retired;        // totals from exited threads
+
+    __thread tcache_t *tc_cache;
+    __thread bool tc_busy;
+    __thread bool tc_gone;
+
+
+    // Move up to n blocks from the head of the class c list back to
+    // the central heap.
+    //
+    void
+    tc_flush(tcache_t *tc, int c, unsigned int n)
+    {
+        void *ary[TC_MAXCOUNT];
+        if (n > TC_MAXCOUNT)
+            n = TC_MAXCOUNT;
+        unsigned int i = 0;
+        while (i < n && tc->tc_lists[c]) {
+            void *p = tc->tc_lists[c];
+            tc->tc_lists[c] = *(void**)p;
+            ary[i++] = p;
+        }
+        tc->tc_counts[c] -= i;
+        tc->tc_cached -= i*c*TC_GRAIN;
+        tc->tc_flushes++;
+        dlbulk_free(ary, i);
+    }
+
+
+    // Return everything to the central heap, unlink the cache and
+    // save the statistics.  This is the thread-exit destructor.
+    //
+    void
+    tc_release(void *arg)
+    {
+        tcache_t *tc = (tcache_t*)arg;
+        if (!tc)
+            return;
+        tc_cache = 0;
+        tc_gone = true;
+        for (int c = 1; c <= TC_NCLASSES; c++) {
+            while (tc->tc_lists[c])
+                tc_flush(tc, c, TC_MAXCOUNT);
+        }
+
+        pthread_mutex_lock(&tc_lock);
+        tcache_t *tp = 0;
+        for (tcache_t *t = tc_list; t; t = t->tc_next) {
+            if (t == tc) {
+                if (tp)
+                    tp->tc_next = t->tc_next;
+                else
+                    tc_list = t->tc_next;
+                break;
+            }
+            tp = t;
+        }
+        tc_retired.tc_allocs += tc->tc_allocs;
+        tc_retired.tc_frees += tc->tc_frees;
+        tc_retired.tc_hits += tc->tc_hits;
+        tc_retired.tc_refills += tc->tc_refills;
+        tc_retired.tc_flushes += tc->tc_flushes;
+        pthread_mutex_unlock(&tc_lock);
+        dlfree(tc);
+    }
+
+
+    // Return the calling thread's cache, creating it if necessary. 
+    // This returns null while the cache is being created (in case
+    // the pthread functions allocate) and after the thread-exit
+    // destructor has run, the caller then uses the central heap
+    // directly.
+    //
+    inline tcache_t *
+    tc_get()
+    {
+        tcache_t *tc = tc_cache;
+        if (tc)
+            return (tc);
+        if (tc_busy || tc_gone)
+            return (0);
+        tc_busy = true;
+        tc = (tcache_t*)dlcalloc(1, sizeof(tcache_t));
+        if (tc) {
+            tc->tc_thread = (unsigned long)pthread_self();
+            pthread_mutex_lock(&tc_lock);
+            tc->tc_next = tc_list;
+            tc_list = tc;
+            pthread_mutex_unlock(&tc_lock);
+            pthread_setspecific(tc_key, tc);
+        }
+        tc_cache = tc;
+        tc_busy = false;
+        return (tc);
+    }
+
+
+    // Obtain a batch of class c blocks from the central heap, return
+    // one and add the rest to the free list.
+    //
+    void *
+    tc_refill(tcache_t *tc, int c)
+    {
+        size_t sizes[TC_BATCH];
+        void *ary[TC_BATCH];
+        for (int i = 0; i < TC_BATCH; i++)
+            sizes[i] = c*TC_GRAIN;
+        if (!dlindependent_comalloc(TC_BATCH, sizes, ary))
+            return (0);
+        for (int i = 1; i < TC_BATCH; i++) {
+            *(void**)ary[i] = tc->tc_lists[c];
+            tc->tc_lists[c] = ary[i];
+        }
+        tc->tc_counts[c] += TC_BATCH - 1;
+        tc->tc_cached += (TC_BATCH - 1)*c*TC_GRAIN;
+        tc->tc_refills++;
+        return (ary[0]);
+    }
+}
+
+
+namespace tcache {
+    bool
+    tc_init()
+    {
+        return (pthread_key_create(&tc_key, tc_release) == 0);
+    }
+
+
+    void *
+    tc_malloc(size_t size)
+    {
+        tcache_t *tc;
+        if (size > TC_MAXSIZE || !(tc = tc_get()))
+            return (dlmalloc(size));
+        int c = size ? (size + TC_GRAIN - 1)/TC_GRAIN : 1;
+        tc->tc_allocs++;
+        void *p = tc->tc_lists[c];
+        if (p) {
+            tc->tc_lists[c] = *(void**)p;
+            tc->tc_counts[c]--;
+            tc->tc_cached -= c*TC_GRAIN;
+            tc->tc_hits++;
+            return (p);
+        }
+        return (tc_refill(tc, c));
+    }
+
+
+    void *
+    tc_calloc(size_t n, size_t size)
+    {
+        size_t tot = n*size;
+        if (n && tot/n != size)
+            return (0);
+        if (tot > TC_MAXSIZE)
+            return (dlcalloc(n, size));
+        void *p = tc_malloc(tot);
+        if (p)
+            memset(p, 0, tot);
+        return (p);
+    }
+
+
+    void *
+    tc_realloc(void *p, size_t size)
+    {
+        if (!p)
+            return (tc_malloc(size));
+        return (dlrealloc(p, size));
+    }
+
+
+    void
+    tc_free(void *p)
+    {
+        tcache_t *tc;
+        if (!p || !(tc = tc_get())) {
+            dlfree(p);
+            return;
+        }
+        size_t c = dlmalloc_usable_size(p)/TC_GRAIN;
+        if (c < 1 || c > TC_NCLASSES) {
+            dlfree(p);
+            return;
+        }
+        tc->tc_frees++;
+        *(void**)p = tc->tc_lists[c];
+        tc->tc_lists[c] = p;
+        tc->tc_cached += c*TC_GRAIN;
+        if (++tc->tc_counts[c] > TC_MAXCOUNT)
+            tc_flush(tc, c, TC_MAXCOUNT/2);
+    }
+}
+
+
+// Fill in up to max statistics records, one for each thread with a
+// cache plus one for all exited threads.  The count of records
+// written is returned.  The counters of other threads are read
+// without synchronization, so are approximate.
+//
+int
+sMemory::tcache_stats(sMemThreadStats *ary, int max)
+{
+    if (!mem_use_tcache || !ary || max <= 0)
+        return (0);
+    int cnt = 0;
+    pthread_mutex_lock(&tc_lock);
+    for (tcache_t *t = tc_list; t && cnt < max; t = t->tc_next) {
+        sMemThreadStats *s = ary + cnt++;
+        s->mts_thread = t->tc_thread;
+        s->mts_allocs = t->tc_allocs;
+        s->mts_frees = t->tc_frees;
+        s->mts_hits = t->tc_hits;
+        s->mts_refills = t->tc_refills;
+        s->mts_flushes = t->tc_flushes;
+        s->mts_cached = t->tc_cached;
+    }
+    if (cnt < max && tc_retired.tc_allocs) {
+        sMemThreadStats *s = ary + cnt++;
+        s->mts_thread = 0;
+        s->mts_allocs = tc_retired.tc_allocs;
+        s->mts_frees = tc_retired.tc_frees;
+        s->mts_hits = tc_retired.tc_hits;
+        s->mts_refills = tc_retired.tc_refills;
+        s->mts_flushes = tc_retired.tc_flushes;
+        s->mts_cached = 0;
+    }
+    pthread_mutex_unlock(&tc_lock);
+    return (cnt);
+}
+
+#else
+
+int
+sMemory::tcache_stats(sMemThreadStats*, int)
+{
+    return (0);
+}
+
+#endif